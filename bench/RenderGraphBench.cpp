@@ -0,0 +1,408 @@
+﻿#include "AllocationCounter.hpp"
+#include "GraphGenerator.hpp"
+
+#include <RenderGraph/CompileStats.hpp>
+#include <RenderGraph/RenderGraph.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	struct Options
+	{
+		uint32_t maxPasses{ 20000u };
+		uint32_t repeat{ 3u };
+		double budget{ 30.0 };
+		uint32_t seed{ 1u };
+		std::string output;
+		std::vector< test::GraphShape > shapes;
+	};
+
+	static uint32_t constexpr Sizes[]{ 10u, 50u, 100u, 500u, 1000u, 2000u, 5000u, 10000u, 20000u };
+
+	bool parseOptions( int argc
+		, char ** argv
+		, Options & options )
+	{
+		for ( int index = 1; index < argc; ++index )
+		{
+			std::string arg{ argv[index] };
+			auto hasValue = index + 1 < argc;
+
+			if ( arg == "--max-passes" && hasValue )
+			{
+				options.maxPasses = uint32_t( std::strtoul( argv[++index], nullptr, 10 ) );
+			}
+			else if ( arg == "--repeat" && hasValue )
+			{
+				options.repeat = std::max( 1u, uint32_t( std::strtoul( argv[++index], nullptr, 10 ) ) );
+			}
+			else if ( arg == "--budget" && hasValue )
+			{
+				options.budget = std::strtod( argv[++index], nullptr );
+			}
+			else if ( arg == "--seed" && hasValue )
+			{
+				options.seed = uint32_t( std::strtoul( argv[++index], nullptr, 10 ) );
+			}
+			else if ( arg == "--output" && hasValue )
+			{
+				options.output = argv[++index];
+			}
+			else if ( arg == "--shapes" && hasValue )
+			{
+				std::stringstream stream{ argv[++index] };
+				std::string name;
+
+				while ( std::getline( stream, name, ',' ) )
+				{
+					uint32_t shape{};
+
+					while ( shape < uint32_t( test::GraphShape::Count )
+						&& name != test::getName( test::GraphShape( shape ) ) )
+					{
+						++shape;
+					}
+
+					if ( shape == uint32_t( test::GraphShape::Count ) )
+					{
+						std::cerr << "Unknown shape " << name << "\n";
+						return false;
+					}
+
+					options.shapes.push_back( test::GraphShape( shape ) );
+				}
+			}
+			else
+			{
+				std::cerr << "Usage: RenderGraphBench [--max-passes N] [--repeat N] [--budget SECONDS] [--seed N] [--shapes NAME,...] [--output FILE]\n";
+				return false;
+			}
+		}
+
+		if ( options.shapes.empty() )
+		{
+			for ( uint32_t shape = 0u; shape < uint32_t( test::GraphShape::Count ); ++shape )
+			{
+				options.shapes.push_back( test::GraphShape( shape ) );
+			}
+		}
+
+		return true;
+	}
+
+	struct Result
+	{
+		test::GraphShape shape;
+		uint32_t passCount;
+		bool skipped{};
+		std::chrono::nanoseconds registerTime{};
+		crg::CompileStats stats{};
+		int64_t peakBytes{};
+		int64_t retainedBytes{};
+		size_t dependencies{};
+		size_t transitions{};
+	};
+
+	/**
+	*\brief
+	*	Writes the results document, as the results come.
+	*/
+	class ResultWriter
+	{
+	public:
+		ResultWriter( std::ostream & stream
+			, Options const & options )
+			: m_stream{ stream }
+		{
+			m_stream << "{\"benchmark\":\"RenderGraphBench\""
+				<< ",\"timeUnit\":\"ns\""
+				<< ",\"repeat\":" << options.repeat
+				<< ",\"seed\":" << options.seed
+				<< ",\"results\":[";
+		}
+
+		void write( Result const & result );
+		/**
+		*\brief
+		*	Writes a result for a compilation which didn't complete in time, and ends the document.
+		*/
+		void writeTimeout( test::GraphShape shape
+			, uint32_t passCount
+			, double timeout )
+		{
+			std::lock_guard< std::mutex > lock{ m_mutex };
+			m_stream << m_sep << "{\"shape\":\"" << test::getName( shape ) << "\""
+				<< ",\"passes\":" << passCount
+				<< ",\"timedOut\":" << timeout << "}";
+			doEnd();
+		}
+
+		void end()
+		{
+			std::lock_guard< std::mutex > lock{ m_mutex };
+			doEnd();
+		}
+
+	private:
+		void doEnd()
+		{
+			m_stream << "\n]}\n";
+			m_stream.flush();
+		}
+
+	private:
+		std::ostream & m_stream;
+		std::mutex m_mutex;
+		std::string m_sep{ "\n" };
+	};
+	/**
+	*\brief
+	*	Ends the process, with a valid results document, when a compilation takes too long.
+	*\remarks
+	*	compile() can't be interrupted, and some shapes still have a super polynomial compile time.
+	*/
+	class Watchdog
+	{
+	public:
+		Watchdog( ResultWriter & writer
+			, double timeout )
+			: m_writer{ writer }
+			, m_timeout{ timeout }
+			, m_thread{ [this](){ doRun(); } }
+		{
+		}
+
+		~Watchdog()
+		{
+			{
+				std::lock_guard< std::mutex > lock{ m_mutex };
+				m_stopped = true;
+			}
+			m_condition.notify_one();
+			m_thread.join();
+		}
+
+		void start( test::GraphShape shape
+			, uint32_t passCount )
+		{
+			{
+				std::lock_guard< std::mutex > lock{ m_mutex };
+				m_shape = shape;
+				m_passCount = passCount;
+				m_running = true;
+				++m_run;
+			}
+			m_condition.notify_one();
+		}
+
+		void stop()
+		{
+			std::lock_guard< std::mutex > lock{ m_mutex };
+			m_running = false;
+		}
+
+	private:
+		void doRun()
+		{
+			std::unique_lock< std::mutex > lock{ m_mutex };
+
+			while ( !m_stopped )
+			{
+				if ( !m_running )
+				{
+					m_condition.wait( lock );
+					continue;
+				}
+
+				auto run = m_run;
+
+				if ( !m_condition.wait_for( lock
+						, std::chrono::duration< double >( m_timeout )
+						, [this, run](){ return m_stopped || !m_running || m_run != run; } ) )
+				{
+					std::cerr << test::getName( m_shape ) << " " << m_passCount << ": timed out\n";
+					m_writer.writeTimeout( m_shape, m_passCount, m_timeout );
+					std::_Exit( EXIT_FAILURE );
+				}
+			}
+		}
+
+	private:
+		ResultWriter & m_writer;
+		double m_timeout;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stopped{};
+		bool m_running{};
+		uint64_t m_run{};
+		test::GraphShape m_shape{};
+		uint32_t m_passCount{};
+		std::thread m_thread;
+	};
+
+	Result runBench( test::GraphShape shape
+		, uint32_t passCount
+		, Options const & options )
+	{
+		Result result{ shape, passCount };
+		crg::RenderGraph graph{ test::getName( shape ) };
+		auto begin = std::chrono::steady_clock::now();
+		test::generateGraph( graph, shape, passCount, options.seed );
+		result.registerTime = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - begin );
+		graph.setAllocationCounter( test::getAllocationCount );
+		graph.enableCompileStats( true );
+
+		for ( uint32_t run = 0u; run < options.repeat; ++run )
+		{
+			auto live = test::getLiveBytes();
+			test::resetPeakBytes();
+			graph.compile();
+			auto & stats = graph.getCompileStats();
+
+			// Keep the fastest run, the less disturbed by the host.
+			if ( run == 0u || stats.totalTime < result.stats.totalTime )
+			{
+				result.stats = stats;
+				result.peakBytes = test::getPeakBytes() - live;
+				result.retainedBytes = test::getLiveBytes() - live;
+			}
+		}
+
+		result.dependencies = graph.getDependencies().size();
+		result.transitions = graph.getTransitions().size();
+		return result;
+	}
+
+	void ResultWriter::write( Result const & result )
+	{
+		std::lock_guard< std::mutex > lock{ m_mutex };
+		auto & stream = m_stream;
+		stream << m_sep << "{\"shape\":\"" << test::getName( result.shape ) << "\""
+			<< ",\"passes\":" << result.passCount;
+
+		if ( result.skipped )
+		{
+			stream << ",\"skipped\":true}";
+			m_sep = ",\n";
+			return;
+		}
+
+		auto & stats = result.stats;
+		stream << ",\"registerTime\":" << result.registerTime.count()
+			<< ",\"compileTime\":" << stats.totalTime.count()
+			<< ",\"allocations\":" << stats.allocations
+			<< ",\"allocatedBytes\":" << stats.allocatedBytes
+			<< ",\"peakBytes\":" << result.peakBytes
+			<< ",\"retainedBytes\":" << result.retainedBytes
+			<< ",\"overlapTests\":" << stats.overlapTests
+			<< ",\"dependencyLookups\":" << stats.dependencyLookups
+			<< ",\"graphVisits\":" << stats.graphVisits
+			<< ",\"dependencies\":" << result.dependencies
+			<< ",\"dependenciesAfterReduction\":" << stats.dependenciesAfterReduction
+			<< ",\"transitionsBeforeMerges\":" << stats.transitionsBeforeMerges
+			<< ",\"transitions\":" << result.transitions
+			<< ",\"phases\":{";
+		std::string sep;
+
+		for ( size_t index = 0u; index < size_t( crg::CompilePhase::Count ); ++index )
+		{
+			stream << sep << "\"" << crg::getName( crg::CompilePhase( index ) ) << "\":{"
+				<< "\"time\":" << stats.phaseTimes[index].count()
+				<< ",\"allocations\":" << stats.phaseAllocations[index]
+				<< ",\"allocatedBytes\":" << stats.phaseAllocatedBytes[index]
+				<< "}";
+			sep = ",";
+		}
+
+		stream << "}}";
+		stream.flush();
+		m_sep = ",\n";
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	Options options;
+
+	if ( !parseOptions( argc, argv, options ) )
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::ofstream file;
+
+	if ( !options.output.empty() )
+	{
+		file.open( options.output );
+
+		if ( !file )
+		{
+			std::cerr << "Couldn't open " << options.output << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	ResultWriter writer{ options.output.empty() ? std::cout : static_cast< std::ostream & >( file )
+		, options };
+	// A single compilation may exceed the budget, when the extrapolation is wrong, but not by far.
+	Watchdog watchdog{ writer, 10.0 * options.budget };
+
+	for ( auto shape : options.shapes )
+	{
+		double previousTime{};
+		uint32_t previousCount{};
+		// The growth exponent observed between the two last sizes, at least quadratic.
+		double exponent{ 2.0 };
+
+		for ( auto passCount : Sizes )
+		{
+			if ( passCount > options.maxPasses )
+			{
+				break;
+			}
+
+			Result result{ shape, passCount };
+			// Skip the sizes which would exceed the budget, extrapolating from the previous ones.
+			result.skipped = previousCount != 0u
+				&& previousTime * std::pow( double( passCount ) / previousCount, exponent ) > options.budget;
+
+			if ( !result.skipped )
+			{
+				watchdog.start( shape, passCount );
+				result = runBench( shape, passCount, options );
+				watchdog.stop();
+				auto time = std::chrono::duration< double >( result.stats.totalTime ).count();
+
+				if ( previousCount != 0u
+					&& previousTime > 0.0 )
+				{
+					exponent = std::max( 2.0
+						, std::log( time / previousTime ) / std::log( double( passCount ) / previousCount ) );
+				}
+
+				previousTime = time;
+				previousCount = passCount;
+				std::cerr << test::getName( shape ) << " " << passCount << ": " << time << "s\n";
+			}
+			else
+			{
+				std::cerr << test::getName( shape ) << " " << passCount << ": skipped\n";
+			}
+
+			writer.write( result );
+		}
+	}
+
+	writer.end();
+	return EXIT_SUCCESS;
+}
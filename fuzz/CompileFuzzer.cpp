@@ -0,0 +1,147 @@
+#include "AllocationCounter.hpp"
+#include "GraphGenerator.hpp"
+
+#include <RenderGraph/Exception.hpp>
+#include <RenderGraph/RenderGraph.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+namespace
+{
+	// The reference graph building enumerates every path, which is exponential in the dependencies count,
+	// so graphs with more dependencies than that aren't cross-checked.
+	static uint64_t constexpr MaxCrossCheckDependencies = 16u;
+
+	struct Budget
+	{
+		std::chrono::milliseconds time;
+		int64_t memory;
+	};
+
+	Budget const & getBudget()
+	{
+		static Budget const result = []()
+		{
+			auto time = std::getenv( "CRG_FUZZ_TIME_BUDGET_MS" );
+			auto memory = std::getenv( "CRG_FUZZ_MEMORY_BUDGET_MB" );
+			return Budget{ std::chrono::milliseconds{ time ? std::strtoll( time, nullptr, 10 ) : 500 }
+				, ( memory ? std::strtoll( memory, nullptr, 10 ) : 64 ) * 1024 * 1024 };
+		}();
+		return result;
+	}
+
+	struct Measure
+	{
+		uint32_t passCount;
+		bool compiled;
+		std::chrono::nanoseconds time;
+		int64_t peakMemory;
+	};
+
+	Measure compileInput( uint8_t const * data
+		, size_t size )
+	{
+		Measure result{};
+		crg::RenderGraph graph{ "Fuzz" };
+		result.passCount = test::decodeGraph( graph, data, size );
+		graph.enableCompileStats( true );
+		auto live = test::getLiveBytes();
+		test::resetPeakBytes();
+		auto begin = std::chrono::steady_clock::now();
+
+		try
+		{
+			graph.compile();
+			result.compiled = true;
+		}
+		catch ( crg::Exception & )
+		{
+			// Graphs without root or leaf are rejected, that's expected.
+		}
+
+		result.time = std::chrono::steady_clock::now() - begin;
+		result.peakMemory = test::getPeakBytes() - live;
+
+		if ( result.compiled
+			&& graph.getCompileStats().dependenciesCreated <= MaxCrossCheckDependencies )
+		{
+			// A divergence throws, and is reported as a crash.
+			graph.setCompileMode( crg::CompileMode::CrossCheck );
+			graph.compile();
+		}
+
+		return result;
+	}
+
+	void checkBudget( Measure const & measure )
+	{
+		auto & budget = getBudget();
+
+		if ( measure.time > budget.time
+			|| measure.peakMemory > budget.memory )
+		{
+			// Aborting makes the fuzzer keep the input, so that it can be added to the regression inputs.
+			std::cerr << "Compile budget exceeded: " << measure.passCount << " passes, "
+				<< std::chrono::duration_cast< std::chrono::milliseconds >( measure.time ).count() << " ms, "
+				<< measure.peakMemory / 1024 << " kB\n";
+			std::abort();
+		}
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput( uint8_t const * data
+	, size_t size )
+{
+	checkBudget( compileInput( data, size ) );
+	return 0;
+}
+
+#if CRG_FuzzStandalone
+
+/**
+*\brief
+*	Without libFuzzer, replays the given inputs, printing their compile time and memory,
+*	or runs random inputs if none is given.
+*/
+int main( int argc, char ** argv )
+{
+	if ( argc > 1 )
+	{
+		for ( int index = 1; index < argc; ++index )
+		{
+			std::ifstream file{ argv[index], std::ios::binary };
+			std::vector< uint8_t > data{ std::istreambuf_iterator< char >{ file }
+				, std::istreambuf_iterator< char >{} };
+			auto measure = compileInput( data.data(), data.size() );
+			std::cout << argv[index] << ": " << measure.passCount << " passes, "
+				<< std::chrono::duration_cast< std::chrono::microseconds >( measure.time ).count() << " us, "
+				<< measure.peakMemory / 1024 << " kB\n";
+			checkBudget( measure );
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	std::mt19937 random{ 0u };
+
+	for ( uint32_t run = 0u; run < 10000u; ++run )
+	{
+		std::vector< uint8_t > data( random() % 512u );
+
+		for ( auto & value : data )
+		{
+			value = uint8_t( random() );
+		}
+
+		LLVMFuzzerTestOneInput( data.data(), data.size() );
+	}
+
+	return EXIT_SUCCESS;
+}
+
+#endif
@@ -10,10 +10,19 @@ namespace crg
 {
 	/**
 	*\brief
-	*	A sampled image, or an input/output colour/depth/stencil/depthstencil attachment.
+	*	A sampled image, an input/output colour/depth/stencil/depthstencil attachment,
+	*	a storage image, or a transfer source/destination.
 	*/
 	struct Attachment
 	{
+		enum class Kind
+		{
+			Sampled,
+			Colour,
+			DepthStencil,
+			Storage,
+			Transfer,
+		};
 		/**
 		*\brief
 		*	Creates a sampled image attachment.
@@ -40,6 +49,28 @@ namespace crg
 			, ImageViewId view );
 		/**
 		*\brief
+		*	Creates a storage image attachment.
+		*\remarks
+		*	VK_ATTACHMENT_LOAD_OP_LOAD means the image is read, VK_ATTACHMENT_STORE_OP_STORE means it is written.
+		*/
+		static Attachment createStorage( std::string const & name
+			, VkAttachmentLoadOp loadOp
+			, VkAttachmentStoreOp storeOp
+			, ImageViewId view );
+		/**
+		*\brief
+		*	Creates a copy or blit source attachment.
+		*/
+		static Attachment createTransferSrc( std::string const & name
+			, ImageViewId view );
+		/**
+		*\brief
+		*	Creates a copy, blit or clear destination attachment.
+		*/
+		static Attachment createTransferDst( std::string const & name
+			, ImageViewId view );
+		/**
+		*\brief
 		*	Creates an input colour attachment.
 		*/
 		static inline Attachment createInputColour( std::string const & name
@@ -201,9 +232,51 @@ namespace crg
 				, view );
 		}
 
+		/**
+		*\brief
+		*	Creates an input storage image attachment.
+		*/
+		static inline Attachment createInputStorage( std::string const & name
+			, ImageViewId view )
+		{
+			return createStorage( name
+				, VK_ATTACHMENT_LOAD_OP_LOAD
+				, VK_ATTACHMENT_STORE_OP_DONT_CARE
+				, view );
+		}
+		/**
+		*\brief
+		*	Creates an in/out storage image attachment.
+		*/
+		static inline Attachment createInOutStorage( std::string const & name
+			, ImageViewId view )
+		{
+			return createStorage( name
+				, VK_ATTACHMENT_LOAD_OP_LOAD
+				, VK_ATTACHMENT_STORE_OP_STORE
+				, view );
+		}
+		/**
+		*\brief
+		*	Creates an output storage image attachment.
+		*/
+		static inline Attachment createOutputStorage( std::string const & name
+			, ImageViewId view )
+		{
+			return createStorage( name
+				, VK_ATTACHMENT_LOAD_OP_DONT_CARE
+				, VK_ATTACHMENT_STORE_OP_STORE
+				, view );
+		}
+
+		inline bool isSampled()const
+		{
+			return kind == Kind::Sampled;
+		}
+
 		std::string name;
 		ImageViewId view;
-		bool isSampled;
+		Kind kind;
 		VkAttachmentLoadOp loadOp;
 		VkAttachmentStoreOp storeOp;
 		VkAttachmentLoadOp stencilLoadOp;
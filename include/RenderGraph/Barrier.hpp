@@ -0,0 +1,74 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "Id.hpp"
+
+namespace crg
+{
+	/**
+	*\brief
+	*	A layout and/or memory barrier on a subresource range of an image.
+	*/
+	struct ImageBarrier
+	{
+		ImageId image;
+		VkImageSubresourceRange subresourceRange;
+		VkImageLayout oldLayout;
+		VkImageLayout newLayout;
+		VkAccessFlags srcAccessMask;
+		VkAccessFlags dstAccessMask;
+		VkPipelineStageFlags srcStageMask;
+		VkPipelineStageFlags dstStageMask;
+	};
+	using ImageBarrierArray = std::vector< ImageBarrier >;
+	bool operator==( ImageBarrier const & lhs, ImageBarrier const & rhs );
+	/**
+	*\brief
+	*	A memory barrier on a range of a buffer.
+	*/
+	struct BufferBarrier
+	{
+		BufferId buffer;
+		VkDeviceSize offset;
+		VkDeviceSize size;
+		VkAccessFlags srcAccessMask;
+		VkAccessFlags dstAccessMask;
+		VkPipelineStageFlags srcStageMask;
+		VkPipelineStageFlags dstStageMask;
+	};
+	using BufferBarrierArray = std::vector< BufferBarrier >;
+	bool operator==( BufferBarrier const & lhs, BufferBarrier const & rhs );
+	/**
+	*\brief
+	*	The barriers to issue before running a pass.
+	*/
+	struct PassBarriers
+	{
+		ImageBarrierArray images;
+		BufferBarrierArray buffers;
+	};
+	using PassBarriersArray = std::vector< PassBarriers >;
+	/**
+	*\brief
+	*	Fills a VkImageMemoryBarrier from an image barrier.
+	*\param[in] image
+	*	The Vulkan image matching barrier.image (for history images, its backing for the frame).
+	*/
+	VkImageMemoryBarrier makeVkBarrier( ImageBarrier const & barrier
+		, VkImage image
+		, uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED
+		, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED );
+	/**
+	*\brief
+	*	Fills a VkBufferMemoryBarrier from a buffer barrier.
+	*\param[in] buffer
+	*	The Vulkan buffer matching barrier.buffer.
+	*/
+	VkBufferMemoryBarrier makeVkBarrier( BufferBarrier const & barrier
+		, VkBuffer buffer
+		, uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED
+		, uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED );
+}
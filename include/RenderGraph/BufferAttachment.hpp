@@ -0,0 +1,87 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "BufferData.hpp"
+
+namespace crg
+{
+	/**
+	*\brief
+	*	A range of a buffer, used by a pass.
+	*/
+	struct BufferAttachment
+	{
+		enum class Kind
+		{
+			StorageRead,
+			StorageWrite,
+			Uniform,
+			Indirect,
+			Vertex,
+			Index,
+		};
+		/**
+		*\brief
+		*	Creates a storage buffer range, read by the pass.
+		*/
+		static BufferAttachment createStorageRead( std::string const & name
+			, BufferId buffer
+			, VkDeviceSize offset = 0u
+			, VkDeviceSize range = VK_WHOLE_SIZE );
+		/**
+		*\brief
+		*	Creates a storage buffer range, written by the pass.
+		*/
+		static BufferAttachment createStorageWrite( std::string const & name
+			, BufferId buffer
+			, VkDeviceSize offset = 0u
+			, VkDeviceSize range = VK_WHOLE_SIZE );
+		/**
+		*\brief
+		*	Creates a uniform buffer range.
+		*/
+		static BufferAttachment createUniform( std::string const & name
+			, BufferId buffer
+			, VkDeviceSize offset = 0u
+			, VkDeviceSize range = VK_WHOLE_SIZE );
+		/**
+		*\brief
+		*	Creates an indirect draw/dispatch arguments buffer range.
+		*/
+		static BufferAttachment createIndirect( std::string const & name
+			, BufferId buffer
+			, VkDeviceSize offset = 0u
+			, VkDeviceSize range = VK_WHOLE_SIZE );
+		/**
+		*\brief
+		*	Creates a vertex buffer range.
+		*/
+		static BufferAttachment createVertex( std::string const & name
+			, BufferId buffer
+			, VkDeviceSize offset = 0u
+			, VkDeviceSize range = VK_WHOLE_SIZE );
+		/**
+		*\brief
+		*	Creates an index buffer range.
+		*/
+		static BufferAttachment createIndex( std::string const & name
+			, BufferId buffer
+			, VkDeviceSize offset = 0u
+			, VkDeviceSize range = VK_WHOLE_SIZE );
+
+		inline bool isWrite()const
+		{
+			return kind == Kind::StorageWrite;
+		}
+
+		std::string name;
+		BufferId buffer;
+		Kind kind;
+		VkDeviceSize offset;
+		VkDeviceSize range;
+	};
+	bool operator==( BufferAttachment const & lhs, BufferAttachment const & rhs );
+}
@@ -0,0 +1,27 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "Id.hpp"
+
+namespace crg
+{
+	/**
+	*\brief
+	*	Basic buffer data, from which buffers will be created.
+	*/
+	struct BufferData
+	{
+		VkBufferCreateFlags flags;
+		VkDeviceSize size;
+		VkBufferUsageFlags usage;
+	};
+	inline bool operator==( BufferData const & lhs, BufferData const & rhs )
+	{
+		return lhs.flags == rhs.flags
+			&& lhs.size == rhs.size
+			&& lhs.usage == rhs.usage;
+	}
+}
@@ -0,0 +1,97 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+#include <atomic>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	The compile cache counters.
+	*/
+	struct CompileCacheStats
+	{
+		// Compilations replaced by the loading of an entry.
+		uint64_t hits{};
+		// Compilations for which no valid entry was found.
+		uint64_t misses{};
+		// Entries written.
+		uint64_t writes{};
+		// Entries removed to stay within the size budget.
+		uint64_t evictions{};
+	};
+	/**
+	*\brief
+	*	A directory of compiled graphs, named after the hash of the graph they were compiled from (<hash>.crg).
+	*\remarks
+	*	Entries are written to a temporary file, then renamed, so a reader never sees a partial entry.
+	*	The directory can be shared by several processes: entries with the same name have the same content,
+	*	and failing to write, read or remove an entry only results in a cache miss.
+	*	Reading an entry refreshes its modification time, which is used to evict the least recently used entries
+	*	when the total size of the entries exceeds the budget.
+	*/
+	class CompileCache
+	{
+	public:
+		/**
+		*\param[in] directory
+		*	The cache directory, created if needed.
+		*\param[in] sizeBudget
+		*	The maximum total size of the entries, in bytes.
+		*/
+		explicit CompileCache( std::string directory
+			, uint64_t sizeBudget = 64u * 1024u * 1024u );
+		/**
+		*\brief
+		*	Looks for an entry matching the graph, and loads it in the graph.
+		*\return
+		*	true if the graph has been loaded from the cache.
+		*/
+		bool load( RenderGraph & graph );
+		/**
+		*\brief
+		*	Writes the compiled graph as a cache entry, then evicts the entries exceeding the size budget.
+		*\return
+		*	false if the entry couldn't be written.
+		*/
+		bool store( RenderGraph const & graph );
+		/**
+		*\brief
+		*	Removes the least recently used entries, until the total size fits in the budget.
+		*\remarks
+		*	Also removes the temporary files left by interrupted writes.
+		*/
+		void evict();
+		/**
+		*\return
+		*	The path of the entry for given graph hash.
+		*/
+		std::string getEntryPath( uint64_t graphHash )const;
+
+		inline std::string const & getDirectory()const
+		{
+			return m_directory;
+		}
+
+		inline uint64_t getSizeBudget()const
+		{
+			return m_sizeBudget;
+		}
+
+		inline CompileCacheStats const & getStats()const
+		{
+			return m_stats;
+		}
+
+	private:
+		std::string m_directory;
+		uint64_t m_sizeBudget;
+		CompileCacheStats m_stats;
+		std::atomic< uint32_t > m_tempIndex{};
+	};
+}
@@ -0,0 +1,99 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+#include <array>
+#include <chrono>
+#include <functional>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	The timed phases of RenderGraph::compile().
+	*/
+	enum class CompilePhase
+	{
+		CacheLoad,
+		BuildPassDependencies,
+		FindCycles,
+		RetrieveRoots,
+		RetrieveLeafs,
+		BuildGraphNodes,
+		MergeIdenticalTransitions,
+		MergeTransitionsPerInput,
+		ReduceDirectPaths,
+		SortPasses,
+		BuildReachability,
+		SignPasses,
+		BuildPassBarriers,
+		BuildHistoryDependencies,
+		CacheStore,
+		Count,
+	};
+	/**
+	*\return
+	*	The phase name, as used in the sources.
+	*/
+	char const * getName( CompilePhase phase );
+	/**
+	*\brief
+	*	Allocations counters, as reported by an AllocationCounter.
+	*/
+	struct AllocationCount
+	{
+		uint64_t allocations{};
+		uint64_t bytes{};
+	};
+	/**
+	*\brief
+	*	Profiling data of one RenderGraph::compile() call.
+	*/
+	struct CompileStats
+	{
+		template< typename TypeT >
+		using PhaseArray = std::array< TypeT, size_t( CompilePhase::Count ) >;
+
+		// The wall time of each phase, zero for the phases which didn't run.
+		PhaseArray< std::chrono::nanoseconds > phaseTimes{};
+		// The allocations made during each phase, and their size, if an allocation counter is set.
+		PhaseArray< uint64_t > phaseAllocations{};
+		PhaseArray< uint64_t > phaseAllocatedBytes{};
+		std::chrono::nanoseconds totalTime{};
+		// The allocations made during the whole compilation, and their size, if an allocation counter is set.
+		uint64_t allocations{};
+		uint64_t allocatedBytes{};
+		// Image subresources overlap tests, while listing attachments and looking for dependencies.
+		uint64_t overlapTests{};
+		// Lookups of the dependency between two passes, while adding attachments to it.
+		uint64_t dependencyLookups{};
+		// Dependencies traversed while building the graph nodes.
+		uint64_t graphVisits{};
+		// The dependencies between passes, image and buffer ones.
+		uint64_t dependenciesCreated{};
+		// The dependencies left once the ones already given by other dependencies are marked as redundant.
+		uint64_t dependenciesAfterReduction{};
+		// The transitions built from the graph paths, before any merge.
+		uint64_t transitionsBeforeMerges{};
+		// The transitions count after each merge stage.
+		uint64_t transitionsAfterMergeIdentical{};
+		uint64_t transitionsAfterMergePerInput{};
+		uint64_t transitionsAfterReduceDirectPaths{};
+		// true if the compiled graph was loaded from the compile cache.
+		bool fromCache{};
+	};
+	/**
+	*\brief
+	*	Receives the stats at the end of each compilation.
+	*/
+	using CompileStatsCallback = std::function< void( CompileStats const & stats ) >;
+	/**
+	*\brief
+	*	Returns the number of allocations, and their total size, made so far (from a global operator new hook, for example).
+	*/
+	using AllocationCounter = std::function< AllocationCount() >;
+}
@@ -0,0 +1,380 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+#include <string_view>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	The binary format of a compiled graph.
+	*\remarks
+	*	The file is made of a header, followed by sections of fixed size records.
+	*	Records only hold plain values, and reference each other through indices,
+	*	so the file can be used in place, wherever it is loaded or mapped.
+	*	Padding is always explicit, so that identical graphs give identical files.
+	*/
+	namespace binary
+	{
+		static constexpr uint32_t Magic = 0x42475243u; // "CRGB"
+		static constexpr uint32_t Version = 1u;
+		static constexpr uint32_t Endianness = 0x01020304u;
+		static constexpr uint32_t InvalidIndex = ~0u;
+
+		enum class SectionKind
+			: uint32_t
+		{
+			// char, the strings content.
+			Strings,
+			// binary::Image, the images descriptions.
+			Images,
+			// binary::View, the image views descriptions.
+			Views,
+			// binary::Buffer, the buffers descriptions.
+			Buffers,
+			// binary::Pass, the passes, in execution order.
+			Passes,
+			// uint32_t, indices in the passes section.
+			PassIndices,
+			// binary::Attachment, the image attachments.
+			Attachments,
+			// binary::BufferAttachment, the buffer attachments.
+			BufferAttachments,
+			// binary::AttachmentPasses, an attachment and the passes using it.
+			AttachmentPasses,
+			// binary::Transition, the graph transitions, followed by the graph edges transitions.
+			Transitions,
+			// binary::Dependency, the dependencies between passes, within a frame.
+			Dependencies,
+			// binary::Dependency, the dependencies between passes, from a frame to the next ones.
+			HistoryDependencies,
+			// uint32_t, the graph nodes, as indices in the passes section.
+			Nodes,
+			// binary::Edge, the graph edges.
+			Edges,
+			// binary::ImageBarrier, the image barriers of all passes.
+			ImageBarriers,
+			// binary::BufferBarrier, the buffer barriers of all passes.
+			BufferBarriers,
+			Count,
+		};
+
+		struct Section
+		{
+			uint64_t offset;
+			uint32_t count;
+			uint32_t stride;
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t endianness;
+			uint32_t sectionCount;
+			// The hash of the registered passes and resources the file was compiled from.
+			uint64_t graphHash;
+			// The hash of everything following the header.
+			uint64_t contentHash;
+			uint64_t size;
+			Section sections[size_t( SectionKind::Count )];
+		};
+
+		struct String
+		{
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		struct Image
+		{
+			uint32_t id;
+			VkImageCreateFlags flags;
+			VkImageType imageType;
+			VkFormat format;
+			VkExtent2D extent;
+			uint32_t mipLevels;
+			uint32_t arrayLayers;
+			VkSampleCountFlagBits samples;
+			VkImageTiling tiling;
+			VkImageUsageFlags usage;
+			uint32_t padding;
+		};
+
+		struct View
+		{
+			uint32_t id;
+			uint32_t image;
+			VkImageViewCreateFlags flags;
+			VkImageViewType viewType;
+			VkFormat format;
+			VkImageSubresourceRange subresourceRange;
+		};
+
+		struct Buffer
+		{
+			uint32_t id;
+			VkBufferCreateFlags flags;
+			uint64_t size;
+			VkBufferUsageFlags usage;
+			uint32_t padding;
+		};
+
+		struct Pass
+		{
+			String name;
+			uint32_t kind;
+			uint32_t padding;
+			uint64_t signature;
+			uint32_t imageBarrierBegin;
+			uint32_t imageBarrierCount;
+			uint32_t bufferBarrierBegin;
+			uint32_t bufferBarrierCount;
+		};
+
+		struct Attachment
+		{
+			String name;
+			uint32_t view;
+			uint32_t kind;
+			uint32_t loadOp;
+			uint32_t storeOp;
+			uint32_t stencilLoadOp;
+			uint32_t stencilStoreOp;
+		};
+
+		struct BufferAttachment
+		{
+			String name;
+			uint32_t buffer;
+			uint32_t kind;
+			uint64_t offset;
+			uint64_t range;
+		};
+
+		struct AttachmentPasses
+		{
+			// Index in the attachments section.
+			uint32_t attachment;
+			// Range in the pass indices section.
+			uint32_t passBegin;
+			uint32_t passCount;
+		};
+
+		struct Transition
+		{
+			// Index in the attachment passes section.
+			uint32_t dstInput;
+			// Range in the attachment passes section.
+			uint32_t srcOutputBegin;
+			uint32_t srcOutputCount;
+		};
+
+		struct Dependency
+		{
+			uint32_t srcPass;
+			uint32_t dstPass;
+			// The source outputs are followed by the destination inputs, in the attachments section.
+			uint32_t attachmentBegin;
+			uint32_t attachmentCount;
+			// The same, in the buffer attachments section.
+			uint32_t bufferBegin;
+			uint32_t bufferCount;
+		};
+
+		struct Edge
+		{
+			// Index in the nodes section, InvalidIndex for the root node.
+			uint32_t prev;
+			// Index in the nodes section.
+			uint32_t next;
+			// Range in the transitions section.
+			uint32_t transitionBegin;
+			uint32_t transitionCount;
+		};
+
+		struct ImageBarrier
+		{
+			uint32_t image;
+			VkImageSubresourceRange subresourceRange;
+			VkImageLayout oldLayout;
+			VkImageLayout newLayout;
+			VkAccessFlags srcAccessMask;
+			VkAccessFlags dstAccessMask;
+			VkPipelineStageFlags srcStageMask;
+			VkPipelineStageFlags dstStageMask;
+		};
+
+		struct BufferBarrier
+		{
+			uint32_t buffer;
+			VkAccessFlags srcAccessMask;
+			uint64_t offset;
+			uint64_t size;
+			VkAccessFlags dstAccessMask;
+			VkPipelineStageFlags srcStageMask;
+			VkPipelineStageFlags dstStageMask;
+			uint32_t padding;
+		};
+	}
+	/**
+	*\brief
+	*	A read only view on contiguous values.
+	*/
+	template< typename TypeT >
+	class ArrayView
+	{
+	public:
+		ArrayView( TypeT const * data = nullptr
+			, size_t size = 0u )
+			: m_data{ data }
+			, m_size{ size }
+		{
+		}
+
+		inline TypeT const * begin()const
+		{
+			return m_data;
+		}
+
+		inline TypeT const * end()const
+		{
+			return m_data + m_size;
+		}
+
+		inline size_t size()const
+		{
+			return m_size;
+		}
+
+		inline bool empty()const
+		{
+			return m_size == 0u;
+		}
+
+		inline TypeT const & operator[]( size_t index )const
+		{
+			return m_data[index];
+		}
+
+		inline ArrayView subView( size_t offset
+			, size_t count )const
+		{
+			return ArrayView{ m_data + offset, count };
+		}
+
+	private:
+		TypeT const * m_data;
+		size_t m_size;
+	};
+	/**
+	*\brief
+	*	Gives access to a compiled graph, stored in the binary format, without copying it.
+	*\remarks
+	*	The memory must outlive this object.
+	*/
+	class CompiledGraph
+	{
+	public:
+		/**
+		*\brief
+		*	Validates the binary data.
+		*\remarks
+		*	Checks the magic number, the version, the endianness, the sections bounds and the content hash.
+		*	If any of them fails, isValid() will return false.
+		*	Checking the content hash reads the whole data once.
+		*/
+		CompiledGraph( void const * data
+			, size_t size );
+
+		inline bool isValid()const
+		{
+			return m_header != nullptr;
+		}
+
+		inline binary::Header const & getHeader()const
+		{
+			return *m_header;
+		}
+		/**
+		*\return
+		*	The hash of the registered passes and resources the graph was compiled from.
+		*/
+		inline uint64_t getGraphHash()const
+		{
+			return m_header->graphHash;
+		}
+
+		/**
+		*\return
+		*	true if the string lies in the strings section.
+		*/
+		inline bool isValid( binary::String const & value )const
+		{
+			return uint64_t( value.offset ) + value.size <= getSection< char >( binary::SectionKind::Strings ).size();
+		}
+		/**
+		*\return
+		*	The string, empty if it doesn't lie in the strings section.
+		*/
+		inline std::string_view getString( binary::String const & value )const
+		{
+			if ( !isValid( value ) )
+			{
+				return {};
+			}
+
+			auto strings = getSection< char >( binary::SectionKind::Strings );
+			return std::string_view{ strings.begin() + value.offset, value.size };
+		}
+
+		template< typename TypeT >
+		inline ArrayView< TypeT > getSection( binary::SectionKind kind )const
+		{
+			auto & section = m_header->sections[size_t( kind )];
+			return ArrayView< TypeT >{ reinterpret_cast< TypeT const * >( m_data + section.offset )
+				, section.count };
+		}
+
+		inline ArrayView< binary::Pass > getPasses()const
+		{
+			return getSection< binary::Pass >( binary::SectionKind::Passes );
+		}
+
+		inline ArrayView< binary::Image > getImages()const
+		{
+			return getSection< binary::Image >( binary::SectionKind::Images );
+		}
+
+		inline ArrayView< binary::View > getViews()const
+		{
+			return getSection< binary::View >( binary::SectionKind::Views );
+		}
+
+		inline ArrayView< binary::Buffer > getBuffers()const
+		{
+			return getSection< binary::Buffer >( binary::SectionKind::Buffers );
+		}
+
+		inline ArrayView< binary::ImageBarrier > getImageBarriers( binary::Pass const & pass )const
+		{
+			return getSection< binary::ImageBarrier >( binary::SectionKind::ImageBarriers )
+				.subView( pass.imageBarrierBegin, pass.imageBarrierCount );
+		}
+
+		inline ArrayView< binary::BufferBarrier > getBufferBarriers( binary::Pass const & pass )const
+		{
+			return getSection< binary::BufferBarrier >( binary::SectionKind::BufferBarriers )
+				.subView( pass.bufferBarrierBegin, pass.bufferBarrierCount );
+		}
+
+	private:
+		uint8_t const * m_data{};
+		binary::Header const * m_header{};
+	};
+}
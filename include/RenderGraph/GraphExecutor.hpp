@@ -0,0 +1,139 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	The recorded commands reuse counters, for cacheable passes.
+	*/
+	struct CacheStats
+	{
+		// Cacheable passes which were stitched without being recorded again.
+		uint64_t hits{};
+		// Cacheable passes which had to be recorded.
+		uint64_t misses{};
+	};
+	/**
+	*\brief
+	*	Records the passes of a compiled graph in parallel, then stitches the results in execution order.
+	*\remarks
+	*	Recording a pass doesn't depend on the other passes, so all of them are recorded at once.
+	*	Each pass records into its own sink (a secondary command buffer, for example), selected from its index in the execution order.
+	*	The thread index allows using per-thread resources, such as command pools.
+	*	The sinks are then stitched on the calling thread, following the graph execution order.
+	*	Passes declared as cacheable are recorded again only when they are dirty, their previous sink being stitched otherwise.
+	*/
+	class GraphExecutor
+	{
+	public:
+		/**
+		*\brief
+		*	Records the commands of a pass, into the sink at given index.
+		*/
+		using RecordFunc = std::function< void( RenderPass const & pass, uint32_t index, uint32_t thread ) >;
+		/**
+		*\brief
+		*	Appends the sink at given index to the final command stream.
+		*/
+		using StitchFunc = std::function< void( RenderPass const & pass, uint32_t index ) >;
+		/**
+		*\brief
+		*	Runs job( index, thread ) for each index in [0, count), and returns when all of them are done.
+		*\remarks
+		*	Allows plugging in a user job system, thread indices must be stable for a given worker.
+		*/
+		using JobSystem = std::function< void( uint32_t count, std::function< void( uint32_t index, uint32_t thread ) > const & job ) >;
+
+		GraphExecutor( RenderGraph const & graph
+			, ThreadPool & pool );
+		GraphExecutor( RenderGraph const & graph
+			, JobSystem jobSystem );
+		GraphExecutor( GraphExecutor const & ) = delete;
+		GraphExecutor & operator=( GraphExecutor const & ) = delete;
+		/**
+		*\brief
+		*	Records all the passes from the graph execution order, then stitches them.
+		*/
+		void run( RecordFunc const & record
+			, StitchFunc const & stitch );
+		/**
+		*\brief
+		*	Declares the commands recorded for the named pass as reusable from one run to the other.
+		*\remarks
+		*	The pass is recorded again when the user version changes, or when a compilation changed
+		*	the pass, the transitions it is involved in, or its index in the execution order.
+		*/
+		void setCacheable( std::string const & passName
+			, uint64_t version = 0u );
+		/**
+		*\brief
+		*	The named pass will be recorded at each run.
+		*/
+		void setUncacheable( std::string const & passName );
+
+		inline CacheStats const & getCacheStats()const
+		{
+			return m_cacheStats;
+		}
+
+		inline void resetCacheStats()
+		{
+			m_cacheStats = {};
+		}
+		/**
+		*\brief
+		*	Enables or disables the measure of the time spent recording each pass.
+		*/
+		inline void enableRecordTimes( bool enable )
+		{
+			m_recordTimesEnabled = enable;
+		}
+		/**
+		*\return
+		*	The time spent recording each pass, in execution order.
+		*\remarks
+		*	Passes stitched from the cache keep the time of their last recording.
+		*/
+		inline std::vector< std::chrono::nanoseconds > const & getRecordTimes()const
+		{
+			return m_recordTimes;
+		}
+
+	private:
+		struct CacheEntry
+		{
+			bool cacheable{};
+			uint64_t version{};
+			bool recorded{};
+			uint64_t recordedVersion{};
+			size_t recordedSignature{};
+			uint32_t recordedIndex{};
+		};
+
+		void doUpdateEntries();
+		void doRecord( uint32_t index, uint32_t thread );
+
+	private:
+		RenderGraph const & m_graph;
+		JobSystem m_jobSystem;
+		std::function< void( uint32_t, uint32_t ) > m_recordJob;
+		RecordFunc const * m_record{};
+		std::unordered_map< std::string, CacheEntry > m_cache;
+		std::vector< CacheEntry * > m_entries;
+		std::vector< uint32_t > m_dirty;
+		uint32_t m_compileCount{};
+		CacheStats m_cacheStats;
+		bool m_recordTimesEnabled{};
+		std::vector< std::chrono::nanoseconds > m_recordTimes;
+	};
+}
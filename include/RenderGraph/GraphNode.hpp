@@ -58,19 +58,34 @@ namespace crg
 		{
 			return name;
 		}
+		/**
+		*\return
+		*	The dense index of the node in its graph, 0 for the root node, N + 1 for the Nth pass node.
+		*/
+		inline uint32_t getIndex()const
+		{
+			return index;
+		}
 
 		inline auto & getNext()const
 		{
 			return next;
 		}
 
+		inline AttachmentsNodeMap const & getAllAttachsToPrev()const
+		{
+			return attachsToPrev;
+		}
+
 	protected:
 		GraphNode( Kind kind
+			, uint32_t index
 			, std::string name
 			, AttachmentsNodeMap attachments );
 
 	protected:
 		Kind kind;
+		uint32_t index;
 		std::string name;
 		GraphAdjacentNodeArray next;
 		AttachmentsNodeMap attachsToPrev;
@@ -86,7 +101,8 @@ namespace crg
 	{
 		static constexpr Kind MyKind = Kind::RenderPass;
 
-		RenderPassNode( RenderPass const & pass );
+		RenderPassNode( RenderPass const & pass
+			, uint32_t index );
 		void accept( GraphVisitor * vis )override;
 
 		inline RenderPass const & getRenderPass()const
@@ -0,0 +1,162 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/GraphNode.hpp"
+
+#include <iterator>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	Iterative traversals of a compiled graph, from its root node.
+	*\remarks
+	*	The visited nodes are marked in an array indexed by GraphNode::getIndex(), with the traversal epoch,
+	*	so that starting a traversal doesn't clear it.
+	*	The arrays are allocated when the traversal is created, and only grow if the graph is compiled again with more nodes,
+	*	so that traversing a compiled graph doesn't allocate.
+	*	Only one traversal at a time can be iterated, starting a traversal invalidates the iterators of the previous one.
+	*/
+	class GraphTraversal
+	{
+	public:
+		enum class Order
+		{
+			// The root node, then its next nodes, then their next nodes...
+			BreadthFirst,
+			// The root node, then each next node followed by the nodes reached from it (pre-order).
+			DepthFirst,
+			// Each node before its next nodes, the edges closing a cycle being ignored (reverse post-order).
+			Topological,
+		};
+
+		// All the copies of an iterator share the traversal state, so it is a single pass iterator.
+		class Iterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = GraphAdjacentNode;
+			using difference_type = std::ptrdiff_t;
+			using pointer = GraphAdjacentNode const *;
+			using reference = GraphAdjacentNode const &;
+
+			Iterator() = default;
+
+			Iterator( GraphTraversal & traversal
+				, GraphAdjacentNode node )
+				: m_traversal{ &traversal }
+				, m_node{ node }
+			{
+			}
+
+			inline reference operator*()const
+			{
+				return m_node;
+			}
+
+			inline Iterator & operator++()
+			{
+				m_node = m_traversal->next();
+				return *this;
+			}
+
+			inline Iterator operator++( int )
+			{
+				auto result = *this;
+				++( *this );
+				return result;
+			}
+
+			inline bool operator==( Iterator const & rhs )const
+			{
+				return m_node == rhs.m_node;
+			}
+
+			inline bool operator!=( Iterator const & rhs )const
+			{
+				return m_node != rhs.m_node;
+			}
+
+		private:
+			GraphTraversal * m_traversal{};
+			GraphAdjacentNode m_node{};
+		};
+
+		class Range
+		{
+		public:
+			Range( GraphTraversal & traversal
+				, GraphAdjacentNode first )
+				: m_traversal{ traversal }
+				, m_first{ first }
+			{
+			}
+
+			inline Iterator begin()const
+			{
+				return Iterator{ m_traversal, m_first };
+			}
+
+			inline Iterator end()const
+			{
+				return Iterator{ m_traversal, nullptr };
+			}
+
+		private:
+			GraphTraversal & m_traversal;
+			GraphAdjacentNode m_first;
+		};
+
+	public:
+		explicit GraphTraversal( RenderGraph & graph );
+		/**
+		*\brief
+		*	Starts a traversal in given order.
+		*\return
+		*	The range of the visited nodes, the root node being included.
+		*/
+		Range traverse( Order order );
+
+		inline Range breadthFirst()
+		{
+			return traverse( Order::BreadthFirst );
+		}
+
+		inline Range depthFirst()
+		{
+			return traverse( Order::DepthFirst );
+		}
+
+		inline Range topological()
+		{
+			return traverse( Order::Topological );
+		}
+
+	private:
+		struct Frame
+		{
+			GraphAdjacentNode node;
+			uint32_t next;
+		};
+
+		void resize();
+		bool visit( GraphAdjacentNode node );
+		GraphAdjacentNode next();
+		GraphAdjacentNode nextBreadthFirst();
+		GraphAdjacentNode nextDepthFirst();
+
+	private:
+		RenderGraph & m_graph;
+		Order m_order{};
+		// The epoch of the traversal which last visited each node.
+		std::vector< uint32_t > m_visited;
+		uint32_t m_epoch{};
+		// The breadth first queue, and the topological order, the current node being at m_cursor.
+		std::vector< GraphAdjacentNode > m_nodes;
+		size_t m_cursor{};
+		std::vector< Frame > m_stack;
+	};
+}
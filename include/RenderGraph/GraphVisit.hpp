@@ -0,0 +1,99 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/GraphTraversal.hpp"
+#include "RenderGraph/RenderGraph.hpp"
+
+#include <type_traits>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	Merges function objects, lambdas for instance, into one holding all their call operators.
+	*/
+	template< typename ... FuncsT >
+	struct Overloaded
+		: FuncsT...
+	{
+		using FuncsT::operator()...;
+	};
+
+	template< typename ... FuncsT >
+	Overloaded( FuncsT... ) -> Overloaded< FuncsT... >;
+
+	namespace details
+	{
+		template< typename NodeT, typename FuncT >
+		inline void visitIfInvocable( NodeT & node
+			, FuncT & func )
+		{
+			if constexpr ( std::is_invocable_v< FuncT &, NodeT & > )
+			{
+				func( node );
+			}
+		}
+	}
+	/**
+	*\brief
+	*	Calls the overload of func taking the node concrete type, if there is one.
+	*\remarks
+	*	This is a switch on the node kind, which the compiler can inline, instead of GraphNode::accept() virtual call.
+	*/
+	template< typename FuncT >
+	void visit( GraphNode & node
+		, FuncT && func )
+	{
+		switch ( node.getKind() )
+		{
+		case GraphNode::Kind::Root:
+			details::visitIfInvocable( nodeCast< RootNode >( node ), func );
+			break;
+		case GraphNode::Kind::RenderPass:
+			details::visitIfInvocable( nodeCast< RenderPassNode >( node ), func );
+			break;
+		default:
+			break;
+		}
+	}
+	/**
+	*\brief
+	*	Calls the overload of funcs taking RootNode for the root node, then the one taking RenderPassNode for each pass node.
+	*\remarks
+	*	The nodes are read from the arrays holding each kind, in the order of their index, so there is no dispatch at all.
+	*	Node kinds without overload are skipped.
+	*/
+	template< typename ... FuncsT >
+	void visit( RenderGraph & graph
+		, FuncsT && ... funcs )
+	{
+		Overloaded< std::decay_t< FuncsT >... > func{ std::forward< FuncsT >( funcs )... };
+		details::visitIfInvocable( graph.getRootNode(), func );
+
+		if constexpr ( std::is_invocable_v< decltype( func ) &, RenderPassNode & > )
+		{
+			for ( auto & node : graph.getPassNodes() )
+			{
+				func( *node );
+			}
+		}
+	}
+	/**
+	*\brief
+	*	Calls the overload of funcs taking the node concrete type, for each node of a traversal, in its order.
+	*/
+	template< typename ... FuncsT >
+	void visit( GraphTraversal::Range const & range
+		, FuncsT && ... funcs )
+	{
+		Overloaded< std::decay_t< FuncsT >... > func{ std::forward< FuncsT >( funcs )... };
+
+		for ( auto node : range )
+		{
+			visit( *node, func );
+		}
+	}
+}
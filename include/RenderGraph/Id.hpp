@@ -8,29 +8,44 @@ See LICENSE file in root folder.
 
 namespace crg
 {
+	/**
+	*\brief
+	*	A handle to a value owned by a RenderGraph.
+	*\remarks
+	*	The id is the value slot, the generation allows detecting handles to a value which was destroyed.
+	*	A zero id is never valid.
+	*/
 	template< typename TypeT >
 	struct Id
 	{
 		uint32_t id;
-		TypeT const * data;
+		uint32_t generation;
 	};
 
 	template< typename TypeT >
 	inline bool operator<( Id< TypeT > const & lhs, Id< TypeT > const & rhs )
 	{
-		return lhs.id < rhs.id;
+		return lhs.id < rhs.id
+			|| ( lhs.id == rhs.id && lhs.generation < rhs.generation );
 	}
 
 	template< typename TypeT >
 	inline bool operator>( Id< TypeT > const & lhs, Id< TypeT > const & rhs )
 	{
-		return lhs.id > rhs.id;
+		return rhs < lhs;
 	}
 
 	template< typename TypeT >
 	inline bool operator==( Id< TypeT > const & lhs, Id< TypeT > const & rhs )
 	{
-		return lhs.id == rhs.id;
+		return lhs.id == rhs.id
+			&& lhs.generation == rhs.generation;
+	}
+
+	template< typename TypeT >
+	inline bool operator!=( Id< TypeT > const & lhs, Id< TypeT > const & rhs )
+	{
+		return !( lhs == rhs );
 	}
 
 	template< typename TypeT >
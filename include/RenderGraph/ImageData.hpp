@@ -4,7 +4,7 @@ See LICENSE file in root folder.
 */
 #pragma once
 
-#include "RenderGraphPrerequisites.hpp"
+#include "Id.hpp"
 
 namespace crg
 {
@@ -35,4 +35,14 @@ namespace crg
 			&& lhs.tiling == rhs.tiling
 			&& lhs.usage == rhs.usage;
 	}
+	/**
+	*\brief
+	*	An image holding the content of a history image, from a previous frame.
+	*/
+	struct HistoryAlias
+	{
+		ImageId image;
+		uint32_t frameOffset;
+	};
+	using HistoryAliasMap = std::map< ImageId, HistoryAlias >;
 }
@@ -32,7 +32,8 @@ namespace crg
 
 	inline bool operator==( ImageViewData const & lhs, ImageViewData const & rhs )
 	{
-		return lhs.flags == rhs.flags
+		return lhs.image == rhs.image
+			&& lhs.flags == rhs.flags
 			&& lhs.viewType == rhs.viewType
 			&& lhs.format == rhs.format
 			&& lhs.subresourceRange == rhs.subresourceRange;
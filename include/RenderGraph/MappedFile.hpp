@@ -0,0 +1,52 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+namespace crg
+{
+	/**
+	*\brief
+	*	A read only memory mapping of a whole file.
+	*/
+	class MappedFile
+	{
+	public:
+		/**
+		*\brief
+		*	Maps the file.
+		*\remarks
+		*	If the file can't be opened or mapped, isOpen() will return false.
+		*/
+		explicit MappedFile( std::string const & path );
+		~MappedFile();
+		MappedFile( MappedFile const & ) = delete;
+		MappedFile & operator=( MappedFile const & ) = delete;
+
+		inline bool isOpen()const
+		{
+			return m_data != nullptr;
+		}
+
+		inline void const * getData()const
+		{
+			return m_data;
+		}
+
+		inline size_t getSize()const
+		{
+			return m_size;
+		}
+
+	private:
+		void const * m_data{};
+		size_t m_size{};
+#if defined( _WIN32 )
+		void * m_file{};
+		void * m_mapping{};
+#endif
+	};
+}
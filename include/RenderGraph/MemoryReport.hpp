@@ -0,0 +1,57 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+namespace crg
+{
+	/**
+	*\brief
+	*	The memory held by a RenderGraph, as returned by RenderGraph::getMemoryReport().
+	*\remarks
+	*	The host sizes are estimates, in bytes, including the heap blocks bookkeeping, the unused vectors capacity,
+	*	and the containers nodes.
+	*	The GPU sizes are estimates of the memory needed by the registered resources, without alignment nor padding.
+	*/
+	struct MemoryReport
+	{
+		// The graph object itself.
+		size_t graph{};
+		// The registered passes, and their names.
+		size_t passes{};
+		// The attachments of the registered passes.
+		size_t attachments{};
+		// The images map, including history images backings and aliases.
+		size_t images{};
+		// The image views map.
+		size_t views{};
+		// The buffers map.
+		size_t buffers{};
+		// The graph nodes, with their next nodes lists.
+		size_t nodes{};
+		// The transitions held by the graph nodes, per previous node.
+		size_t attachsToPrev{};
+		// The compiled transitions.
+		size_t transitions{};
+		// The dependencies between passes, within a frame and from a frame to the next ones.
+		size_t dependencies{};
+		// The execution order, the passes signatures, and the barriers.
+		size_t schedule{};
+		// The part of the above sizes which isn't used by the data: bookkeeping, padding, unused capacity.
+		size_t slack{};
+		// The sum of all the above sizes, except slack, which is already included.
+		size_t hostTotal{};
+		// The registered images, history backings included, but not their aliases.
+		VkDeviceSize gpuImages{};
+		// The registered buffers.
+		VkDeviceSize gpuBuffers{};
+	};
+	/**
+	*\return
+	*	The estimated memory size of an image, all mip levels and array layers included.
+	*/
+	VkDeviceSize getMemorySize( ImageData const & image );
+}
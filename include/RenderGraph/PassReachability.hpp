@@ -0,0 +1,77 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+#include <vector>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	The representations of PassReachability, from the fastest to the smallest.
+	*/
+	enum class ReachabilityMode
+	{
+		// A bitset per component, of the components it reaches.
+		Matrix,
+		// The components are split in chains of dependent components,
+		// and each component keeps the first position it reaches in each chain.
+		Chains,
+		// Only the dependencies between components are kept, and searched for each query.
+		Search,
+	};
+	/**
+	*\brief
+	*	Tells, for two passes, if the second one transitively depends on the first one.
+	*\remarks
+	*	The queries are done on the strongly connected components of the passes, numbered in topological order.
+	*	The passes of a cycle all reach each other, themselves included.
+	*	The matrix is used when it fits in the maximum size, the chains otherwise, and the search as a last resort.
+	*/
+	struct PassReachability
+	{
+		// The maximum size of the matrix or of the chains, 16MB being enough for a matrix of 11k components.
+		static size_t constexpr DefaultMaxSize = 16u * 1024u * 1024u;
+
+		ReachabilityMode mode{};
+		uint32_t componentCount{};
+		// The component of each pass, by pass registration index.
+		std::vector< uint32_t > passComponents;
+		// Matrix: the row of a component holds wordCount words, the bit N being set if it reaches component N.
+		uint32_t wordCount{};
+		std::vector< uint64_t > bits;
+		// Chains: the row of a component holds chainCount positions, the first one it reaches in each chain, ~0u if none.
+		uint32_t chainCount{};
+		std::vector< uint32_t > componentChains;
+		std::vector< uint32_t > chainPositions;
+		std::vector< uint32_t > chainReaches;
+		// Search: the components following component N are nexts[nextOffsets[N]] to nexts[nextOffsets[N + 1] - 1],
+		// a component in a cycle being followed by itself.
+		std::vector< uint32_t > nextOffsets;
+		std::vector< uint32_t > nexts;
+		/**
+		*\return
+		*	true if a path of at least one dependency goes from component src to component dst.
+		*/
+		bool reachesComponent( uint32_t src
+			, uint32_t dst )const;
+		/**
+		*\return
+		*	true if the pass with registration index dst transitively depends on the one with index src.
+		*/
+		inline bool reaches( uint32_t src
+			, uint32_t dst )const
+		{
+			return reachesComponent( passComponents[src], passComponents[dst] );
+		}
+
+		inline bool empty()const
+		{
+			return passComponents.empty();
+		}
+	};
+}
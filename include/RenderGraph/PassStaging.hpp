@@ -0,0 +1,106 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/BufferData.hpp"
+#include "RenderGraph/ImageData.hpp"
+#include "RenderGraph/ImageViewData.hpp"
+#include "RenderGraph/RenderPass.hpp"
+
+namespace crg
+{
+	/**
+	*\brief
+	*	Registers images, views, buffers and passes from one thread, to be added to its RenderGraph later.
+	*\remarks
+	*	A staging doesn't lock anything, and must only be used by one thread at a time.
+	*	The handles it returns are local to it: they can be used in its own views and passes, as well as the
+	*	handles created by the graph before, and are replaced by the graph ones when the stagings are merged.
+	*	The stagings are merged in the order of their names, so that the graph doesn't depend on the threads timing.
+	*/
+	class PassStaging
+	{
+	public:
+		// The generation bit telling that a handle is local to a staging, the other bits holding the staging index.
+		static uint32_t constexpr StagedGeneration = 0x80000000u;
+
+		PassStaging( std::string name
+			, uint32_t index );
+		ImageId createImage( ImageData const & img );
+		ImageViewId createView( ImageViewData const & view );
+		BufferId createBuffer( BufferData const & buffer );
+		/**
+		*\brief
+		*	Registers a copy of given pass.
+		*\remarks
+		*	The duplicate names are only detected when merging the stagings.
+		*/
+		void add( RenderPass const & pass );
+		/**
+		*\brief
+		*	Removes everything which was registered, the handles it returned being invalid from now on.
+		*/
+		void clear();
+
+		template< typename DataT >
+		static bool isStaged( Id< DataT > id )
+		{
+			return ( id.generation & StagedGeneration ) != 0u;
+		}
+
+		template< typename DataT >
+		static uint32_t getStagingIndex( Id< DataT > id )
+		{
+			return id.generation & ~StagedGeneration;
+		}
+
+		inline std::string const & getName()const
+		{
+			return m_name;
+		}
+
+		inline uint32_t getIndex()const
+		{
+			return m_index;
+		}
+
+		inline std::vector< ImageData > const & getImages()const
+		{
+			return m_images;
+		}
+
+		inline std::vector< ImageViewData > const & getViews()const
+		{
+			return m_views;
+		}
+
+		inline std::vector< BufferData > const & getBuffers()const
+		{
+			return m_buffers;
+		}
+
+		inline RenderPassArray const & getPasses()const
+		{
+			return m_passArray;
+		}
+
+		inline bool empty()const
+		{
+			return m_images.empty()
+				&& m_views.empty()
+				&& m_buffers.empty()
+				&& m_passes.empty();
+		}
+
+	private:
+		std::string m_name;
+		uint32_t m_index;
+		std::vector< ImageData > m_images;
+		std::vector< ImageViewData > m_views;
+		std::vector< BufferData > m_buffers;
+		RenderPassPtrArray m_passes;
+		RenderPassArray m_passArray;
+	};
+}
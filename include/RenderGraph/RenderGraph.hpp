@@ -5,43 +5,429 @@ See LICENSE file in root folder.
 #pragma once
 
 #include "Attachment.hpp"
+#include "Barrier.hpp"
+#include "BufferData.hpp"
+#include "CompileStats.hpp"
 #include "ImageData.hpp"
 #include "ImageViewData.hpp"
 #include "GraphNode.hpp"
+#include "MemoryReport.hpp"
+#include "PassReachability.hpp"
+#include "PassStaging.hpp"
 #include "RenderPass.hpp"
+#include "RenderPassDependencies.hpp"
+#include "SlotMap.hpp"
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace crg
 {
+	/**
+	*\brief
+	*	The algorithms used by RenderGraph::compile().
+	*/
+	enum class CompileMode
+	{
+		// The indexed algorithms.
+		Optimised,
+		// The straightforward algorithms, which the optimised ones must match.
+		Reference,
+		// Compiles with the optimised algorithms, then with the reference ones,
+		// and throws an Exception describing the first divergence, if any.
+		CrossCheck,
+	};
+
 	class RenderGraph
 	{
 	public:
 		RenderGraph( std::string name = "RenderGraph" );
-		void add( RenderPass const & pass );
+		/**
+		*\brief
+		*	Registers a copy of given pass.
+		*\return
+		*	The handle of the registered pass, which stays valid until it is removed.
+		*/
+		PassId add( RenderPass const & pass );
+		/**
+		*\brief
+		*	Unregisters the pass with given handle.
+		*\remarks
+		*	The compiled data referencing it is cleared, compile() must be called again.
+		*/
+		void remove( PassId pass );
+		/**
+		*\brief
+		*	Unregisters the pass with the same name as given one.
+		*\remarks
+		*	The compiled data referencing it is cleared, compile() must be called again.
+		*/
 		void remove( RenderPass const & pass );
+		/**
+		*\brief
+		*	Retrieves the staging with given name, creating it if needed, to register passes from another thread.
+		*\remarks
+		*	This function is thread safe, the staging being valid as long as the graph.
+		*/
+		PassStaging & getStaging( std::string const & name );
+		/**
+		*\brief
+		*	Adds the content of the stagings to the graph, in the order of their names, and clears them.
+		*\remarks
+		*	It is called by compile(), and must not be called while the stagings are being filled.
+		*	Throws an Exception if a staging uses a handle from another staging.
+		*/
+		void mergeStagings();
 		void compile();
 		ImageId createImage( ImageData const & img );
+		/**
+		*\brief
+		*	Creates a view, or returns the existing one if a view was already created with identical data.
+		*/
 		ImageViewId createView( ImageViewData const & img );
+		BufferId createBuffer( BufferData const & buffer );
+		/**
+		*\brief
+		*	Destroys an image, its slot being reused by the next created one.
+		*\remarks
+		*	For history images, the backing images and the aliases are destroyed too.
+		*	Views and passes still using the image make compile() throw.
+		*/
+		void destroyImage( ImageId image );
+		/**
+		*\brief
+		*	Destroys a view, its slot being reused by the next created one.
+		*\remarks
+		*	The view is only destroyed when there are as many destroyView() as createView() calls which returned it.
+		*	Passes still using the view make compile() throw.
+		*/
+		void destroyView( ImageViewId view );
+		/**
+		*\return
+		*	The data of given handle, throws an Exception if it is stale.
+		*/
+		inline ImageData const & getImage( ImageId image )const
+		{
+			return m_images.get( image );
+		}
+
+		inline ImageViewData const & getView( ImageViewId view )const
+		{
+			return m_imageViews.get( view );
+		}
+
+		inline BufferData const & getBuffer( BufferId buffer )const
+		{
+			return m_buffers.get( buffer );
+		}
+		/**
+		*\return
+		*	The registered pass with given handle, throws an Exception if it was removed.
+		*/
+		RenderPass const & getPass( PassId pass )const;
+		/**
+		*\brief
+		*	Creates an image which content is kept from one frame to the next.
+		*\remarks
+		*	It is backed by count images, frame K writing to the backing K % count.
+		*	History images are persistent, so they must never be aliased with transient images.
+		*/
+		ImageId createHistoryImage( ImageData const & img
+			, uint32_t count = 2u );
+		/**
+		*\brief
+		*	Creates a view on the content of a history image, from a previous frame.
+		*\remarks
+		*	Reading from this view creates a dependency with the passes writing to the history image
+		*	in the previous frames, instead of the ones of the current frame.
+		*\param[in] view
+		*	A view on a history image.
+		*\param[in] frameOffset
+		*	The number of frames to look back, in [1, count).
+		*/
+		ImageViewId createHistoryView( ImageViewId view
+			, uint32_t frameOffset = 1u );
+		/**
+		*\return
+		*	true if the image is a history image, or the view of one from a previous frame.
+		*/
+		bool isHistoryImage( ImageId image )const;
+		/**
+		*\brief
+		*	Resolves the image to use for given frame index.
+		*\return
+		*	The backing image, for history images and their previous frames aliases, the image itself otherwise.
+		*/
+		ImageId getBackingImage( ImageId image
+			, uint32_t frameIndex )const;
+		/**
+		*\brief
+		*	A hash of the registered passes and resources, which stays the same from one run to another.
+		*/
+		uint64_t getGraphHash()const;
+		/**
+		*\brief
+		*	Writes the compiled graph in the binary format (see CompiledGraph.hpp).
+		*\remarks
+		*	The graph must have been compiled.
+		*/
+		std::vector< uint8_t > serialise()const;
+		/**
+		*\brief
+		*	Restores the compiled state from a compiled graph, instead of compiling.
+		*\remarks
+		*	The compiled graph is read in place, but decoded into the same state compile() builds:
+		*	this allocates the dependencies, nodes, transitions and barriers.
+		*\return
+		*	false if the data is invalid, or if it was compiled from other passes or resources.
+		*	In that case, the current compiled state is kept.
+		*/
+		bool load( CompiledGraph const & compiled );
+		/**
+		*\brief
+		*	Sets the cache used by compile(), nullptr to disable it.
+		*\remarks
+		*	compile() then loads the matching cache entry if there is one, and writes it otherwise.
+		*	The cache must outlive the graph, or be unset before being destroyed.
+		*/
+		inline void setCompileCache( CompileCache * cache )
+		{
+			m_compileCache = cache;
+		}
+		/**
+		*\brief
+		*	Selects the algorithms used by compile().
+		*/
+		inline void setCompileMode( CompileMode mode )
+		{
+			m_compileMode = mode;
+		}
+
+		inline CompileMode getCompileMode()const
+		{
+			return m_compileMode;
+		}
+		/**
+		*\brief
+		*	Enables or disables the compile stats gathering.
+		*\remarks
+		*	When disabled, compile() doesn't read any clock nor update any counter.
+		*/
+		inline void enableCompileStats( bool enable )
+		{
+			m_compileStatsEnabled = enable;
+		}
+		/**
+		*\brief
+		*	Sets the function receiving the stats at the end of each compilation, and enables them.
+		*/
+		inline void setCompileStatsCallback( CompileStatsCallback callback )
+		{
+			m_compileStatsCallback = std::move( callback );
+			m_compileStatsEnabled = true;
+		}
+		/**
+		*\brief
+		*	Sets the function used to count the allocations made by each compilation phase.
+		*/
+		inline void setAllocationCounter( AllocationCounter counter )
+		{
+			m_allocationCounter = std::move( counter );
+		}
+		/**
+		*\return
+		*	The stats of the last compilation, if they were enabled.
+		*/
+		inline CompileStats const & getCompileStats()const
+		{
+			return m_compileStats;
+		}
+		/**
+		*\brief
+		*	Estimates the host memory held by the graph, per category, and the GPU memory of its resources.
+		*/
+		MemoryReport getMemoryReport()const;
 
 		inline GraphAdjacentNode getGraph()
 		{
 			return &m_root;
 		}
 
+		inline RootNode & getRootNode()
+		{
+			return m_root;
+		}
+		/**
+		*\brief
+		*	The nodes of the compiled graph, other than the root node, in the order of their index.
+		*/
+		inline RenderPassNodePtrArray const & getPassNodes()const
+		{
+			return m_nodes;
+		}
+		/**
+		*\return
+		*	The number of nodes in the compiled graph, the root node included.
+		*/
+		inline uint32_t getNodeCount()const
+		{
+			return uint32_t( m_nodes.size() + 1u );
+		}
+
 		inline AttachmentTransitionArray const & getTransitions()
 		{
 			return m_transitions;
 		}
 
+		inline RenderPassDependenciesArray const & getDependencies()const
+		{
+			return m_dependencies;
+		}
+		/**
+		*\brief
+		*	The dependency cycles between passes, found in linear time by compile().
+		*\remarks
+		*	They are found before building the graph, so they are also available when compile() throws for lack of a root or a leaf pass.
+		*	The execution order keeps the passes of each cycle together.
+		*/
+		inline RenderPassCycleArray const & getCycles()const
+		{
+			return m_cycles;
+		}
+		/**
+		*\return
+		*	true if pass transitively depends on other, i.e. if it must run after it.
+		*\remarks
+		*	Answered in constant time from the reachability computed by compile(), unless it fell back to the search.
+		*	The passes of a cycle depend on each other, and on themselves.
+		*	Throws an Exception if the graph is not compiled.
+		*/
+		bool dependsOn( PassId pass
+			, PassId other )const;
+		bool dependsOn( RenderPass const & pass
+			, RenderPass const & other )const;
+		/**
+		*\return
+		*	For each of the others, true if pass transitively depends on it.
+		*/
+		std::vector< bool > dependsOn( RenderPass const & pass
+			, RenderPassArray const & others )const;
+		/**
+		*\return
+		*	The passes given pass transitively depends on, in registration order.
+		*/
+		RenderPassArray getTransitiveDependencies( RenderPass const & pass )const;
+		/**
+		*\brief
+		*	The reachability between passes, computed by compile().
+		*/
+		inline PassReachability const & getReachability()const
+		{
+			return m_reachability;
+		}
+		/**
+		*\brief
+		*	Sets the maximum size in bytes of the reachability matrix, or of its chains, computed by compile().
+		*\remarks
+		*	When neither fit, the queries search the dependencies between the passes.
+		*/
+		inline void setReachabilityMaxSize( size_t size )
+		{
+			m_reachabilityMaxSize = size;
+		}
+		/**
+		*\brief
+		*	The passes, sorted so that each pass comes after the passes it depends on.
+		*/
+		inline RenderPassArray const & getExecutionOrder()const
+		{
+			return m_executionOrder;
+		}
+		/**
+		*\brief
+		*	For each pass of the execution order, a hash of its attachments and of the transitions it is involved in.
+		*/
+		inline std::vector< size_t > const & getPassSignatures()const
+		{
+			return m_passSignatures;
+		}
+		/**
+		*\brief
+		*	The number of successful compilations, allows detecting that the compiled data changed.
+		*/
+		inline uint32_t getCompileCount()const
+		{
+			return m_compileCount;
+		}
+		/**
+		*\brief
+		*	For each pass of the execution order, the barriers to issue before running it.
+		*/
+		inline PassBarriersArray const & getBarriers()const
+		{
+			return m_barriers;
+		}
+		/**
+		*\brief
+		*	The dependencies between passes writing history images, and passes reading them in the next frames.
+		*/
+		inline RenderPassDependenciesArray const & getHistoryDependencies()const
+		{
+			return m_historyDependencies;
+		}
+
+	private:
+		void compactPasses();
+		void clearCompiled();
+		void crossCheck()const;
+		uint32_t getCompiledPassIndex( uint32_t passId )const;
+		uint32_t getCompiledPassIndex( RenderPass const & pass )const;
+
 	private:
+		// The registered passes, in registration order, the removed ones being null until compactPasses().
 		std::vector< RenderPassPtr > m_passes;
+		uint32_t m_removedPassCount{};
+		uint32_t m_lastPassId{};
+		// The registered passes ids, from their names.
+		std::unordered_map< std::string_view, uint32_t > m_passIds;
+		// The registered passes indices in m_passes, from their ids.
+		std::unordered_map< uint32_t, uint32_t > m_passIndices;
+		// The stagings, sorted by name, so that they are merged in the same order whatever the threads timing.
+		std::map< std::string, std::unique_ptr< PassStaging > > m_stagings;
+		// Held by pointer, to keep the graph movable.
+		std::unique_ptr< std::mutex > m_stagingsMutex{ std::make_unique< std::mutex >() };
 		AttachmentArray m_attachments;
-		std::map< ImageId, std::unique_ptr< ImageData > > m_images;
-		std::map< ImageViewId, std::unique_ptr< ImageViewData > > m_imageViews;
-		GraphNodePtrArray m_nodes;
+		SlotMap< ImageData > m_images;
+		SlotMap< ImageViewData > m_imageViews;
+		// The views, from the hash of their data, so that identical views share the same handle.
+		std::unordered_multimap< size_t, ImageViewId > m_viewIds;
+		// The number of createView() calls which returned each view, indexed by view slot.
+		std::vector< uint32_t > m_viewRefCounts;
+		SlotMap< BufferData > m_buffers;
+		std::map< ImageId, ImageIdArray > m_historyImages;
+		HistoryAliasMap m_historyAliases;
+		// The pass nodes, their index being their position plus one.
+		RenderPassNodePtrArray m_nodes;
 		AttachmentTransitionArray m_transitions;
+		RenderPassDependenciesArray m_dependencies;
+		RenderPassCycleArray m_cycles;
+		PassReachability m_reachability;
+		size_t m_reachabilityMaxSize{ PassReachability::DefaultMaxSize };
+		RenderPassArray m_executionOrder;
+		std::vector< size_t > m_passSignatures;
+		PassBarriersArray m_barriers;
+		RenderPassDependenciesArray m_historyDependencies;
+		uint32_t m_compileCount{};
+		CompileCache * m_compileCache{};
+		CompileMode m_compileMode{ CompileMode::Optimised };
+		bool m_compileStatsEnabled{};
+		CompileStatsCallback m_compileStatsCallback;
+		AllocationCounter m_allocationCounter;
+		CompileStats m_compileStats;
 		RootNode m_root;
 	};
 }
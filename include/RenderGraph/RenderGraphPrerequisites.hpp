@@ -20,28 +20,47 @@ namespace crg
 
 	struct Attachment;
 	struct AttachmentTransition;
+	struct BufferAttachment;
+	struct BufferData;
 	struct ImageData;
 	struct ImageViewData;
 	struct GraphNode;
 	struct RenderPass;
+	struct RenderPassCycle;
 	struct RenderPassDependencies;
+	struct RenderPassNode;
+	struct RootNode;
 
+	class CompileCache;
+	class CompiledGraph;
+	class GraphExecutor;
+	class GraphTraversal;
 	class GraphVisitor;
+	class PassStaging;
 	class RenderGraph;
+	class ThreadPool;
 
 	using ImageId = Id < ImageData >;
 	using ImageViewId = Id < ImageViewData >;
+	using BufferId = Id < BufferData >;
+	using PassId = Id < RenderPass >;
 
 	using RenderPassPtr = std::unique_ptr< RenderPass >;
 	using GraphNodePtr = std::unique_ptr< GraphNode >;
+	using RenderPassNodePtr = std::unique_ptr< RenderPassNode >;
 	using GraphAdjacentNode = GraphNode *;
 	using ConstGraphAdjacentNode = GraphNode const *;
 
 	using AttachmentArray = std::vector< Attachment >;
+	using ImageIdArray = std::vector< ImageId >;
+	using BufferAttachmentArray = std::vector< BufferAttachment >;
 	using AttachmentTransitionArray = std::vector< AttachmentTransition >;
 	using RenderPassPtrArray = std::vector< RenderPassPtr >;
+	using RenderPassArray = std::vector< RenderPass const * >;
 	using GraphNodePtrArray = std::vector< GraphNodePtr >;
+	using RenderPassNodePtrArray = std::vector< RenderPassNodePtr >;
 	using RenderPassDependenciesArray = std::vector< RenderPassDependencies >;
+	using RenderPassCycleArray = std::vector< RenderPassCycle >;
 	using GraphAdjacentNodeArray = std::vector< GraphAdjacentNode >;
 	using AttachmentsNodeMap = std::map< ConstGraphAdjacentNode, AttachmentTransitionArray >;
 }
@@ -5,6 +5,7 @@ See LICENSE file in root folder.
 #pragma once
 
 #include "RenderGraph/Attachment.hpp"
+#include "RenderGraph/BufferAttachment.hpp"
 
 #include <optional>
 
@@ -12,14 +13,56 @@ namespace crg
 {
 	struct RenderPass
 	{
+		enum class Kind
+		{
+			Graphics,
+			Compute,
+			Transfer,
+		};
+		/**
+		*\brief
+		*	Creates a graphics pass.
+		*/
 		RenderPass( std::string const & name
 			, AttachmentArray const & sampled
 			, AttachmentArray const & colourInOuts
-			, std::optional< Attachment > const & depthStencilInOut = std::nullopt );
+			, std::optional< Attachment > const & depthStencilInOut = std::nullopt
+			, BufferAttachmentArray const & buffers = {} );
+		/**
+		*\brief
+		*	Creates a compute pass, reading sampled images and reading/writing storage images.
+		*/
+		static RenderPass createCompute( std::string const & name
+			, AttachmentArray const & sampled
+			, AttachmentArray const & storages
+			, BufferAttachmentArray const & buffers = {} );
+		/**
+		*\brief
+		*	Creates a transfer pass (copies, blits, clears).
+		*\remarks
+		*	In a transfer pass, the storage buffer ranges are the copy sources (read) and destinations (write).
+		*/
+		static RenderPass createTransfer( std::string const & name
+			, AttachmentArray const & transfers
+			, BufferAttachmentArray const & buffers = {} );
 
+		Kind const kind;
 		std::string const name;
 		AttachmentArray const sampled;
 		AttachmentArray const colourInOuts;
 		std::optional< Attachment > const depthStencilInOut;
+		AttachmentArray const storages;
+		AttachmentArray const transfers;
+		BufferAttachmentArray const buffers;
+
+	private:
+		RenderPass( Kind kind
+			, std::string const & name
+			, AttachmentArray const & sampled
+			, AttachmentArray const & colourInOuts
+			, std::optional< Attachment > const & depthStencilInOut
+			, AttachmentArray const & storages
+			, AttachmentArray const & transfers
+			, BufferAttachmentArray const & buffers );
 	};
 }
@@ -5,15 +5,21 @@ See LICENSE file in root folder.
 #pragma once
 
 #include "RenderGraph/Attachment.hpp"
+#include "RenderGraph/BufferAttachment.hpp"
 
 namespace crg
 {
 	struct RenderPassDependencies
 	{
-		RenderPass const * srcPass;
-		RenderPass const * dstPass;
-		AttachmentArray srcOutputs;
-		AttachmentArray dstInputs;
+		RenderPass const * srcPass{};
+		RenderPass const * dstPass{};
+		AttachmentArray srcOutputs{};
+		AttachmentArray dstInputs{};
+		BufferAttachmentArray srcBufferOutputs{};
+		BufferAttachmentArray dstBufferInputs{};
+		// true if the source pass is already ordered before the destination one by other dependencies.
+		// The attachments are kept, but no synchronisation is needed for this dependency.
+		bool redundant{};
 	};
 
 	inline bool operator==( RenderPassDependencies const & lhs
@@ -22,6 +28,20 @@ namespace crg
 		return lhs.dstPass == rhs.dstPass
 			&& lhs.srcPass == rhs.srcPass
 			&& lhs.srcOutputs == rhs.srcOutputs
-			&& lhs.dstInputs == rhs.dstInputs;
+			&& lhs.dstInputs == rhs.dstInputs
+			&& lhs.srcBufferOutputs == rhs.srcBufferOutputs
+			&& lhs.dstBufferInputs == rhs.dstBufferInputs
+			&& lhs.redundant == rhs.redundant;
 	}
+	/**
+	*\brief
+	*	Passes which all depend on each other, directly or through other passes of the cycle.
+	*/
+	struct RenderPassCycle
+	{
+		// The passes, in registration order.
+		RenderPassArray passes;
+		// The dependencies between these passes, with the attachments creating them.
+		RenderPassDependenciesArray dependencies;
+	};
 }
@@ -0,0 +1,154 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/Exception.hpp"
+#include "RenderGraph/Id.hpp"
+
+namespace crg
+{
+	/**
+	*\brief
+	*	Stores values contiguously, and gives them generation-checked handles.
+	*\remarks
+	*	The handle id is the slot index plus one, so that a zero id is never valid.
+	*	Erasing a value increments its slot generation, and makes the slot reusable,
+	*	so that the handles to the erased value are detected as stale.
+	*/
+	template< typename DataT >
+	class SlotMap
+	{
+	public:
+		struct Slot
+		{
+			DataT data;
+			uint32_t generation;
+			bool alive;
+		};
+
+	public:
+		Id< DataT > insert( DataT data )
+		{
+			uint32_t index;
+
+			if ( m_freeSlots.empty() )
+			{
+				index = uint32_t( m_slots.size() );
+				m_slots.push_back( Slot{ std::move( data ), 0u, true } );
+			}
+			else
+			{
+				index = m_freeSlots.back();
+				m_freeSlots.pop_back();
+				auto & slot = m_slots[index];
+				slot.data = std::move( data );
+				slot.alive = true;
+			}
+
+			++m_size;
+			return Id< DataT >{ index + 1u, m_slots[index].generation };
+		}
+		/**
+		*\return
+		*	false if the handle was stale.
+		*/
+		bool erase( Id< DataT > id )
+		{
+			if ( !contains( id ) )
+			{
+				return false;
+			}
+
+			auto index = id.id - 1u;
+			auto & slot = m_slots[index];
+			slot.data = DataT{};
+			slot.alive = false;
+			++slot.generation;
+			m_freeSlots.push_back( index );
+			--m_size;
+			return true;
+		}
+
+		bool contains( Id< DataT > id )const
+		{
+			return id.id != 0u
+				&& id.id <= m_slots.size()
+				&& m_slots[id.id - 1u].alive
+				&& m_slots[id.id - 1u].generation == id.generation;
+		}
+		/**
+		*\return
+		*	nullptr if the handle is stale.
+		*/
+		DataT const * find( Id< DataT > id )const
+		{
+			return contains( id )
+				? &m_slots[id.id - 1u].data
+				: nullptr;
+		}
+		/**
+		*\return
+		*	The handle of the value in the slot with given id, a handle with a zero id if there is none.
+		*/
+		Id< DataT > getHandle( uint32_t id )const
+		{
+			return ( id != 0u
+					&& id <= m_slots.size()
+					&& m_slots[id - 1u].alive )
+				? Id< DataT >{ id, m_slots[id - 1u].generation }
+				: Id< DataT >{};
+		}
+		/**
+		*\brief
+		*	Throws an Exception if the handle is stale.
+		*/
+		DataT const & get( Id< DataT > id )const
+		{
+			if ( !contains( id ) )
+			{
+				CRG_Exception( "Stale or invalid resource handle." );
+			}
+
+			return m_slots[id.id - 1u].data;
+		}
+		/**
+		*\brief
+		*	Calls given function with the handle and the value of each live slot, in slot order.
+		*/
+		template< typename FuncT >
+		void forEach( FuncT func )const
+		{
+			for ( uint32_t index = 0u; index < m_slots.size(); ++index )
+			{
+				auto & slot = m_slots[index];
+
+				if ( slot.alive )
+				{
+					func( Id< DataT >{ index + 1u, slot.generation }, slot.data );
+				}
+			}
+		}
+
+		inline size_t size()const
+		{
+			return m_size;
+		}
+
+		inline std::vector< Slot > const & getSlots()const
+		{
+			return m_slots;
+		}
+
+		inline std::vector< uint32_t > const & getFreeSlots()const
+		{
+			return m_freeSlots;
+		}
+
+	private:
+		std::vector< Slot > m_slots;
+		std::vector< uint32_t > m_freeSlots;
+		size_t m_size{};
+	};
+}
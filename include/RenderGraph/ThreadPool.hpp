@@ -0,0 +1,80 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraphPrerequisites.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	A work-stealing thread pool.
+	*\remarks
+	*	Each participating thread owns a range of job indices, it consumes from its front.
+	*	When its range is empty, it steals the back half of another thread's range.
+	*	No allocation happens while running jobs.
+	*/
+	class ThreadPool
+	{
+	public:
+		using JobFunc = std::function< void( uint32_t index, uint32_t thread ) >;
+		/**
+		*\param[in] threadCount
+		*	The number of worker threads, the calling thread comes in addition to them.
+		*/
+		explicit ThreadPool( uint32_t threadCount = std::max( 1u, std::thread::hardware_concurrency() ) - 1u );
+		~ThreadPool();
+		/**
+		*\brief
+		*	Runs func for each index in [0, count), and returns when all of them are done.
+		*\remarks
+		*	The calling thread takes part in the work, with thread index 0.
+		*	If any job throws, the first exception is rethrown from here.
+		*	Only one thread at a time may call this function.
+		*/
+		void parallelFor( uint32_t count
+			, JobFunc const & func );
+		/**
+		*\return
+		*	The number of threads that can run jobs, the calling thread included.
+		*/
+		inline uint32_t getThreadCount()const
+		{
+			return uint32_t( m_ranges.size() );
+		}
+
+	private:
+		struct Range
+		{
+			std::mutex mutex;
+			uint32_t begin{};
+			uint32_t end{};
+		};
+
+		void doWork( uint32_t thread );
+		bool doPopJob( uint32_t thread, uint32_t & index );
+		bool doStealJobs( uint32_t thread );
+		void doRunJob( uint32_t index, uint32_t thread );
+		void doWorkerLoop( uint32_t thread );
+
+	private:
+		std::vector< std::unique_ptr< Range > > m_ranges;
+		std::vector< std::thread > m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_wakeWorkers;
+		std::condition_variable m_wakeCaller;
+		JobFunc const * m_func{};
+		uint32_t m_busyWorkers{};
+		uint64_t m_generation{};
+		bool m_stopped{};
+		std::exception_ptr m_exception;
+	};
+}
@@ -0,0 +1,49 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "CompileStats.hpp"
+
+#include <iosfwd>
+
+namespace crg
+{
+	/**
+	*\brief
+	*	The duration of each pass, in execution order.
+	*\remarks
+	*	Either user cost estimates, or the times measured by GraphExecutor::getRecordTimes().
+	*/
+	using PassTimeArray = std::vector< std::chrono::nanoseconds >;
+	/**
+	*\brief
+	*	Writes the compile phases as a Chrome trace-event JSON document.
+	*\remarks
+	*	The phases are laid out one after the other, in a "compile" process, with the counters as arguments.
+	*/
+	void writeCompileTrace( std::ostream & stream
+		, CompileStats const & stats );
+	/**
+	*\brief
+	*	Writes the schedule of a compiled graph as a Chrome trace-event JSON document.
+	*\remarks
+	*	Each pass kind is executed on its own queue track, a pass starting when its queue
+	*	is free and the passes it depends on are done.
+	*	Dependencies between queues are drawn as "semaphore" flow arrows, and dependencies
+	*	between non consecutive passes of a queue as "splitBarrier" flow arrows.
+	*\param[in] passTimes
+	*	The duration of each pass, must match the execution order size.
+	*/
+	void writeScheduleTrace( std::ostream & stream
+		, RenderGraph const & graph
+		, PassTimeArray const & passTimes );
+	/**
+	*\brief
+	*	Writes both the last compilation phases and the schedule of a compiled graph, in a single document.
+	*/
+	void writeTrace( std::ostream & stream
+		, RenderGraph const & graph
+		, PassTimeArray const & passTimes );
+}
@@ -13,7 +13,7 @@ namespace crg
 		{
 			name,
 			view,
-			true,
+			Kind::Sampled,
 			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			VK_ATTACHMENT_STORE_OP_DONT_CARE,
 			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
@@ -30,7 +30,7 @@ namespace crg
 		{
 			name,
 			view,
-			false,
+			Kind::Colour,
 			loadOp,
 			storeOp,
 			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
@@ -49,7 +49,7 @@ namespace crg
 		{
 			name,
 			view,
-			false,
+			Kind::DepthStencil,
 			loadOp,
 			storeOp,
 			stencilLoadOp,
@@ -57,11 +57,58 @@ namespace crg
 		};
 	}
 
+	Attachment Attachment::createStorage( std::string const & name
+		, VkAttachmentLoadOp loadOp
+		, VkAttachmentStoreOp storeOp
+		, ImageViewId view )
+	{
+		return
+		{
+			name,
+			view,
+			Kind::Storage,
+			loadOp,
+			storeOp,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+		};
+	}
+
+	Attachment Attachment::createTransferSrc( std::string const & name
+		, ImageViewId view )
+	{
+		return
+		{
+			name,
+			view,
+			Kind::Transfer,
+			VK_ATTACHMENT_LOAD_OP_LOAD,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+		};
+	}
+
+	Attachment Attachment::createTransferDst( std::string const & name
+		, ImageViewId view )
+	{
+		return
+		{
+			name,
+			view,
+			Kind::Transfer,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_STORE,
+			VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			VK_ATTACHMENT_STORE_OP_DONT_CARE,
+		};
+	}
+
 	bool operator==( Attachment const & lhs, Attachment const & rhs )
 	{
 		return lhs.name == rhs.name
 			&& lhs.view == rhs.view
-			&& lhs.isSampled == rhs.isSampled
+			&& lhs.kind == rhs.kind
 			&& lhs.loadOp == rhs.loadOp
 			&& lhs.storeOp == rhs.storeOp
 			&& lhs.stencilLoadOp == rhs.stencilLoadOp
@@ -6,6 +6,11 @@ See LICENSE file in root folder.
 
 #include "RenderGraph/RenderPass.hpp"
 
+#include "Hash.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
 namespace crg
 {
 	bool operator==( AttachmentPasses const & lhs, AttachmentPasses const & rhs )
@@ -20,43 +25,60 @@ namespace crg
 			&& lhs.dstInput == rhs.dstInput;
 	}
 
+	namespace
+	{
+		struct AttachmentPtrHash
+		{
+			size_t operator()( Attachment const * attach )const
+			{
+				return details::getHash( *attach );
+			}
+		};
+
+		struct AttachmentPtrEqual
+		{
+			bool operator()( Attachment const * lhs, Attachment const * rhs )const
+			{
+				return *lhs == *rhs;
+			}
+		};
+
+		using AttachmentPtrSet = std::unordered_set< Attachment const *, AttachmentPtrHash, AttachmentPtrEqual >;
+	}
+
 	AttachmentTransitionArray mergeIdenticalTransitions( AttachmentTransitionArray transitions )
 	{
 		AttachmentTransitionArray result;
-		auto findSrcAttach = [&result]( auto it )
+		// The indices in result, by hash of the source and destination attachments.
+		std::unordered_multimap< size_t, size_t > indices;
+
+		for ( auto & transition : transitions )
 		{
-			return std::find_if( result.begin()
-				, result.end()
-				, [&it]( AttachmentTransition const & lookup )
+			auto & srcOutput = transition.srcOutputs.front();
+			auto hash = details::getHash( srcOutput.attachment );
+			details::hashCombine( hash, details::getHash( transition.dstInput.attachment ) );
+			auto range = indices.equal_range( hash );
+			auto it = std::find_if( range.first
+				, range.second
+				, [&result, &srcOutput, &transition]( std::pair< size_t const, size_t > const & lookup )
 				{
-					return lookup.srcOutputs.front().attachment == it->srcOutputs.front().attachment
-						&& lookup.dstInput.attachment == it->dstInput.attachment;
+					auto & merged = result[lookup.second];
+					return merged.srcOutputs.front().attachment == srcOutput.attachment
+						&& merged.dstInput.attachment == transition.dstInput.attachment;
 				} );
-		};
-		auto it = transitions.begin();
 
-		while ( it != transitions.end() )
-		{
-			auto itr = findSrcAttach( it );
-
-			if ( itr == result.end() )
+			if ( it == range.second )
 			{
-				result.push_back( std::move( *it ) );
-				++it;
+				indices.emplace( hash, result.size() );
+				result.push_back( std::move( transition ) );
 			}
 			else
 			{
-				for ( auto pass : it->srcOutputs.front().passes )
-				{
-					itr->srcOutputs.front().passes.insert( pass );
-				}
-
-				for ( auto pass : it->dstInput.passes )
-				{
-					itr->dstInput.passes.insert( pass );
-				}
-
-				it = transitions.erase( it );
+				auto & merged = result[it->second];
+				merged.srcOutputs.front().passes.insert( srcOutput.passes.begin()
+					, srcOutput.passes.end() );
+				merged.dstInput.passes.insert( transition.dstInput.passes.begin()
+					, transition.dstInput.passes.end() );
 			}
 		}
 
@@ -66,32 +88,31 @@ namespace crg
 	AttachmentTransitionArray mergeTransitionsPerInput( AttachmentTransitionArray transitions )
 	{
 		AttachmentTransitionArray result;
-		auto findSrcAttach = [&result]( auto it )
+		// The indices in result, by hash of the destination attachment.
+		std::unordered_multimap< size_t, size_t > indices;
+
+		for ( auto & transition : transitions )
 		{
-			return std::find_if( result.begin()
-				, result.end()
-				, [&it]( AttachmentTransition const & lookup )
+			auto hash = details::getHash( transition.dstInput.attachment );
+			auto range = indices.equal_range( hash );
+			auto it = std::find_if( range.first
+				, range.second
+				, [&result, &transition]( std::pair< size_t const, size_t > const & lookup )
 				{
-					return lookup.dstInput.attachment == it->dstInput.attachment;
+					return result[lookup.second].dstInput.attachment == transition.dstInput.attachment;
 				} );
-		};
-		auto it = transitions.begin();
-
-		while ( it != transitions.end() )
-		{
-			auto itr = findSrcAttach( it );
 
-			if ( itr == result.end() )
+			if ( it == range.second )
 			{
-				result.push_back( std::move( *it ) );
-				++it;
+				indices.emplace( hash, result.size() );
+				result.push_back( std::move( transition ) );
 			}
 			else
 			{
-				itr->srcOutputs.insert( itr->srcOutputs.end()
-					, it->srcOutputs.begin()
-					, it->srcOutputs.end() );
-				it = transitions.erase( it );
+				auto & merged = result[it->second];
+				merged.srcOutputs.insert( merged.srcOutputs.end()
+					, transition.srcOutputs.begin()
+					, transition.srcOutputs.end() );
 			}
 		}
 
@@ -100,20 +121,33 @@ namespace crg
 
 	AttachmentTransitionArray reduceDirectPaths( AttachmentTransitionArray transitions )
 	{
+		// The sampled attachments of each pass, looked up by value.
+		std::unordered_map< RenderPass const *, AttachmentPtrSet > passesSampled;
+		auto isSampledBy = [&passesSampled]( Attachment const & attach
+			, RenderPass const * pass )
+		{
+			auto ires = passesSampled.emplace( pass, AttachmentPtrSet{} );
+
+			if ( ires.second )
+			{
+				for ( auto & sampled : pass->sampled )
+				{
+					ires.first->second.insert( &sampled );
+				}
+			}
+
+			return ires.first->second.end() != ires.first->second.find( &attach );
+		};
+
 		for ( auto & transition : transitions )
 		{
-			if ( transition.dstInput.attachment.isSampled )
+			if ( transition.dstInput.attachment.isSampled() )
 			{
 				auto passIt = transition.dstInput.passes.begin();
 
 				while ( passIt != transition.dstInput.passes.end() )
 				{
-					auto inputPass = *passIt;
-					auto it = std::find( inputPass->sampled.begin()
-						, inputPass->sampled.end()
-						, transition.dstInput.attachment );
-
-					if ( it == inputPass->sampled.end() )
+					if ( !isSampledBy( transition.dstInput.attachment, *passIt ) )
 					{
 						passIt = transition.dstInput.passes.erase( passIt );
 					}
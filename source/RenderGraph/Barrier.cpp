@@ -0,0 +1,72 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/Barrier.hpp"
+
+#include "RenderGraph/ImageViewData.hpp"
+
+namespace crg
+{
+	bool operator==( ImageBarrier const & lhs, ImageBarrier const & rhs )
+	{
+		return lhs.image == rhs.image
+			&& lhs.subresourceRange == rhs.subresourceRange
+			&& lhs.oldLayout == rhs.oldLayout
+			&& lhs.newLayout == rhs.newLayout
+			&& lhs.srcAccessMask == rhs.srcAccessMask
+			&& lhs.dstAccessMask == rhs.dstAccessMask
+			&& lhs.srcStageMask == rhs.srcStageMask
+			&& lhs.dstStageMask == rhs.dstStageMask;
+	}
+
+	bool operator==( BufferBarrier const & lhs, BufferBarrier const & rhs )
+	{
+		return lhs.buffer == rhs.buffer
+			&& lhs.offset == rhs.offset
+			&& lhs.size == rhs.size
+			&& lhs.srcAccessMask == rhs.srcAccessMask
+			&& lhs.dstAccessMask == rhs.dstAccessMask
+			&& lhs.srcStageMask == rhs.srcStageMask
+			&& lhs.dstStageMask == rhs.dstStageMask;
+	}
+
+	VkImageMemoryBarrier makeVkBarrier( ImageBarrier const & barrier
+		, VkImage image
+		, uint32_t srcQueueFamilyIndex
+		, uint32_t dstQueueFamilyIndex )
+	{
+		return VkImageMemoryBarrier
+		{
+			VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			nullptr,
+			barrier.srcAccessMask,
+			barrier.dstAccessMask,
+			barrier.oldLayout,
+			barrier.newLayout,
+			srcQueueFamilyIndex,
+			dstQueueFamilyIndex,
+			image,
+			barrier.subresourceRange,
+		};
+	}
+
+	VkBufferMemoryBarrier makeVkBarrier( BufferBarrier const & barrier
+		, VkBuffer buffer
+		, uint32_t srcQueueFamilyIndex
+		, uint32_t dstQueueFamilyIndex )
+	{
+		return VkBufferMemoryBarrier
+		{
+			VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+			nullptr,
+			barrier.srcAccessMask,
+			barrier.dstAccessMask,
+			srcQueueFamilyIndex,
+			dstQueueFamilyIndex,
+			buffer,
+			barrier.offset,
+			barrier.size,
+		};
+	}
+}
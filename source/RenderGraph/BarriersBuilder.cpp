@@ -0,0 +1,788 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "BarriersBuilder.hpp"
+
+#include "RenderPassDependenciesBuilder.hpp"
+
+#include "RenderGraph/BufferAttachment.hpp"
+#include "RenderGraph/ImageData.hpp"
+#include "RenderGraph/ImageViewData.hpp"
+#include "RenderGraph/RenderGraph.hpp"
+#include "RenderGraph/RenderPass.hpp"
+
+namespace crg
+{
+	namespace details
+	{
+		namespace
+		{
+			constexpr VkAccessFlags WriteAccessMask = VK_ACCESS_SHADER_WRITE_BIT
+				| VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+				| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+				| VK_ACCESS_TRANSFER_WRITE_BIT
+				| VK_ACCESS_HOST_WRITE_BIT
+				| VK_ACCESS_MEMORY_WRITE_BIT;
+
+			struct SubresourceState
+			{
+				VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+				VkAccessFlags access{};
+				VkPipelineStageFlags stages{};
+			};
+
+			bool operator==( SubresourceState const & lhs, SubresourceState const & rhs )
+			{
+				return lhs.layout == rhs.layout
+					&& lhs.access == rhs.access
+					&& lhs.stages == rhs.stages;
+			}
+
+			bool operator!=( SubresourceState const & lhs, SubresourceState const & rhs )
+			{
+				return !( lhs == rhs );
+			}
+
+			struct ImageState
+			{
+				uint32_t mipLevels{};
+				uint32_t arrayLayers{};
+				std::vector< SubresourceState > subresources;
+				bool accessed{};
+				bool firstAccessIsRead{};
+			};
+
+			using ImageStateMap = std::map< ImageId, ImageState >;
+
+			struct BufferSegment
+			{
+				VkDeviceSize offset;
+				VkDeviceSize size;
+				SubresourceState state;
+			};
+
+			struct BufferState
+			{
+				// Sorted, contiguous segments covering the whole buffer.
+				std::vector< BufferSegment > segments;
+				bool accessed{};
+				bool firstAccessIsRead{};
+			};
+
+			using BufferStateMap = std::map< BufferId, BufferState >;
+
+			struct ResourceStates
+			{
+				ImageStateMap images;
+				BufferStateMap buffers;
+			};
+
+			struct ImageAccess
+			{
+				Attachment const * attach;
+				SubresourceState state;
+			};
+
+			bool isWrite( VkAccessFlags access )
+			{
+				return ( access & WriteAccessMask ) != 0u;
+			}
+
+			VkImageAspectFlags getAspectMask( VkFormat format )
+			{
+				switch ( format )
+				{
+				case VK_FORMAT_D16_UNORM:
+				case VK_FORMAT_X8_D24_UNORM_PACK32:
+				case VK_FORMAT_D32_SFLOAT:
+					return VK_IMAGE_ASPECT_DEPTH_BIT;
+				case VK_FORMAT_S8_UINT:
+					return VK_IMAGE_ASPECT_STENCIL_BIT;
+				case VK_FORMAT_D16_UNORM_S8_UINT:
+				case VK_FORMAT_D24_UNORM_S8_UINT:
+				case VK_FORMAT_D32_SFLOAT_S8_UINT:
+					return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+				default:
+					return VK_IMAGE_ASPECT_COLOR_BIT;
+				}
+			}
+
+			VkPipelineStageFlags getShaderStages( RenderPass const & pass )
+			{
+				return pass.kind == RenderPass::Kind::Compute
+					? VkPipelineStageFlags( VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT )
+					: VkPipelineStageFlags( VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT );
+			}
+
+			SubresourceState getSampledState( RenderPass const & pass )
+			{
+				return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+					, VK_ACCESS_SHADER_READ_BIT
+					, getShaderStages( pass ) };
+			}
+
+			SubresourceState getStorageState( RenderPass const & pass
+				, Attachment const & attach )
+			{
+				VkAccessFlags access{};
+
+				if ( attach.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD )
+				{
+					access |= VK_ACCESS_SHADER_READ_BIT;
+				}
+
+				if ( attach.storeOp == VK_ATTACHMENT_STORE_OP_STORE )
+				{
+					access |= VK_ACCESS_SHADER_WRITE_BIT;
+				}
+
+				return { VK_IMAGE_LAYOUT_GENERAL
+					, access
+					, getShaderStages( pass ) };
+			}
+
+			SubresourceState getTransferState( Attachment const & attach )
+			{
+				if ( attach.storeOp == VK_ATTACHMENT_STORE_OP_STORE )
+				{
+					return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+						, VK_ACCESS_TRANSFER_WRITE_BIT
+						, VK_PIPELINE_STAGE_TRANSFER_BIT };
+				}
+
+				return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+					, VK_ACCESS_TRANSFER_READ_BIT
+					, VK_PIPELINE_STAGE_TRANSFER_BIT };
+			}
+
+			SubresourceState getColourState( Attachment const & attach )
+			{
+				VkAccessFlags access{ VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT };
+
+				if ( attach.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD )
+				{
+					access |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+				}
+
+				return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+					, access
+					, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+			}
+
+			SubresourceState getDepthStencilState( Attachment const & attach )
+			{
+				auto stages = VkPipelineStageFlags( VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
+					| VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT );
+
+				if ( attach.storeOp != VK_ATTACHMENT_STORE_OP_STORE
+					&& attach.stencilStoreOp != VK_ATTACHMENT_STORE_OP_STORE )
+				{
+					return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+						, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+						, stages };
+				}
+
+				VkAccessFlags access{ VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+
+				if ( attach.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD
+					|| attach.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD )
+				{
+					access |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+				}
+
+				return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+					, access
+					, stages };
+			}
+
+			SubresourceState getBufferAccessState( RenderPass const & pass
+				, BufferAttachment const & attach )
+			{
+				if ( pass.kind == RenderPass::Kind::Transfer )
+				{
+					return attach.isWrite()
+						? SubresourceState{ VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT }
+						: SubresourceState{ VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+				}
+
+				auto shaderStages = getShaderStages( pass );
+
+				switch ( attach.kind )
+				{
+				case BufferAttachment::Kind::StorageWrite:
+					return { VK_IMAGE_LAYOUT_UNDEFINED
+						, VK_ACCESS_SHADER_WRITE_BIT
+						, shaderStages };
+				case BufferAttachment::Kind::Uniform:
+					return { VK_IMAGE_LAYOUT_UNDEFINED
+						, VK_ACCESS_UNIFORM_READ_BIT
+						, shaderStages };
+				case BufferAttachment::Kind::Indirect:
+					return { VK_IMAGE_LAYOUT_UNDEFINED
+						, VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+						, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT };
+				case BufferAttachment::Kind::Vertex:
+					return { VK_IMAGE_LAYOUT_UNDEFINED
+						, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+						, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT };
+				case BufferAttachment::Kind::Index:
+					return { VK_IMAGE_LAYOUT_UNDEFINED
+						, VK_ACCESS_INDEX_READ_BIT
+						, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT };
+				default:
+					return { VK_IMAGE_LAYOUT_UNDEFINED
+						, VK_ACCESS_SHADER_READ_BIT
+						, shaderStages };
+				}
+			}
+
+			std::vector< ImageAccess > listAccesses( RenderPass const & pass )
+			{
+				std::vector< ImageAccess > result;
+
+				for ( auto & attach : pass.sampled )
+				{
+					result.push_back( { &attach, getSampledState( pass ) } );
+				}
+
+				for ( auto & attach : pass.colourInOuts )
+				{
+					result.push_back( { &attach, getColourState( attach ) } );
+				}
+
+				if ( pass.depthStencilInOut )
+				{
+					result.push_back( { &pass.depthStencilInOut.value(), getDepthStencilState( *pass.depthStencilInOut ) } );
+				}
+
+				for ( auto & attach : pass.storages )
+				{
+					result.push_back( { &attach, getStorageState( pass, attach ) } );
+				}
+
+				for ( auto & attach : pass.transfers )
+				{
+					result.push_back( { &attach, getTransferState( attach ) } );
+				}
+
+				return result;
+			}
+
+			ImageState & getImageState( RenderGraph const & graph
+				, ImageStateMap & states
+				, ImageId image )
+			{
+				auto it = states.find( image );
+
+				if ( it == states.end() )
+				{
+					auto & data = graph.getImage( image );
+					ImageState state;
+					state.mipLevels = std::max( 1u, data.mipLevels );
+					state.arrayLayers = std::max( 1u, data.arrayLayers );
+					state.subresources.resize( state.mipLevels * state.arrayLayers );
+					it = states.emplace( image, std::move( state ) ).first;
+				}
+
+				return it->second;
+			}
+
+			void addBarrier( ImageBarrierArray & barriers
+				, size_t firstBarrier
+				, ImageId image
+				, VkImageAspectFlags aspectMask
+				, uint32_t layer
+				, uint32_t baseMip
+				, uint32_t mipCount
+				, SubresourceState const & oldState
+				, SubresourceState const & newState )
+			{
+				auto srcStages = oldState.stages
+					? oldState.stages
+					: VkPipelineStageFlags( VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT );
+				// Merge with the same mip run on the previous layer, if any.
+				auto it = std::find_if( barriers.begin() + ptrdiff_t( firstBarrier )
+					, barriers.end()
+					, [&]( ImageBarrier const & lookup )
+					{
+						return lookup.subresourceRange.baseMipLevel == baseMip
+							&& lookup.subresourceRange.levelCount == mipCount
+							&& lookup.subresourceRange.baseArrayLayer + lookup.subresourceRange.layerCount == layer
+							&& lookup.oldLayout == oldState.layout
+							&& lookup.srcAccessMask == ( oldState.access & WriteAccessMask )
+							&& lookup.srcStageMask == srcStages;
+					} );
+
+				if ( it != barriers.end() )
+				{
+					++it->subresourceRange.layerCount;
+					return;
+				}
+
+				barriers.push_back( { image
+					, { aspectMask, baseMip, mipCount, layer, 1u }
+					, oldState.layout
+					, newState.layout
+					, oldState.access & WriteAccessMask
+					, newState.access
+					, srcStages
+					, newState.stages } );
+			}
+
+			void processAccess( RenderGraph const & graph
+				, ImageAccess const & access
+				, ImageStateMap & states
+				, ImageBarrierArray * barriers )
+			{
+				auto & viewData = graph.getView( access.attach->view );
+
+				if ( !viewData.image.id )
+				{
+					return;
+				}
+
+				auto & imageState = getImageState( graph, states, viewData.image );
+				auto write = isWrite( access.state.access );
+
+				if ( !imageState.accessed )
+				{
+					imageState.accessed = true;
+					imageState.firstAccessIsRead = !write;
+				}
+
+				auto & range = viewData.subresourceRange;
+				auto endMip = range.levelCount == VK_REMAINING_MIP_LEVELS
+					? imageState.mipLevels
+					: std::min( imageState.mipLevels, range.baseMipLevel + range.levelCount );
+				auto endLayer = range.layerCount == VK_REMAINING_ARRAY_LAYERS
+					? imageState.arrayLayers
+					: std::min( imageState.arrayLayers, range.baseArrayLayer + std::max( 1u, range.layerCount ) );
+				auto aspectMask = range.aspectMask
+					? range.aspectMask
+					: getAspectMask( graph.getImage( viewData.image ).format );
+				auto firstBarrier = barriers ? barriers->size() : 0u;
+
+				for ( auto layer = range.baseArrayLayer; layer < endLayer; ++layer )
+				{
+					// Consecutive mips with the same previous state share a barrier.
+					uint32_t runMip{ range.baseMipLevel };
+					SubresourceState runState{};
+					bool inRun{ false };
+
+					for ( auto mip = range.baseMipLevel; mip < endMip; ++mip )
+					{
+						auto & state = imageState.subresources[layer * imageState.mipLevels + mip];
+						auto needsBarrier = state.layout != access.state.layout
+							|| isWrite( state.access )
+							|| ( write && state.stages );
+
+						if ( inRun
+							&& ( !needsBarrier || state != runState ) )
+						{
+							if ( barriers )
+							{
+								addBarrier( *barriers, firstBarrier, viewData.image, aspectMask, layer, runMip, mip - runMip, runState, access.state );
+							}
+
+							inRun = false;
+						}
+
+						if ( needsBarrier )
+						{
+							if ( !inRun )
+							{
+								inRun = true;
+								runMip = mip;
+								runState = state;
+							}
+
+							state = access.state;
+						}
+						else
+						{
+							state.access |= access.state.access;
+							state.stages |= access.state.stages;
+						}
+					}
+
+					if ( inRun && barriers )
+					{
+						addBarrier( *barriers, firstBarrier, viewData.image, aspectMask, layer, runMip, endMip - runMip, runState, access.state );
+					}
+				}
+			}
+
+			BufferState & getBufferState( RenderGraph const & graph
+				, BufferStateMap & states
+				, BufferId buffer )
+			{
+				auto it = states.find( buffer );
+
+				if ( it == states.end() )
+				{
+					BufferState state;
+					state.segments.push_back( { 0u, graph.getBuffer( buffer ).size, {} } );
+					it = states.emplace( buffer, std::move( state ) ).first;
+				}
+
+				return it->second;
+			}
+
+			void splitSegment( std::vector< BufferSegment > & segments
+				, VkDeviceSize offset )
+			{
+				auto it = std::find_if( segments.begin()
+					, segments.end()
+					, [offset]( BufferSegment const & lookup )
+					{
+						return offset > lookup.offset
+							&& offset < lookup.offset + lookup.size;
+					} );
+
+				if ( it != segments.end() )
+				{
+					BufferSegment next{ offset, it->offset + it->size - offset, it->state };
+					it->size = offset - it->offset;
+					segments.insert( std::next( it ), next );
+				}
+			}
+
+			void mergeSegments( std::vector< BufferSegment > & segments )
+			{
+				auto it = segments.begin();
+
+				while ( it != segments.end()
+					&& std::next( it ) != segments.end() )
+				{
+					auto next = std::next( it );
+
+					if ( next->state == it->state )
+					{
+						it->size += next->size;
+						segments.erase( next );
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
+
+			void processBufferAccess( RenderGraph const & graph
+				, RenderPass const & pass
+				, BufferAttachment const & attach
+				, BufferStateMap & states
+				, BufferBarrierArray * barriers )
+			{
+				if ( !attach.buffer.id )
+				{
+					return;
+				}
+
+				auto & bufferState = getBufferState( graph, states, attach.buffer );
+				auto access = getBufferAccessState( pass, attach );
+				auto write = attach.isWrite();
+
+				if ( !bufferState.accessed )
+				{
+					bufferState.accessed = true;
+					bufferState.firstAccessIsRead = !write;
+				}
+
+				auto size = graph.getBuffer( attach.buffer ).size;
+				auto begin = std::min( attach.offset, size );
+				auto end = std::min( size, begin + getSize( graph, attach ) );
+				auto & segments = bufferState.segments;
+				splitSegment( segments, begin );
+				splitSegment( segments, end );
+				auto firstBarrier = barriers ? barriers->size() : 0u;
+
+				for ( auto & segment : segments )
+				{
+					if ( segment.offset < begin
+						|| segment.offset >= end )
+					{
+						continue;
+					}
+
+					auto & state = segment.state;
+					auto needsBarrier = isWrite( state.access )
+						|| ( write && state.stages );
+
+					if ( !needsBarrier )
+					{
+						state.access |= access.access;
+						state.stages |= access.stages;
+						continue;
+					}
+
+					if ( barriers )
+					{
+						auto srcAccess = state.access & WriteAccessMask;
+
+						// Extend the previous barrier, when the segments are contiguous and share their state.
+						if ( barriers->size() > firstBarrier
+							&& barriers->back().offset + barriers->back().size == segment.offset
+							&& barriers->back().srcAccessMask == srcAccess
+							&& barriers->back().srcStageMask == state.stages )
+						{
+							barriers->back().size += segment.size;
+						}
+						else
+						{
+							barriers->push_back( { attach.buffer
+								, segment.offset
+								, segment.size
+								, srcAccess
+								, access.access
+								, state.stages
+								, access.stages } );
+						}
+					}
+
+					state = access;
+				}
+
+				mergeSegments( segments );
+			}
+
+			void processPasses( RenderGraph const & graph
+				, RenderPassArray const & passes
+				, ResourceStates & states
+				, PassBarriersArray * barriers )
+			{
+				for ( size_t index = 0u; index < passes.size(); ++index )
+				{
+					for ( auto & access : listAccesses( *passes[index] ) )
+					{
+						processAccess( graph
+							, access
+							, states.images
+							, barriers ? &( *barriers )[index].images : nullptr );
+					}
+
+					for ( auto & attach : passes[index]->buffers )
+					{
+						processBufferAccess( graph
+							, *passes[index]
+							, attach
+							, states.buffers
+							, barriers ? &( *barriers )[index].buffers : nullptr );
+					}
+				}
+			}
+
+			ImageState const * findAlias( ImageStateMap const & states
+				, HistoryAliasMap const & historyAliases
+				, ImageId image
+				, uint32_t frameOffset )
+			{
+				for ( auto & alias : historyAliases )
+				{
+					if ( alias.second.image == image
+						&& alias.second.frameOffset == frameOffset )
+					{
+						auto it = states.find( alias.first );
+						return it == states.end()
+							? nullptr
+							: &it->second;
+					}
+				}
+
+				return nullptr;
+			}
+
+			// Retrieves the state of a history image backing, at the end of its last use before the given frame offset.
+			ImageState const * findPreviousUse( ImageStateMap const & states
+				, HistoryAliasMap const & historyAliases
+				, ImageId image
+				, uint32_t frameOffset )
+			{
+				for ( auto offset = frameOffset; offset > 1u; --offset )
+				{
+					if ( auto result = findAlias( states, historyAliases, image, offset - 1u ) )
+					{
+						return result;
+					}
+				}
+
+				auto it = states.find( image );
+				return it == states.end()
+					? nullptr
+					: &it->second;
+			}
+
+			BufferStateMap getInitialStates( RenderGraph const & graph
+				, BufferStateMap const & finalStates )
+			{
+				BufferStateMap result;
+
+				for ( auto & finalState : finalStates )
+				{
+					auto & state = result.emplace( finalState.first, finalState.second ).first->second;
+					state.accessed = false;
+
+					if ( !finalState.second.firstAccessIsRead )
+					{
+						state.segments = { { 0u, graph.getBuffer( finalState.first ).size, {} } };
+					}
+				}
+
+				return result;
+			}
+
+			ImageStateMap getInitialStates( ImageStateMap const & finalStates
+				, HistoryAliasMap const & historyAliases )
+			{
+				ImageStateMap result;
+				uint32_t maxOffset{};
+
+				for ( auto & alias : historyAliases )
+				{
+					maxOffset = std::max( maxOffset, alias.second.frameOffset );
+				}
+
+				for ( auto & finalState : finalStates )
+				{
+					auto & state = result.emplace( finalState.first, finalState.second ).first->second;
+					state.accessed = false;
+					auto aliasIt = historyAliases.find( finalState.first );
+					ImageState const * previous{ &finalState.second };
+
+					if ( aliasIt != historyAliases.end() )
+					{
+						previous = findPreviousUse( finalStates
+							, historyAliases
+							, aliasIt->second.image
+							, aliasIt->second.frameOffset );
+					}
+					else if ( std::any_of( historyAliases.begin()
+						, historyAliases.end()
+						, [&finalState]( HistoryAliasMap::value_type const & lookup )
+						{
+							return lookup.second.image == finalState.first;
+						} ) )
+					{
+						// The current backing of a history image was last used as the oldest history alias.
+						previous = findPreviousUse( finalStates
+							, historyAliases
+							, finalState.first
+							, maxOffset + 1u );
+					}
+					else if ( !finalState.second.firstAccessIsRead )
+					{
+						previous = nullptr;
+					}
+
+					if ( previous )
+					{
+						state.subresources = previous->subresources;
+					}
+					else
+					{
+						std::fill( state.subresources.begin()
+							, state.subresources.end()
+							, SubresourceState{} );
+					}
+				}
+
+				return result;
+			}
+
+			struct HistoryWrite
+			{
+				RenderPass const * pass;
+				Attachment const * attach;
+				VkImageSubresourceRange const * range;
+			};
+		}
+
+		PassBarriersArray buildPassBarriers( RenderGraph const & graph
+			, RenderPassArray const & passes
+			, HistoryAliasMap const & historyAliases )
+		{
+			// First run computes the states at the end of a frame.
+			ResourceStates states;
+			processPasses( graph, passes, states, nullptr );
+			// Second one uses them to initialise the states of the persistent resources.
+			states.images = getInitialStates( states.images, historyAliases );
+			states.buffers = getInitialStates( graph, states.buffers );
+			PassBarriersArray result( passes.size() );
+			processPasses( graph, passes, states, &result );
+			return result;
+		}
+
+		RenderPassDependenciesArray buildHistoryDependencies( RenderGraph const & graph
+			, RenderPassArray const & passes
+			, HistoryAliasMap const & historyAliases )
+		{
+			if ( historyAliases.empty() )
+			{
+				return {};
+			}
+
+			// The writes to the images backing a history one, in passes and accesses order.
+			// The frame offset doesn't change which passes write an image, so they are only indexed by image.
+			std::map< ImageId, std::vector< HistoryWrite > > writes;
+
+			for ( auto & alias : historyAliases )
+			{
+				writes.emplace( alias.second.image, std::vector< HistoryWrite >{} );
+			}
+
+			for ( auto & srcPass : passes )
+			{
+				for ( auto & srcAccess : listAccesses( *srcPass ) )
+				{
+					auto & srcView = graph.getView( srcAccess.attach->view );
+					auto it = writes.find( srcView.image );
+
+					if ( it != writes.end()
+						&& isWrite( srcAccess.state.access ) )
+					{
+						it->second.push_back( { srcPass, srcAccess.attach, &srcView.subresourceRange } );
+					}
+				}
+			}
+
+			RenderPassDependenciesArray result;
+			std::map< std::pair< RenderPass const *, RenderPass const * >, size_t > indices;
+
+			for ( auto & dstPass : passes )
+			{
+				for ( auto & dstAccess : listAccesses( *dstPass ) )
+				{
+					auto & dstView = graph.getView( dstAccess.attach->view );
+					auto aliasIt = historyAliases.find( dstView.image );
+
+					if ( aliasIt == historyAliases.end()
+						|| isWrite( dstAccess.state.access ) )
+					{
+						continue;
+					}
+
+					for ( auto & write : writes.find( aliasIt->second.image )->second )
+					{
+						if ( areIntersecting( *write.range, dstView.subresourceRange ) )
+						{
+							auto ires = indices.emplace( std::make_pair( write.pass, dstPass )
+								, result.size() );
+
+							if ( ires.second )
+							{
+								result.push_back( { write.pass, dstPass } );
+							}
+
+							auto & dependency = result[ires.first->second];
+							dependency.srcOutputs.push_back( *write.attach );
+							dependency.dstInputs.push_back( *dstAccess.attach );
+						}
+					}
+				}
+			}
+
+			return result;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/Barrier.hpp"
+#include "RenderGraph/ImageData.hpp"
+#include "RenderGraph/RenderPassDependencies.hpp"
+
+namespace crg
+{
+	namespace details
+	{
+		/**
+		*\brief
+		*	Builds the barriers needed before each pass of the execution order.
+		*\remarks
+		*	The barriers describe the steady state, where each image has already been used by previous frames.
+		*	Images which are first written in a frame start from an undefined layout.
+		*	Images which are first read in a frame start from their state at the end of the previous frame.
+		*	History aliases start from the state left by the previous use of their backing image.
+		*	Buffers follow the same rules, tracked per byte range.
+		*/
+		PassBarriersArray buildPassBarriers( RenderGraph const & graph
+			, RenderPassArray const & passes
+			, HistoryAliasMap const & historyAliases );
+		/**
+		*\brief
+		*	Lists the passes writing the history images read through history aliases, in a previous frame.
+		*/
+		RenderPassDependenciesArray buildHistoryDependencies( RenderGraph const & graph
+			, RenderPassArray const & passes
+			, HistoryAliasMap const & historyAliases );
+	}
+}
@@ -0,0 +1,65 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/BufferAttachment.hpp"
+
+namespace crg
+{
+	BufferAttachment BufferAttachment::createStorageRead( std::string const & name
+		, BufferId buffer
+		, VkDeviceSize offset
+		, VkDeviceSize range )
+	{
+		return { name, buffer, Kind::StorageRead, offset, range };
+	}
+
+	BufferAttachment BufferAttachment::createStorageWrite( std::string const & name
+		, BufferId buffer
+		, VkDeviceSize offset
+		, VkDeviceSize range )
+	{
+		return { name, buffer, Kind::StorageWrite, offset, range };
+	}
+
+	BufferAttachment BufferAttachment::createUniform( std::string const & name
+		, BufferId buffer
+		, VkDeviceSize offset
+		, VkDeviceSize range )
+	{
+		return { name, buffer, Kind::Uniform, offset, range };
+	}
+
+	BufferAttachment BufferAttachment::createIndirect( std::string const & name
+		, BufferId buffer
+		, VkDeviceSize offset
+		, VkDeviceSize range )
+	{
+		return { name, buffer, Kind::Indirect, offset, range };
+	}
+
+	BufferAttachment BufferAttachment::createVertex( std::string const & name
+		, BufferId buffer
+		, VkDeviceSize offset
+		, VkDeviceSize range )
+	{
+		return { name, buffer, Kind::Vertex, offset, range };
+	}
+
+	BufferAttachment BufferAttachment::createIndex( std::string const & name
+		, BufferId buffer
+		, VkDeviceSize offset
+		, VkDeviceSize range )
+	{
+		return { name, buffer, Kind::Index, offset, range };
+	}
+
+	bool operator==( BufferAttachment const & lhs, BufferAttachment const & rhs )
+	{
+		return lhs.name == rhs.name
+			&& lhs.buffer == rhs.buffer
+			&& lhs.kind == rhs.kind
+			&& lhs.offset == rhs.offset
+			&& lhs.range == rhs.range;
+	}
+}
@@ -0,0 +1,202 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/CompileCache.hpp"
+
+#include "RenderGraph/CompiledGraph.hpp"
+#include "RenderGraph/MappedFile.hpp"
+#include "RenderGraph/RenderGraph.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace crg
+{
+	namespace fs = std::filesystem;
+
+	namespace
+	{
+		static char const * const EntryExtension = ".crg";
+		static char const * const TempExtension = ".tmp";
+		// Temporary files older than this are considered as left by an interrupted write.
+		static auto constexpr TempFileLifetime = std::chrono::hours{ 1 };
+
+		std::string makeTempSuffix( uint32_t index )
+		{
+			// Unique among threads and processes sharing the directory.
+			static uint64_t const processKey = std::random_device{}();
+			std::stringstream stream;
+			stream << "." << std::hex << processKey
+				<< "." << std::hash< std::thread::id >{}( std::this_thread::get_id() )
+				<< "." << index
+				<< TempExtension;
+			return stream.str();
+		}
+
+		struct Entry
+		{
+			fs::path path;
+			uint64_t size;
+			fs::file_time_type time;
+		};
+	}
+
+	CompileCache::CompileCache( std::string directory
+		, uint64_t sizeBudget )
+		: m_directory{ std::move( directory ) }
+		, m_sizeBudget{ sizeBudget }
+	{
+		std::error_code error;
+		fs::create_directories( m_directory, error );
+	}
+
+	bool CompileCache::load( RenderGraph & graph )
+	{
+		auto path = getEntryPath( graph.getGraphHash() );
+		bool result{ false };
+		bool invalid{ false };
+		{
+			MappedFile file{ path };
+
+			if ( file.isOpen() )
+			{
+				result = graph.load( CompiledGraph{ file.getData(), file.getSize() } );
+				invalid = !result;
+			}
+		}
+		std::error_code error;
+
+		if ( result )
+		{
+			++m_stats.hits;
+			fs::last_write_time( path, fs::file_time_type::clock::now(), error );
+		}
+		else
+		{
+			++m_stats.misses;
+
+			if ( invalid )
+			{
+				// Corrupted, or written by another version: it will be replaced.
+				fs::remove( path, error );
+			}
+		}
+
+		return result;
+	}
+
+	bool CompileCache::store( RenderGraph const & graph )
+	{
+		auto data = graph.serialise();
+		auto path = getEntryPath( graph.getGraphHash() );
+		auto tempPath = path + makeTempSuffix( m_tempIndex++ );
+		{
+			std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+			file.write( reinterpret_cast< char const * >( data.data() )
+				, std::streamsize( data.size() ) );
+			file.close();
+
+			if ( !file )
+			{
+				std::error_code error;
+				fs::remove( tempPath, error );
+				return false;
+			}
+		}
+		std::error_code error;
+		fs::rename( tempPath, path, error );
+
+		if ( error )
+		{
+			// Another process may be using the existing entry, which then has the same content.
+			fs::remove( tempPath, error );
+			return false;
+		}
+
+		++m_stats.writes;
+		evict();
+		return true;
+	}
+
+	void CompileCache::evict()
+	{
+		std::vector< Entry > entries;
+		uint64_t totalSize{};
+		auto now = fs::file_time_type::clock::now();
+		std::error_code error;
+
+		for ( auto it = fs::directory_iterator{ m_directory, error }
+			; !error && it != fs::directory_iterator{}
+			; it.increment( error ) )
+		{
+			std::error_code entryError;
+			auto & path = it->path();
+			auto time = fs::last_write_time( path, entryError );
+
+			if ( entryError )
+			{
+				continue;
+			}
+
+			if ( path.extension() == TempExtension )
+			{
+				if ( now - time > TempFileLifetime )
+				{
+					fs::remove( path, entryError );
+				}
+			}
+			else if ( path.extension() == EntryExtension )
+			{
+				auto size = fs::file_size( path, entryError );
+
+				if ( !entryError )
+				{
+					entries.push_back( { path, size, time } );
+					totalSize += size;
+				}
+			}
+		}
+
+		if ( totalSize <= m_sizeBudget )
+		{
+			return;
+		}
+
+		std::sort( entries.begin()
+			, entries.end()
+			, []( Entry const & lhs, Entry const & rhs )
+			{
+				return lhs.time < rhs.time;
+			} );
+
+		// The most recent entry is always kept, even if it exceeds the budget on its own.
+		for ( size_t index = 0u; index + 1u < entries.size() && totalSize > m_sizeBudget; ++index )
+		{
+			std::error_code entryError;
+
+			if ( fs::remove( entries[index].path, entryError ) )
+			{
+				++m_stats.evictions;
+			}
+
+			// Removed here or by another process, it doesn't count anymore.
+			if ( !entryError )
+			{
+				totalSize -= entries[index].size;
+			}
+		}
+	}
+
+	std::string CompileCache::getEntryPath( uint64_t graphHash )const
+	{
+		std::stringstream stream;
+		stream << std::hex << std::setw( 16 ) << std::setfill( '0' ) << graphHash << EntryExtension;
+		return ( fs::path{ m_directory } / stream.str() ).string();
+	}
+}
@@ -0,0 +1,331 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "CompileDivergence.hpp"
+
+#include "RenderGraph/RenderPass.hpp"
+
+#include <queue>
+#include <unordered_set>
+
+namespace crg
+{
+	namespace
+	{
+		using NameArray = std::vector< std::string >;
+
+		std::string getName( RenderPass const * pass )
+		{
+			return pass
+				? pass->name
+				: std::string{ "<none>" };
+		}
+
+		NameArray getNames( std::set< RenderPass const * > const & passes )
+		{
+			NameArray result;
+
+			for ( auto & pass : passes )
+			{
+				result.push_back( pass->name );
+			}
+
+			std::sort( result.begin(), result.end() );
+			return result;
+		}
+
+		NameArray getNames( GraphAdjacentNodeArray const & nodes )
+		{
+			NameArray result;
+
+			for ( auto & node : nodes )
+			{
+				result.push_back( node->getName() );
+			}
+
+			return result;
+		}
+
+		std::string print( NameArray const & names )
+		{
+			std::string result{ "[" };
+			std::string sep;
+
+			for ( auto & name : names )
+			{
+				result += sep + name;
+				sep = ", ";
+			}
+
+			return result + "]";
+		}
+
+		std::string print( Attachment const & attach )
+		{
+			return attach.name + " (view " + std::to_string( attach.view.id ) + ")";
+		}
+
+		std::string print( BufferAttachment const & attach )
+		{
+			return attach.name + " (buffer " + std::to_string( attach.buffer.id ) + ")";
+		}
+
+		std::string diverge( std::string const & what
+			, std::string const & lhs
+			, std::string const & rhs )
+		{
+			return what + ": " + lhs + " != " + rhs;
+		}
+
+		template< typename AttachT >
+		std::string compare( std::string const & what
+			, std::vector< AttachT > const & lhs
+			, std::vector< AttachT > const & rhs )
+		{
+			if ( lhs.size() != rhs.size() )
+			{
+				return diverge( what + ".size", std::to_string( lhs.size() ), std::to_string( rhs.size() ) );
+			}
+
+			for ( size_t index = 0u; index < lhs.size(); ++index )
+			{
+				if ( !( lhs[index] == rhs[index] ) )
+				{
+					return diverge( what + "[" + std::to_string( index ) + "]", print( lhs[index] ), print( rhs[index] ) );
+				}
+			}
+
+			return {};
+		}
+
+		std::string compare( std::string const & what
+			, RenderPassDependencies const & lhs
+			, RenderPassDependencies const & rhs )
+		{
+			if ( getName( lhs.srcPass ) != getName( rhs.srcPass ) )
+			{
+				return diverge( what + ".srcPass", getName( lhs.srcPass ), getName( rhs.srcPass ) );
+			}
+
+			if ( getName( lhs.dstPass ) != getName( rhs.dstPass ) )
+			{
+				return diverge( what + ".dstPass", getName( lhs.dstPass ), getName( rhs.dstPass ) );
+			}
+
+			auto result = compare( what + ".srcOutputs", lhs.srcOutputs, rhs.srcOutputs );
+
+			if ( result.empty() )
+			{
+				result = compare( what + ".dstInputs", lhs.dstInputs, rhs.dstInputs );
+			}
+
+			if ( result.empty() )
+			{
+				result = compare( what + ".srcBufferOutputs", lhs.srcBufferOutputs, rhs.srcBufferOutputs );
+			}
+
+			if ( result.empty() )
+			{
+				result = compare( what + ".dstBufferInputs", lhs.dstBufferInputs, rhs.dstBufferInputs );
+			}
+
+			return result;
+		}
+
+		std::string compare( std::string const & what
+			, AttachmentPasses const & lhs
+			, AttachmentPasses const & rhs )
+		{
+			if ( !( lhs.attachment == rhs.attachment ) )
+			{
+				return diverge( what + ".attachment", print( lhs.attachment ), print( rhs.attachment ) );
+			}
+
+			auto lhsPasses = getNames( lhs.passes );
+			auto rhsPasses = getNames( rhs.passes );
+
+			if ( lhsPasses != rhsPasses )
+			{
+				return diverge( what + ".passes", print( lhsPasses ), print( rhsPasses ) );
+			}
+
+			return {};
+		}
+
+		std::string compare( std::string const & what
+			, AttachmentTransition const & lhs
+			, AttachmentTransition const & rhs )
+		{
+			if ( lhs.srcOutputs.size() != rhs.srcOutputs.size() )
+			{
+				return diverge( what + ".srcOutputs.size"
+					, std::to_string( lhs.srcOutputs.size() )
+					, std::to_string( rhs.srcOutputs.size() ) );
+			}
+
+			for ( size_t index = 0u; index < lhs.srcOutputs.size(); ++index )
+			{
+				auto result = compare( what + ".srcOutputs[" + std::to_string( index ) + "]"
+					, lhs.srcOutputs[index]
+					, rhs.srcOutputs[index] );
+
+				if ( !result.empty() )
+				{
+					return result;
+				}
+			}
+
+			return compare( what + ".dstInput", lhs.dstInput, rhs.dstInput );
+		}
+
+		template< typename ValueT >
+		std::string compareAll( std::string const & what
+			, std::vector< ValueT > const & lhs
+			, std::vector< ValueT > const & rhs )
+		{
+			if ( lhs.size() != rhs.size() )
+			{
+				return diverge( what + ".size", std::to_string( lhs.size() ), std::to_string( rhs.size() ) );
+			}
+
+			for ( size_t index = 0u; index < lhs.size(); ++index )
+			{
+				auto result = compare( what + "[" + std::to_string( index ) + "]"
+					, lhs[index]
+					, rhs[index] );
+
+				if ( !result.empty() )
+				{
+					return result;
+				}
+			}
+
+			return {};
+		}
+
+		std::string compare( ConstGraphAdjacentNode lhs
+			, ConstGraphAdjacentNode rhs )
+		{
+			auto what = "node " + lhs->getName();
+
+			if ( lhs->getName() != rhs->getName() )
+			{
+				return diverge( what + ".name", lhs->getName(), rhs->getName() );
+			}
+
+			auto lhsNext = getNames( lhs->getNext() );
+			auto rhsNext = getNames( rhs->getNext() );
+
+			if ( lhsNext != rhsNext )
+			{
+				return diverge( what + ".next", print( lhsNext ), print( rhsNext ) );
+			}
+
+			// The previous nodes are keyed by address, so they are compared by name.
+			std::map< std::string, AttachmentTransitionArray const * > lhsPrev;
+			std::map< std::string, AttachmentTransitionArray const * > rhsPrev;
+
+			for ( auto & prev : lhs->getAllAttachsToPrev() )
+			{
+				lhsPrev.emplace( prev.first->getName(), &prev.second );
+			}
+
+			for ( auto & prev : rhs->getAllAttachsToPrev() )
+			{
+				rhsPrev.emplace( prev.first->getName(), &prev.second );
+			}
+
+			auto rhsIt = rhsPrev.begin();
+
+			for ( auto & prev : lhsPrev )
+			{
+				if ( rhsIt == rhsPrev.end()
+					|| rhsIt->first != prev.first )
+				{
+					return diverge( what + ".prev"
+						, prev.first
+						, ( rhsIt == rhsPrev.end() ? std::string{ "<none>" } : rhsIt->first ) );
+				}
+
+				auto result = compareAll( what + ".attachsToPrev[" + prev.first + "]"
+					, *prev.second
+					, *rhsIt->second );
+
+				if ( !result.empty() )
+				{
+					return result;
+				}
+
+				++rhsIt;
+			}
+
+			if ( rhsIt != rhsPrev.end() )
+			{
+				return diverge( what + ".prev", "<none>", rhsIt->first );
+			}
+
+			return {};
+		}
+
+		std::string compareNodes( ConstGraphAdjacentNode lhsRoot
+			, ConstGraphAdjacentNode rhsRoot )
+		{
+			// Both graphs are traversed breadth first, in their next nodes order, which has already been compared.
+			std::queue< std::pair< ConstGraphAdjacentNode, ConstGraphAdjacentNode > > nodes;
+			std::unordered_set< ConstGraphAdjacentNode > visited;
+			nodes.emplace( lhsRoot, rhsRoot );
+			visited.insert( lhsRoot );
+
+			while ( !nodes.empty() )
+			{
+				auto current = nodes.front();
+				nodes.pop();
+				auto result = compare( current.first, current.second );
+
+				if ( !result.empty() )
+				{
+					return result;
+				}
+
+				auto & lhsNext = current.first->getNext();
+				auto & rhsNext = current.second->getNext();
+
+				for ( size_t index = 0u; index < lhsNext.size(); ++index )
+				{
+					if ( visited.insert( lhsNext[index] ).second )
+					{
+						nodes.emplace( lhsNext[index], rhsNext[index] );
+					}
+				}
+			}
+
+			return {};
+		}
+	}
+
+	namespace details
+	{
+		std::string findDivergence( CompiledState const & lhs
+			, CompiledState const & rhs )
+		{
+			auto result = compareAll( "dependencies"
+				, lhs.dependencies
+				, rhs.dependencies );
+
+			if ( result.empty() )
+			{
+				result = compareNodes( &lhs.root, &rhs.root );
+			}
+
+			if ( result.empty() )
+			{
+				result = compareAll( "transitions"
+					, lhs.transitions
+					, rhs.transitions );
+			}
+
+			return result;
+		}
+	}
+}
@@ -0,0 +1,34 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/GraphNode.hpp"
+
+namespace crg
+{
+	namespace details
+	{
+		/**
+		*\brief
+		*	The compiled data compared by findDivergence().
+		*/
+		struct CompiledState
+		{
+			RenderPassDependenciesArray const & dependencies;
+			GraphNode const & root;
+			AttachmentTransitionArray const & transitions;
+		};
+		/**
+		*\brief
+		*	Compares the dependencies, the graph nodes (reached from the root) and the transitions, in that order.
+		*\remarks
+		*	Both states must have been compiled from the same passes.
+		*\return
+		*	A description of the first divergence, empty if the states match.
+		*/
+		std::string findDivergence( CompiledState const & lhs
+			, CompiledState const & rhs );
+	}
+}
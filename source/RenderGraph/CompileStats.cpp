@@ -0,0 +1,47 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/CompileStats.hpp"
+
+namespace crg
+{
+	char const * getName( CompilePhase phase )
+	{
+		switch ( phase )
+		{
+		case CompilePhase::CacheLoad:
+			return "cacheLoad";
+		case CompilePhase::BuildPassDependencies:
+			return "buildPassDependencies";
+		case CompilePhase::FindCycles:
+			return "findCycles";
+		case CompilePhase::RetrieveRoots:
+			return "retrieveRoots";
+		case CompilePhase::RetrieveLeafs:
+			return "retrieveLeafs";
+		case CompilePhase::BuildGraphNodes:
+			return "buildGraphNodes";
+		case CompilePhase::MergeIdenticalTransitions:
+			return "mergeIdenticalTransitions";
+		case CompilePhase::MergeTransitionsPerInput:
+			return "mergeTransitionsPerInput";
+		case CompilePhase::ReduceDirectPaths:
+			return "reduceDirectPaths";
+		case CompilePhase::SortPasses:
+			return "sortPasses";
+		case CompilePhase::BuildReachability:
+			return "buildReachability";
+		case CompilePhase::SignPasses:
+			return "signPasses";
+		case CompilePhase::BuildPassBarriers:
+			return "buildPassBarriers";
+		case CompilePhase::BuildHistoryDependencies:
+			return "buildHistoryDependencies";
+		case CompilePhase::CacheStore:
+			return "cacheStore";
+		default:
+			return "unknown";
+		}
+	}
+}
@@ -0,0 +1,132 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/CompiledGraph.hpp"
+
+#include "Hash.hpp"
+
+namespace crg
+{
+	namespace binary
+	{
+		// The records must not hold implicit padding, which content wouldn't be deterministic.
+		static_assert( sizeof( Section ) == 16u );
+		static_assert( sizeof( String ) == 8u );
+		static_assert( sizeof( Image ) == 48u );
+		static_assert( sizeof( View ) == 40u );
+		static_assert( sizeof( Buffer ) == 24u );
+		static_assert( sizeof( Pass ) == 40u );
+		static_assert( sizeof( Attachment ) == 32u );
+		static_assert( sizeof( BufferAttachment ) == 32u );
+		static_assert( sizeof( AttachmentPasses ) == 12u );
+		static_assert( sizeof( Transition ) == 12u );
+		static_assert( sizeof( Dependency ) == 24u );
+		static_assert( sizeof( Edge ) == 16u );
+		static_assert( sizeof( ImageBarrier ) == 48u );
+		static_assert( sizeof( BufferBarrier ) == 40u );
+		static_assert( sizeof( Header ) == 40u + 16u * size_t( SectionKind::Count ) );
+	}
+
+	namespace
+	{
+		uint32_t getStride( binary::SectionKind kind )
+		{
+			switch ( kind )
+			{
+			case binary::SectionKind::Strings:
+				return uint32_t( sizeof( char ) );
+			case binary::SectionKind::Images:
+				return uint32_t( sizeof( binary::Image ) );
+			case binary::SectionKind::Views:
+				return uint32_t( sizeof( binary::View ) );
+			case binary::SectionKind::Buffers:
+				return uint32_t( sizeof( binary::Buffer ) );
+			case binary::SectionKind::Passes:
+				return uint32_t( sizeof( binary::Pass ) );
+			case binary::SectionKind::PassIndices:
+			case binary::SectionKind::Nodes:
+				return uint32_t( sizeof( uint32_t ) );
+			case binary::SectionKind::Attachments:
+				return uint32_t( sizeof( binary::Attachment ) );
+			case binary::SectionKind::BufferAttachments:
+				return uint32_t( sizeof( binary::BufferAttachment ) );
+			case binary::SectionKind::AttachmentPasses:
+				return uint32_t( sizeof( binary::AttachmentPasses ) );
+			case binary::SectionKind::Transitions:
+				return uint32_t( sizeof( binary::Transition ) );
+			case binary::SectionKind::Dependencies:
+			case binary::SectionKind::HistoryDependencies:
+				return uint32_t( sizeof( binary::Dependency ) );
+			case binary::SectionKind::Edges:
+				return uint32_t( sizeof( binary::Edge ) );
+			case binary::SectionKind::ImageBarriers:
+				return uint32_t( sizeof( binary::ImageBarrier ) );
+			case binary::SectionKind::BufferBarriers:
+				return uint32_t( sizeof( binary::BufferBarrier ) );
+			default:
+				return 0u;
+			}
+		}
+
+		bool isValidSection( binary::Section const & section
+			, binary::SectionKind kind
+			, size_t size )
+		{
+			return section.stride == getStride( kind )
+				&& section.offset % 8u == 0u
+				&& section.offset >= sizeof( binary::Header )
+				&& section.offset <= size
+				&& uint64_t( section.count ) * section.stride <= size - section.offset;
+		}
+
+		binary::Header const * validate( uint8_t const * data
+			, size_t size )
+		{
+			if ( !data
+				|| size < sizeof( binary::Header )
+				|| reinterpret_cast< uintptr_t >( data ) % alignof( binary::Header ) != 0u )
+			{
+				return nullptr;
+			}
+
+			auto header = reinterpret_cast< binary::Header const * >( data );
+
+			if ( header->magic != binary::Magic
+				|| header->version != binary::Version
+				|| header->endianness != binary::Endianness
+				|| header->sectionCount != uint32_t( binary::SectionKind::Count )
+				|| header->size != size )
+			{
+				return nullptr;
+			}
+
+			for ( uint32_t index = 0u; index < header->sectionCount; ++index )
+			{
+				if ( !isValidSection( header->sections[index]
+					, binary::SectionKind( index )
+					, size ) )
+				{
+					return nullptr;
+				}
+			}
+
+			details::StableHash hash;
+			hash.add( data + sizeof( binary::Header ), size - sizeof( binary::Header ) );
+
+			if ( hash.getValue() != header->contentHash )
+			{
+				return nullptr;
+			}
+
+			return header;
+		}
+	}
+
+	CompiledGraph::CompiledGraph( void const * data
+		, size_t size )
+		: m_data{ static_cast< uint8_t const * >( data ) }
+		, m_header{ validate( m_data, size ) }
+	{
+	}
+}
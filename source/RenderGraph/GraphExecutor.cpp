@@ -0,0 +1,143 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/GraphExecutor.hpp"
+
+#include "RenderGraph/RenderGraph.hpp"
+#include "RenderGraph/ThreadPool.hpp"
+
+namespace crg
+{
+	GraphExecutor::GraphExecutor( RenderGraph const & graph
+		, ThreadPool & pool )
+		: GraphExecutor{ graph
+			, [&pool]( uint32_t count, std::function< void( uint32_t, uint32_t ) > const & job )
+			{
+				pool.parallelFor( count, job );
+			} }
+	{
+	}
+
+	GraphExecutor::GraphExecutor( RenderGraph const & graph
+		, JobSystem jobSystem )
+		: m_graph{ graph }
+		, m_jobSystem{ std::move( jobSystem ) }
+		, m_recordJob{ [this]( uint32_t index, uint32_t thread )
+			{
+				doRecord( index, thread );
+			} }
+	{
+	}
+
+	void GraphExecutor::run( RecordFunc const & record
+		, StitchFunc const & stitch )
+	{
+		doUpdateEntries();
+		auto & order = m_graph.getExecutionOrder();
+		auto & signatures = m_graph.getPassSignatures();
+		m_dirty.clear();
+
+		for ( uint32_t index = 0u; index < order.size(); ++index )
+		{
+			auto & entry = *m_entries[index];
+
+			if ( !entry.cacheable )
+			{
+				m_dirty.push_back( index );
+			}
+			else if ( entry.recorded
+				&& entry.recordedVersion == entry.version
+				&& entry.recordedSignature == signatures[index]
+				&& entry.recordedIndex == index )
+			{
+				++m_cacheStats.hits;
+			}
+			else
+			{
+				++m_cacheStats.misses;
+				m_dirty.push_back( index );
+			}
+		}
+
+		m_record = &record;
+		m_jobSystem( uint32_t( m_dirty.size() ), m_recordJob );
+		m_record = nullptr;
+
+		for ( auto index : m_dirty )
+		{
+			auto & entry = *m_entries[index];
+			entry.recorded = true;
+			entry.recordedVersion = entry.version;
+			entry.recordedSignature = signatures[index];
+			entry.recordedIndex = index;
+		}
+
+		uint32_t index{};
+
+		for ( auto & pass : order )
+		{
+			stitch( *pass, index );
+			++index;
+		}
+	}
+
+	void GraphExecutor::setCacheable( std::string const & passName
+		, uint64_t version )
+	{
+		auto & entry = m_cache[passName];
+		entry.cacheable = true;
+		entry.version = version;
+	}
+
+	void GraphExecutor::setUncacheable( std::string const & passName )
+	{
+		auto it = m_cache.find( passName );
+
+		if ( it != m_cache.end() )
+		{
+			it->second.cacheable = false;
+			it->second.recorded = false;
+		}
+	}
+
+	void GraphExecutor::doUpdateEntries()
+	{
+		auto & order = m_graph.getExecutionOrder();
+
+		if ( m_compileCount == m_graph.getCompileCount()
+			&& m_entries.size() == order.size() )
+		{
+			return;
+		}
+
+		m_compileCount = m_graph.getCompileCount();
+		m_entries.clear();
+		m_entries.reserve( order.size() );
+		m_dirty.reserve( order.size() );
+		m_recordTimes.assign( order.size(), std::chrono::nanoseconds{} );
+
+		for ( auto & pass : order )
+		{
+			m_entries.push_back( &m_cache[pass->name] );
+		}
+	}
+
+	void GraphExecutor::doRecord( uint32_t index
+		, uint32_t thread )
+	{
+		index = m_dirty[index];
+		auto & order = m_graph.getExecutionOrder();
+
+		if ( m_recordTimesEnabled )
+		{
+			auto begin = std::chrono::steady_clock::now();
+			( *m_record )( *order[index], index, thread );
+			m_recordTimes[index] = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - begin );
+		}
+		else
+		{
+			( *m_record )( *order[index], index, thread );
+		}
+	}
+}
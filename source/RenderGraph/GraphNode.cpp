@@ -16,9 +16,11 @@ namespace crg
 	}
 
 	GraphNode::GraphNode( Kind kind
+		, uint32_t index
 		, std::string name
 		, AttachmentsNodeMap attachments )
 		: kind{ kind }
+		, index{ index }
 		, name{ std::move( name ) }
 		, next{}
 		, attachsToPrev{ std::move( attachments ) }
@@ -85,8 +87,9 @@ namespace crg
 
 	//*********************************************************************************************
 
-	RenderPassNode::RenderPassNode( RenderPass const & pass )
-		: GraphNode{ MyKind, pass.name, {} }
+	RenderPassNode::RenderPassNode( RenderPass const & pass
+		, uint32_t index )
+		: GraphNode{ MyKind, index, pass.name, {} }
 		, pass{ &pass }
 	{
 	}
@@ -99,7 +102,7 @@ namespace crg
 	//*********************************************************************************************
 
 	RootNode::RootNode( std::string name )
-		: GraphNode{ MyKind, std::move( name ), {} }
+		: GraphNode{ MyKind, 0u, std::move( name ), {} }
 	{
 	}
 
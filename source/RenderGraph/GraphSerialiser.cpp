@@ -0,0 +1,911 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/RenderGraph.hpp"
+
+#include "Hash.hpp"
+#include "PassComponents.hpp"
+
+#include "RenderGraph/BufferAttachment.hpp"
+#include "RenderGraph/CompiledGraph.hpp"
+#include "RenderGraph/Exception.hpp"
+
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+namespace crg
+{
+	namespace
+	{
+		void addHash( details::StableHash & hash
+			, Attachment const & attach )
+		{
+			hash.add( attach.name );
+			hash.add( attach.view.id );
+			hash.add( attach.kind );
+			hash.add( attach.loadOp );
+			hash.add( attach.storeOp );
+			hash.add( attach.stencilLoadOp );
+			hash.add( attach.stencilStoreOp );
+		}
+
+		void addHash( details::StableHash & hash
+			, AttachmentArray const & attachs )
+		{
+			hash.add( uint32_t( attachs.size() ) );
+
+			for ( auto & attach : attachs )
+			{
+				addHash( hash, attach );
+			}
+		}
+
+		void addHash( details::StableHash & hash
+			, BufferAttachment const & attach )
+		{
+			hash.add( attach.name );
+			hash.add( attach.buffer.id );
+			hash.add( attach.kind );
+			hash.add( attach.offset );
+			hash.add( attach.range );
+		}
+
+		void addHash( details::StableHash & hash
+			, RenderPass const & pass )
+		{
+			hash.add( pass.name );
+			hash.add( pass.kind );
+			addHash( hash, pass.sampled );
+			addHash( hash, pass.colourInOuts );
+			hash.add( bool( pass.depthStencilInOut ) );
+
+			if ( pass.depthStencilInOut )
+			{
+				addHash( hash, *pass.depthStencilInOut );
+			}
+
+			addHash( hash, pass.storages );
+			addHash( hash, pass.transfers );
+			hash.add( uint32_t( pass.buffers.size() ) );
+
+			for ( auto & attach : pass.buffers )
+			{
+				addHash( hash, attach );
+			}
+		}
+
+		void addHash( details::StableHash & hash
+			, ImageData const & data )
+		{
+			hash.add( data.flags );
+			hash.add( data.imageType );
+			hash.add( data.format );
+			hash.add( data.extent.width );
+			hash.add( data.extent.height );
+			hash.add( data.mipLevels );
+			hash.add( data.arrayLayers );
+			hash.add( data.samples );
+			hash.add( data.tiling );
+			hash.add( data.usage );
+		}
+
+		void addHash( details::StableHash & hash
+			, ImageViewData const & data )
+		{
+			hash.add( data.image.id );
+			hash.add( data.flags );
+			hash.add( data.viewType );
+			hash.add( data.format );
+			hash.add( data.subresourceRange.aspectMask );
+			hash.add( data.subresourceRange.baseMipLevel );
+			hash.add( data.subresourceRange.levelCount );
+			hash.add( data.subresourceRange.baseArrayLayer );
+			hash.add( data.subresourceRange.layerCount );
+		}
+
+		void addHash( details::StableHash & hash
+			, BufferData const & data )
+		{
+			hash.add( data.flags );
+			hash.add( data.size );
+			hash.add( data.usage );
+		}
+
+		//*****************************************************************************************
+
+		class Writer
+		{
+		public:
+			explicit Writer( RenderPassArray const & passes )
+			{
+				for ( auto & pass : passes )
+				{
+					m_passIndices.emplace( pass, uint32_t( m_passIndices.size() ) );
+				}
+			}
+
+			binary::String addString( std::string const & value )
+			{
+				binary::String result{ uint32_t( strings.size() ), uint32_t( value.size() ) };
+				strings.insert( strings.end(), value.begin(), value.end() );
+				return result;
+			}
+
+			uint32_t getPassIndex( RenderPass const * pass )const
+			{
+				return m_passIndices.at( pass );
+			}
+
+			uint32_t addAttachment( Attachment const & attach )
+			{
+				binary::Attachment result{};
+				result.name = addString( attach.name );
+				result.view = attach.view.id;
+				result.kind = uint32_t( attach.kind );
+				result.loadOp = uint32_t( attach.loadOp );
+				result.storeOp = uint32_t( attach.storeOp );
+				result.stencilLoadOp = uint32_t( attach.stencilLoadOp );
+				result.stencilStoreOp = uint32_t( attach.stencilStoreOp );
+				attachments.push_back( result );
+				return uint32_t( attachments.size() - 1u );
+			}
+
+			uint32_t addBufferAttachment( BufferAttachment const & attach )
+			{
+				binary::BufferAttachment result{};
+				result.name = addString( attach.name );
+				result.buffer = attach.buffer.id;
+				result.kind = uint32_t( attach.kind );
+				result.offset = attach.offset;
+				result.range = attach.range;
+				bufferAttachments.push_back( result );
+				return uint32_t( bufferAttachments.size() - 1u );
+			}
+
+			uint32_t addAttachmentPasses( AttachmentPasses const & attach )
+			{
+				binary::AttachmentPasses result{};
+				result.attachment = addAttachment( attach.attachment );
+				result.passBegin = uint32_t( passIndices.size() );
+				result.passCount = uint32_t( attach.passes.size() );
+
+				// The set is sorted by address, so the passes are sorted by index, to keep the output deterministic.
+				for ( auto & pass : attach.passes )
+				{
+					passIndices.push_back( getPassIndex( pass ) );
+				}
+
+				std::sort( passIndices.begin() + result.passBegin, passIndices.end() );
+				attachmentPasses.push_back( result );
+				return uint32_t( attachmentPasses.size() - 1u );
+			}
+
+			void addTransition( AttachmentTransition const & transition )
+			{
+				binary::Transition result{};
+				result.srcOutputBegin = uint32_t( attachmentPasses.size() );
+				result.srcOutputCount = uint32_t( transition.srcOutputs.size() );
+
+				for ( auto & srcOutput : transition.srcOutputs )
+				{
+					addAttachmentPasses( srcOutput );
+				}
+
+				result.dstInput = addAttachmentPasses( transition.dstInput );
+				transitions.push_back( result );
+			}
+
+			void addDependency( RenderPassDependencies const & dependency
+				, std::vector< binary::Dependency > & dependencies )
+			{
+				binary::Dependency result{};
+				result.srcPass = getPassIndex( dependency.srcPass );
+				result.dstPass = getPassIndex( dependency.dstPass );
+				result.attachmentBegin = uint32_t( attachments.size() );
+				result.attachmentCount = uint32_t( dependency.srcOutputs.size() );
+				result.bufferBegin = uint32_t( bufferAttachments.size() );
+				result.bufferCount = uint32_t( dependency.srcBufferOutputs.size() );
+
+				for ( auto & attach : dependency.srcOutputs )
+				{
+					addAttachment( attach );
+				}
+
+				for ( auto & attach : dependency.dstInputs )
+				{
+					addAttachment( attach );
+				}
+
+				for ( auto & attach : dependency.srcBufferOutputs )
+				{
+					addBufferAttachment( attach );
+				}
+
+				for ( auto & attach : dependency.dstBufferInputs )
+				{
+					addBufferAttachment( attach );
+				}
+
+				dependencies.push_back( result );
+			}
+
+			std::vector< uint8_t > finish( uint64_t graphHash )
+			{
+				binary::Header header{};
+				header.magic = binary::Magic;
+				header.version = binary::Version;
+				header.endianness = binary::Endianness;
+				header.sectionCount = uint32_t( binary::SectionKind::Count );
+				header.graphHash = graphHash;
+				std::vector< uint8_t > result( sizeof( binary::Header ) );
+				addSection( header, binary::SectionKind::Strings, strings, result );
+				addSection( header, binary::SectionKind::Images, images, result );
+				addSection( header, binary::SectionKind::Views, views, result );
+				addSection( header, binary::SectionKind::Buffers, buffers, result );
+				addSection( header, binary::SectionKind::Passes, passes, result );
+				addSection( header, binary::SectionKind::PassIndices, passIndices, result );
+				addSection( header, binary::SectionKind::Attachments, attachments, result );
+				addSection( header, binary::SectionKind::BufferAttachments, bufferAttachments, result );
+				addSection( header, binary::SectionKind::AttachmentPasses, attachmentPasses, result );
+				addSection( header, binary::SectionKind::Transitions, transitions, result );
+				addSection( header, binary::SectionKind::Dependencies, dependencies, result );
+				addSection( header, binary::SectionKind::HistoryDependencies, historyDependencies, result );
+				addSection( header, binary::SectionKind::Nodes, nodes, result );
+				addSection( header, binary::SectionKind::Edges, edges, result );
+				addSection( header, binary::SectionKind::ImageBarriers, imageBarriers, result );
+				addSection( header, binary::SectionKind::BufferBarriers, bufferBarriers, result );
+				header.size = result.size();
+				details::StableHash hash;
+				hash.add( result.data() + sizeof( binary::Header ), result.size() - sizeof( binary::Header ) );
+				header.contentHash = hash.getValue();
+				std::memcpy( result.data(), &header, sizeof( binary::Header ) );
+				return result;
+			}
+
+			std::vector< char > strings;
+			std::vector< binary::Image > images;
+			std::vector< binary::View > views;
+			std::vector< binary::Buffer > buffers;
+			std::vector< binary::Pass > passes;
+			std::vector< uint32_t > passIndices;
+			std::vector< binary::Attachment > attachments;
+			std::vector< binary::BufferAttachment > bufferAttachments;
+			std::vector< binary::AttachmentPasses > attachmentPasses;
+			std::vector< binary::Transition > transitions;
+			std::vector< binary::Dependency > dependencies;
+			std::vector< binary::Dependency > historyDependencies;
+			std::vector< uint32_t > nodes;
+			std::vector< binary::Edge > edges;
+			std::vector< binary::ImageBarrier > imageBarriers;
+			std::vector< binary::BufferBarrier > bufferBarriers;
+
+		private:
+			template< typename TypeT >
+			static void addSection( binary::Header & header
+				, binary::SectionKind kind
+				, std::vector< TypeT > const & records
+				, std::vector< uint8_t > & result )
+			{
+				// Sections are 8 bytes aligned, the gaps are zero filled.
+				auto offset = ( result.size() + 7u ) & ~size_t( 7u );
+				auto size = records.size() * sizeof( TypeT );
+				result.resize( offset + size, 0u );
+
+				if ( size )
+				{
+					std::memcpy( result.data() + offset, records.data(), size );
+				}
+
+				auto & section = header.sections[size_t( kind )];
+				section.offset = offset;
+				section.count = uint32_t( records.size() );
+				section.stride = uint32_t( sizeof( TypeT ) );
+			}
+
+		private:
+			std::unordered_map< RenderPass const *, uint32_t > m_passIndices;
+		};
+
+		//*****************************************************************************************
+
+		/**
+		*\brief
+		*	Reads the compiled data back, checking each string, index and handle against the graph.
+		*\remarks
+		*	Doesn't throw: a corrupted value marks the reader as invalid, and is read as a default value.
+		*/
+		class Reader
+		{
+		public:
+			Reader( CompiledGraph const & compiled
+				, RenderPassArray const & passes
+				, SlotMap< ImageData > const & images
+				, SlotMap< ImageViewData > const & views
+				, SlotMap< BufferData > const & buffers )
+				: m_compiled{ compiled }
+				, m_passes{ passes }
+				, m_images{ images }
+				, m_views{ views }
+				, m_buffers{ buffers }
+			{
+			}
+
+			inline bool isValid()const
+			{
+				return m_valid;
+			}
+
+			template< typename TypeT >
+			TypeT const & get( binary::SectionKind kind
+				, uint32_t index )const
+			{
+				static TypeT const dummy{};
+				auto section = m_compiled.getSection< TypeT >( kind );
+
+				if ( index >= section.size() )
+				{
+					m_valid = false;
+					return dummy;
+				}
+
+				return section[index];
+			}
+			/**
+			*\return
+			*	true if the count records starting at begin lie in the section.
+			*/
+			template< typename TypeT >
+			bool checkRange( binary::SectionKind kind
+				, uint32_t begin
+				, uint64_t count )const
+			{
+				if ( begin + count > m_compiled.getSection< TypeT >( kind ).size() )
+				{
+					m_valid = false;
+				}
+
+				return m_valid;
+			}
+
+			std::string getString( binary::String const & value )const
+			{
+				if ( !m_compiled.isValid( value ) )
+				{
+					m_valid = false;
+					return {};
+				}
+
+				return std::string{ m_compiled.getString( value ) };
+			}
+
+			RenderPass const * getPass( uint32_t index )const
+			{
+				if ( index >= m_passes.size() )
+				{
+					m_valid = false;
+					return nullptr;
+				}
+
+				return m_passes[index];
+			}
+
+			template< typename DataT >
+			Id< DataT > getId( SlotMap< DataT > const & ids
+				, uint32_t id )const
+			{
+				auto result = ids.getHandle( id );
+
+				if ( !result.id )
+				{
+					m_valid = false;
+				}
+
+				return result;
+			}
+
+			ImageId getImage( uint32_t id )const
+			{
+				return getId( m_images, id );
+			}
+
+			ImageViewId getView( uint32_t id )const
+			{
+				return getId( m_views, id );
+			}
+
+			BufferId getBuffer( uint32_t id )const
+			{
+				return getId( m_buffers, id );
+			}
+
+			Attachment getAttachment( uint32_t index )const
+			{
+				auto & attach = get< binary::Attachment >( binary::SectionKind::Attachments, index );
+				return Attachment{ getString( attach.name )
+					, getView( attach.view )
+					, Attachment::Kind( attach.kind )
+					, VkAttachmentLoadOp( attach.loadOp )
+					, VkAttachmentStoreOp( attach.storeOp )
+					, VkAttachmentLoadOp( attach.stencilLoadOp )
+					, VkAttachmentStoreOp( attach.stencilStoreOp ) };
+			}
+
+			BufferAttachment getBufferAttachment( uint32_t index )const
+			{
+				auto & attach = get< binary::BufferAttachment >( binary::SectionKind::BufferAttachments, index );
+				return BufferAttachment{ getString( attach.name )
+					, getBuffer( attach.buffer )
+					, BufferAttachment::Kind( attach.kind )
+					, attach.offset
+					, attach.range };
+			}
+
+			AttachmentPasses getAttachmentPasses( uint32_t index )const
+			{
+				auto & attach = get< binary::AttachmentPasses >( binary::SectionKind::AttachmentPasses, index );
+				AttachmentPasses result{ getAttachment( attach.attachment ), {} };
+
+				if ( !checkRange< uint32_t >( binary::SectionKind::PassIndices, attach.passBegin, attach.passCount ) )
+				{
+					return result;
+				}
+
+				for ( uint32_t pass = 0u; pass < attach.passCount; ++pass )
+				{
+					result.passes.insert( getPass( get< uint32_t >( binary::SectionKind::PassIndices, attach.passBegin + pass ) ) );
+				}
+
+				return result;
+			}
+
+			AttachmentTransition getTransition( uint32_t index )const
+			{
+				auto & transition = get< binary::Transition >( binary::SectionKind::Transitions, index );
+				AttachmentTransition result{ {}, getAttachmentPasses( transition.dstInput ) };
+
+				if ( !checkRange< binary::AttachmentPasses >( binary::SectionKind::AttachmentPasses, transition.srcOutputBegin, transition.srcOutputCount ) )
+				{
+					return result;
+				}
+
+				for ( uint32_t output = 0u; output < transition.srcOutputCount; ++output )
+				{
+					result.srcOutputs.push_back( getAttachmentPasses( transition.srcOutputBegin + output ) );
+				}
+
+				return result;
+			}
+
+			AttachmentTransitionArray getTransitions( uint32_t begin
+				, uint32_t count )const
+			{
+				AttachmentTransitionArray result;
+
+				if ( !checkRange< binary::Transition >( binary::SectionKind::Transitions, begin, count ) )
+				{
+					return result;
+				}
+
+				for ( uint32_t index = 0u; index < count && m_valid; ++index )
+				{
+					result.push_back( getTransition( begin + index ) );
+				}
+
+				return result;
+			}
+
+			RenderPassDependenciesArray getDependencies( binary::SectionKind kind )const
+			{
+				RenderPassDependenciesArray result;
+
+				for ( auto & dependency : m_compiled.getSection< binary::Dependency >( kind ) )
+				{
+					if ( !checkRange< binary::Attachment >( binary::SectionKind::Attachments, dependency.attachmentBegin, 2u * uint64_t( dependency.attachmentCount ) )
+						|| !checkRange< binary::BufferAttachment >( binary::SectionKind::BufferAttachments, dependency.bufferBegin, 2u * uint64_t( dependency.bufferCount ) ) )
+					{
+						break;
+					}
+
+					RenderPassDependencies value{ getPass( dependency.srcPass ), getPass( dependency.dstPass ) };
+
+					for ( uint32_t index = 0u; index < dependency.attachmentCount; ++index )
+					{
+						value.srcOutputs.push_back( getAttachment( dependency.attachmentBegin + index ) );
+						value.dstInputs.push_back( getAttachment( dependency.attachmentBegin + dependency.attachmentCount + index ) );
+					}
+
+					for ( uint32_t index = 0u; index < dependency.bufferCount; ++index )
+					{
+						value.srcBufferOutputs.push_back( getBufferAttachment( dependency.bufferBegin + index ) );
+						value.dstBufferInputs.push_back( getBufferAttachment( dependency.bufferBegin + dependency.bufferCount + index ) );
+					}
+
+					result.push_back( std::move( value ) );
+				}
+
+				return result;
+			}
+
+			PassBarriers getBarriers( binary::Pass const & pass )const
+			{
+				PassBarriers result;
+
+				if ( !checkRange< binary::ImageBarrier >( binary::SectionKind::ImageBarriers, pass.imageBarrierBegin, pass.imageBarrierCount )
+					|| !checkRange< binary::BufferBarrier >( binary::SectionKind::BufferBarriers, pass.bufferBarrierBegin, pass.bufferBarrierCount ) )
+				{
+					return result;
+				}
+
+				for ( uint32_t index = 0u; index < pass.imageBarrierCount; ++index )
+				{
+					auto & barrier = get< binary::ImageBarrier >( binary::SectionKind::ImageBarriers, pass.imageBarrierBegin + index );
+					result.images.push_back( { getImage( barrier.image )
+						, barrier.subresourceRange
+						, barrier.oldLayout
+						, barrier.newLayout
+						, barrier.srcAccessMask
+						, barrier.dstAccessMask
+						, barrier.srcStageMask
+						, barrier.dstStageMask } );
+				}
+
+				for ( uint32_t index = 0u; index < pass.bufferBarrierCount; ++index )
+				{
+					auto & barrier = get< binary::BufferBarrier >( binary::SectionKind::BufferBarriers, pass.bufferBarrierBegin + index );
+					result.buffers.push_back( { getBuffer( barrier.buffer )
+						, barrier.offset
+						, barrier.size
+						, barrier.srcAccessMask
+						, barrier.dstAccessMask
+						, barrier.srcStageMask
+						, barrier.dstStageMask } );
+				}
+
+				return result;
+			}
+
+		private:
+			CompiledGraph const & m_compiled;
+			RenderPassArray const & m_passes;
+			SlotMap< ImageData > const & m_images;
+			SlotMap< ImageViewData > const & m_views;
+			SlotMap< BufferData > const & m_buffers;
+			mutable bool m_valid{ true };
+		};
+	}
+
+	uint64_t RenderGraph::getGraphHash()const
+	{
+		details::StableHash hash;
+		hash.add( binary::Version );
+		hash.add( uint32_t( m_passIds.size() ) );
+
+		for ( auto & pass : m_passes )
+		{
+			if ( pass )
+			{
+				addHash( hash, *pass );
+			}
+		}
+
+		hash.add( uint32_t( m_images.size() ) );
+
+		m_images.forEach( [&hash]( ImageId id, ImageData const & data )
+			{
+				hash.add( id.id );
+				addHash( hash, data );
+			} );
+
+		hash.add( uint32_t( m_imageViews.size() ) );
+
+		m_imageViews.forEach( [&hash]( ImageViewId id, ImageViewData const & data )
+			{
+				hash.add( id.id );
+				addHash( hash, data );
+			} );
+
+		hash.add( uint32_t( m_buffers.size() ) );
+
+		m_buffers.forEach( [&hash]( BufferId id, BufferData const & data )
+			{
+				hash.add( id.id );
+				addHash( hash, data );
+			} );
+
+		hash.add( uint32_t( m_historyImages.size() ) );
+
+		for ( auto & history : m_historyImages )
+		{
+			hash.add( history.first.id );
+			hash.add( uint32_t( history.second.size() ) );
+
+			for ( auto & backing : history.second )
+			{
+				hash.add( backing.id );
+			}
+		}
+
+		hash.add( uint32_t( m_historyAliases.size() ) );
+
+		for ( auto & alias : m_historyAliases )
+		{
+			hash.add( alias.first.id );
+			hash.add( alias.second.image.id );
+			hash.add( alias.second.frameOffset );
+		}
+
+		return hash.getValue();
+	}
+
+	std::vector< uint8_t > RenderGraph::serialise()const
+	{
+		if ( m_executionOrder.empty() )
+		{
+			CRG_Exception( "The graph must be compiled before being serialised." );
+		}
+
+		Writer writer{ m_executionOrder };
+
+		m_images.forEach( [&writer]( ImageId id, ImageData const & data )
+			{
+				binary::Image record{};
+				record.id = id.id;
+				record.flags = data.flags;
+				record.imageType = data.imageType;
+				record.format = data.format;
+				record.extent = data.extent;
+				record.mipLevels = data.mipLevels;
+				record.arrayLayers = data.arrayLayers;
+				record.samples = data.samples;
+				record.tiling = data.tiling;
+				record.usage = data.usage;
+				writer.images.push_back( record );
+			} );
+		m_imageViews.forEach( [&writer]( ImageViewId id, ImageViewData const & data )
+			{
+				binary::View record{};
+				record.id = id.id;
+				record.image = data.image.id;
+				record.flags = data.flags;
+				record.viewType = data.viewType;
+				record.format = data.format;
+				record.subresourceRange = data.subresourceRange;
+				writer.views.push_back( record );
+			} );
+		m_buffers.forEach( [&writer]( BufferId id, BufferData const & data )
+			{
+				binary::Buffer record{};
+				record.id = id.id;
+				record.flags = data.flags;
+				record.size = data.size;
+				record.usage = data.usage;
+				writer.buffers.push_back( record );
+			} );
+
+		for ( uint32_t index = 0u; index < m_executionOrder.size(); ++index )
+		{
+			auto & barriers = m_barriers[index];
+			binary::Pass record{};
+			record.name = writer.addString( m_executionOrder[index]->name );
+			record.kind = uint32_t( m_executionOrder[index]->kind );
+			record.signature = uint64_t( m_passSignatures[index] );
+			record.imageBarrierBegin = uint32_t( writer.imageBarriers.size() );
+			record.imageBarrierCount = uint32_t( barriers.images.size() );
+			record.bufferBarrierBegin = uint32_t( writer.bufferBarriers.size() );
+			record.bufferBarrierCount = uint32_t( barriers.buffers.size() );
+			writer.passes.push_back( record );
+
+			for ( auto & barrier : barriers.images )
+			{
+				binary::ImageBarrier value{};
+				value.image = barrier.image.id;
+				value.subresourceRange = barrier.subresourceRange;
+				value.oldLayout = barrier.oldLayout;
+				value.newLayout = barrier.newLayout;
+				value.srcAccessMask = barrier.srcAccessMask;
+				value.dstAccessMask = barrier.dstAccessMask;
+				value.srcStageMask = barrier.srcStageMask;
+				value.dstStageMask = barrier.dstStageMask;
+				writer.imageBarriers.push_back( value );
+			}
+
+			for ( auto & barrier : barriers.buffers )
+			{
+				binary::BufferBarrier value{};
+				value.buffer = barrier.buffer.id;
+				value.offset = barrier.offset;
+				value.size = barrier.size;
+				value.srcAccessMask = barrier.srcAccessMask;
+				value.dstAccessMask = barrier.dstAccessMask;
+				value.srcStageMask = barrier.srcStageMask;
+				value.dstStageMask = barrier.dstStageMask;
+				writer.bufferBarriers.push_back( value );
+			}
+		}
+
+		for ( auto & transition : m_transitions )
+		{
+			writer.addTransition( transition );
+		}
+
+		for ( auto & dependency : m_dependencies )
+		{
+			writer.addDependency( dependency, writer.dependencies );
+		}
+
+		for ( auto & dependency : m_historyDependencies )
+		{
+			writer.addDependency( dependency, writer.historyDependencies );
+		}
+
+		std::unordered_map< GraphNode const *, uint32_t > nodeIndices;
+
+		for ( auto & node : m_nodes )
+		{
+			nodeIndices.emplace( node.get(), uint32_t( writer.nodes.size() ) );
+			writer.nodes.push_back( writer.getPassIndex( getRenderPass( *node ) ) );
+		}
+
+		auto addEdges = [&writer, &nodeIndices]( GraphNode const & prev
+			, uint32_t prevIndex )
+		{
+			for ( auto & next : prev.getNext() )
+			{
+				auto & transitions = next->getAttachsToPrev( &prev );
+				binary::Edge edge{};
+				edge.prev = prevIndex;
+				edge.next = nodeIndices.at( next );
+				edge.transitionBegin = uint32_t( writer.transitions.size() );
+				edge.transitionCount = uint32_t( transitions.size() );
+				writer.edges.push_back( edge );
+
+				for ( auto & transition : transitions )
+				{
+					writer.addTransition( transition );
+				}
+			}
+		};
+		addEdges( m_root, binary::InvalidIndex );
+
+		for ( auto & node : m_nodes )
+		{
+			addEdges( *node, nodeIndices.at( node.get() ) );
+		}
+
+		return writer.finish( getGraphHash() );
+	}
+
+	bool RenderGraph::load( CompiledGraph const & compiled )
+	{
+		compactPasses();
+
+		if ( !compiled.isValid()
+			|| compiled.getGraphHash() != getGraphHash() )
+		{
+			return false;
+		}
+
+		auto passes = compiled.getPasses();
+
+		if ( passes.size() != m_passes.size() )
+		{
+			return false;
+		}
+
+		std::unordered_map< std::string_view, RenderPass const * > names;
+
+		for ( auto & pass : m_passes )
+		{
+			names.emplace( pass->name, pass.get() );
+		}
+
+		RenderPassArray executionOrder;
+		std::vector< size_t > passSignatures;
+
+		for ( auto & pass : passes )
+		{
+			if ( !compiled.isValid( pass.name ) )
+			{
+				return false;
+			}
+
+			auto it = names.find( compiled.getString( pass.name ) );
+
+			if ( it == names.end() )
+			{
+				return false;
+			}
+
+			executionOrder.push_back( it->second );
+			passSignatures.push_back( size_t( pass.signature ) );
+			// Each pass is found once, so that a duplicate can't hide a missing one.
+			names.erase( it );
+		}
+
+		Reader reader{ compiled, executionOrder, m_images, m_imageViews, m_buffers };
+		PassBarriersArray barriers;
+
+		for ( auto & pass : passes )
+		{
+			barriers.push_back( reader.getBarriers( pass ) );
+		}
+
+		auto dependencies = reader.getDependencies( binary::SectionKind::Dependencies );
+		auto historyDependencies = reader.getDependencies( binary::SectionKind::HistoryDependencies );
+		auto edges = compiled.getSection< binary::Edge >( binary::SectionKind::Edges );
+		uint64_t edgesTransitions{};
+
+		for ( auto & edge : edges )
+		{
+			edgesTransitions += edge.transitionCount;
+		}
+
+		auto transitionsCount = uint32_t( compiled.getSection< binary::Transition >( binary::SectionKind::Transitions ).size() );
+
+		if ( edgesTransitions > transitionsCount )
+		{
+			return false;
+		}
+
+		auto transitions = reader.getTransitions( 0u, uint32_t( transitionsCount - edgesTransitions ) );
+		RenderPassNodePtrArray nodes;
+
+		for ( auto & index : compiled.getSection< uint32_t >( binary::SectionKind::Nodes ) )
+		{
+			auto pass = reader.getPass( index );
+
+			if ( !pass )
+			{
+				return false;
+			}
+
+			nodes.push_back( std::make_unique< RenderPassNode >( *pass, uint32_t( nodes.size() + 1u ) ) );
+		}
+
+		std::vector< AttachmentTransitionArray > edgeTransitions;
+
+		for ( auto & edge : edges )
+		{
+			if ( ( edge.prev != binary::InvalidIndex && edge.prev >= nodes.size() )
+				|| edge.next >= nodes.size() )
+			{
+				return false;
+			}
+
+			edgeTransitions.push_back( reader.getTransitions( edge.transitionBegin, edge.transitionCount ) );
+		}
+
+		if ( !reader.isValid() )
+		{
+			return false;
+		}
+
+		// Everything has been read, the compiled state can now be replaced.
+		m_root = RootNode{ m_root.getName() };
+		m_nodes = std::move( nodes );
+
+		for ( size_t index = 0u; index < edges.size(); ++index )
+		{
+			auto & edge = edges[index];
+			GraphAdjacentNode prev = edge.prev == binary::InvalidIndex
+				? static_cast< GraphAdjacentNode >( &m_root )
+				: m_nodes[edge.prev].get();
+			prev->attachNode( m_nodes[edge.next].get()
+				, std::move( edgeTransitions[index] ) );
+		}
+
+		m_transitions = std::move( transitions );
+		m_dependencies = std::move( dependencies );
+		auto components = details::findPassComponents( m_passes, m_dependencies );
+		m_cycles = details::buildCycles( m_passes, m_dependencies, components );
+		m_reachability = details::buildReachability( m_dependencies, std::move( components ), m_reachabilityMaxSize );
+		m_executionOrder = std::move( executionOrder );
+		m_passSignatures = std::move( passSignatures );
+		m_barriers = std::move( barriers );
+		m_historyDependencies = std::move( historyDependencies );
+		++m_compileCount;
+		return true;
+	}
+}
@@ -0,0 +1,158 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/GraphTraversal.hpp"
+
+#include "RenderGraph/RenderGraph.hpp"
+
+#include <algorithm>
+
+namespace crg
+{
+	GraphTraversal::GraphTraversal( RenderGraph & graph )
+		: m_graph{ graph }
+	{
+		resize();
+	}
+
+	GraphTraversal::Range GraphTraversal::traverse( Order order )
+	{
+		resize();
+
+		if ( ++m_epoch == 0u )
+		{
+			std::fill( m_visited.begin(), m_visited.end(), 0u );
+			m_epoch = 1u;
+		}
+
+		m_order = order;
+		m_nodes.clear();
+		m_stack.clear();
+		m_cursor = 0u;
+		auto root = m_graph.getGraph();
+		visit( root );
+
+		switch ( order )
+		{
+		case Order::BreadthFirst:
+			m_nodes.push_back( root );
+			break;
+		case Order::DepthFirst:
+			m_stack.push_back( { root, 0u } );
+			break;
+		case Order::Topological:
+			// The nodes are added in post-order, then reversed.
+			m_stack.push_back( { root, 0u } );
+
+			while ( !m_stack.empty() )
+			{
+				auto & frame = m_stack.back();
+				auto & nexts = frame.node->getNext();
+
+				if ( frame.next < nexts.size() )
+				{
+					auto node = nexts[frame.next++];
+
+					if ( visit( node ) )
+					{
+						m_stack.push_back( { node, 0u } );
+					}
+				}
+				else
+				{
+					m_nodes.push_back( frame.node );
+					m_stack.pop_back();
+				}
+			}
+
+			std::reverse( m_nodes.begin(), m_nodes.end() );
+			break;
+		}
+
+		return Range{ *this, root };
+	}
+
+	void GraphTraversal::resize()
+	{
+		auto count = m_graph.getNodeCount();
+
+		if ( m_visited.size() < count )
+		{
+			// Each node is queued or stacked at most once.
+			m_visited.resize( count, 0u );
+			m_nodes.reserve( count );
+			m_stack.reserve( count );
+		}
+	}
+
+	bool GraphTraversal::visit( GraphAdjacentNode node )
+	{
+		auto & visited = m_visited[node->getIndex()];
+
+		if ( visited == m_epoch )
+		{
+			return false;
+		}
+
+		visited = m_epoch;
+		return true;
+	}
+
+	GraphAdjacentNode GraphTraversal::next()
+	{
+		switch ( m_order )
+		{
+		case Order::BreadthFirst:
+			return nextBreadthFirst();
+		case Order::DepthFirst:
+			return nextDepthFirst();
+		default:
+			return ++m_cursor < m_nodes.size()
+				? m_nodes[m_cursor]
+				: nullptr;
+		}
+	}
+
+	GraphAdjacentNode GraphTraversal::nextBreadthFirst()
+	{
+		// The next nodes of the current one are only queued when leaving it.
+		for ( auto node : m_nodes[m_cursor]->getNext() )
+		{
+			if ( visit( node ) )
+			{
+				m_nodes.push_back( node );
+			}
+		}
+
+		return ++m_cursor < m_nodes.size()
+			? m_nodes[m_cursor]
+			: nullptr;
+	}
+
+	GraphAdjacentNode GraphTraversal::nextDepthFirst()
+	{
+		while ( !m_stack.empty() )
+		{
+			auto & frame = m_stack.back();
+			auto & nexts = frame.node->getNext();
+
+			if ( frame.next < nexts.size() )
+			{
+				auto node = nexts[frame.next++];
+
+				if ( visit( node ) )
+				{
+					m_stack.push_back( { node, 0u } );
+					return node;
+				}
+			}
+			else
+			{
+				m_stack.pop_back();
+			}
+		}
+
+		return nullptr;
+	}
+}
@@ -0,0 +1,145 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/Attachment.hpp"
+#include "RenderGraph/AttachmentTransition.hpp"
+#include "RenderGraph/BufferAttachment.hpp"
+#include "RenderGraph/RenderPass.hpp"
+
+#include <functional>
+#include <type_traits>
+
+namespace crg
+{
+	namespace details
+	{
+		inline void hashCombine( size_t & seed
+			, size_t value )
+		{
+			seed ^= value + 0x9e3779b9u + ( seed << 6 ) + ( seed >> 2 );
+		}
+
+		template< typename TypeT >
+		inline void hashCombine( size_t & seed
+			, TypeT const & value )
+		{
+			hashCombine( seed, std::hash< TypeT >{}( value ) );
+		}
+
+		/**
+		*\brief
+		*	A 64 bits FNV-1a hash, giving the same result from one run to another.
+		*\remarks
+		*	Used where hashes are persisted, std::hash being allowed to change between runs.
+		*/
+		class StableHash
+		{
+		public:
+			inline void add( void const * data
+				, size_t size )
+			{
+				auto bytes = static_cast< uint8_t const * >( data );
+
+				for ( size_t index = 0u; index < size; ++index )
+				{
+					m_value ^= bytes[index];
+					m_value *= 1099511628211ull;
+				}
+			}
+
+			template< typename TypeT >
+			inline void add( TypeT const & value )
+			{
+				static_assert( std::is_arithmetic_v< TypeT > || std::is_enum_v< TypeT >
+					, "Only plain values can be hashed directly." );
+				add( &value, sizeof( TypeT ) );
+			}
+
+			inline void add( std::string const & value )
+			{
+				add( uint32_t( value.size() ) );
+				add( value.data(), value.size() );
+			}
+
+			inline uint64_t getValue()const
+			{
+				return m_value;
+			}
+
+		private:
+			uint64_t m_value{ 14695981039346656037ull };
+		};
+
+		inline size_t getHash( Attachment const & attach )
+		{
+			size_t result{};
+			hashCombine( result, attach.name );
+			hashCombine( result, attach.view.id );
+			hashCombine( result, attach.view.generation );
+			hashCombine( result, int( attach.kind ) );
+			hashCombine( result, int( attach.loadOp ) );
+			hashCombine( result, int( attach.storeOp ) );
+			hashCombine( result, int( attach.stencilLoadOp ) );
+			hashCombine( result, int( attach.stencilStoreOp ) );
+			return result;
+		}
+
+		inline size_t getHash( ImageViewData const & data )
+		{
+			size_t result{};
+			hashCombine( result, data.image.id );
+			hashCombine( result, data.image.generation );
+			hashCombine( result, data.flags );
+			hashCombine( result, int( data.viewType ) );
+			hashCombine( result, int( data.format ) );
+			hashCombine( result, data.subresourceRange.aspectMask );
+			hashCombine( result, data.subresourceRange.baseMipLevel );
+			hashCombine( result, data.subresourceRange.levelCount );
+			hashCombine( result, data.subresourceRange.baseArrayLayer );
+			hashCombine( result, data.subresourceRange.layerCount );
+			return result;
+		}
+
+		inline size_t getHash( BufferAttachment const & attach )
+		{
+			size_t result{};
+			hashCombine( result, attach.name );
+			hashCombine( result, attach.buffer.id );
+			hashCombine( result, attach.buffer.generation );
+			hashCombine( result, int( attach.kind ) );
+			hashCombine( result, attach.offset );
+			hashCombine( result, attach.range );
+			return result;
+		}
+
+		inline size_t getHash( AttachmentPasses const & attach )
+		{
+			size_t result{ getHash( attach.attachment ) };
+			// The passes set is sorted by address, so their hashes are summed to stay order independent.
+			size_t passes{};
+
+			for ( auto & pass : attach.passes )
+			{
+				passes += std::hash< std::string >{}( pass->name );
+			}
+
+			hashCombine( result, passes );
+			return result;
+		}
+
+		inline size_t getHash( AttachmentTransition const & transition )
+		{
+			size_t result{ getHash( transition.dstInput ) };
+
+			for ( auto & srcOutput : transition.srcOutputs )
+			{
+				hashCombine( result, getHash( srcOutput ) );
+			}
+
+			return result;
+		}
+	}
+}
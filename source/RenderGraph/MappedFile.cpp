@@ -0,0 +1,117 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/MappedFile.hpp"
+
+#if defined( _WIN32 )
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace crg
+{
+#if defined( _WIN32 )
+
+	MappedFile::MappedFile( std::string const & path )
+	{
+		auto file = CreateFileA( path.c_str()
+			, GENERIC_READ
+			, FILE_SHARE_READ | FILE_SHARE_DELETE
+			, nullptr
+			, OPEN_EXISTING
+			, FILE_ATTRIBUTE_NORMAL
+			, nullptr );
+
+		if ( file == INVALID_HANDLE_VALUE )
+		{
+			return;
+		}
+
+		LARGE_INTEGER size{};
+
+		if ( !GetFileSizeEx( file, &size )
+			|| size.QuadPart == 0 )
+		{
+			CloseHandle( file );
+			return;
+		}
+
+		auto mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+		if ( !mapping )
+		{
+			CloseHandle( file );
+			return;
+		}
+
+		m_data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+
+		if ( !m_data )
+		{
+			CloseHandle( mapping );
+			CloseHandle( file );
+			return;
+		}
+
+		m_size = size_t( size.QuadPart );
+		m_file = file;
+		m_mapping = mapping;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if ( m_data )
+		{
+			UnmapViewOfFile( m_data );
+			CloseHandle( m_mapping );
+			CloseHandle( m_file );
+		}
+	}
+
+#else
+
+	MappedFile::MappedFile( std::string const & path )
+	{
+		auto file = open( path.c_str(), O_RDONLY );
+
+		if ( file < 0 )
+		{
+			return;
+		}
+
+		struct stat status{};
+
+		if ( fstat( file, &status ) == 0
+			&& status.st_size > 0 )
+		{
+			auto data = mmap( nullptr, size_t( status.st_size ), PROT_READ, MAP_PRIVATE, file, 0 );
+
+			if ( data != MAP_FAILED )
+			{
+				m_data = data;
+				m_size = size_t( status.st_size );
+			}
+		}
+
+		// The mapping stays valid once the file is closed.
+		close( file );
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if ( m_data )
+		{
+			munmap( const_cast< void * >( m_data ), m_size );
+		}
+	}
+
+#endif
+}
@@ -0,0 +1,508 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/MemoryReport.hpp"
+
+#include "RenderGraph/RenderGraph.hpp"
+
+namespace crg
+{
+	namespace details
+	{
+		struct FormatBlock
+		{
+			uint32_t size;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		FormatBlock getFormatBlock( VkFormat format )
+		{
+			static uint32_t const astcSizes[][2]
+			{
+				{ 4u, 4u },
+				{ 5u, 4u },
+				{ 5u, 5u },
+				{ 6u, 5u },
+				{ 6u, 6u },
+				{ 8u, 5u },
+				{ 8u, 6u },
+				{ 8u, 8u },
+				{ 10u, 5u },
+				{ 10u, 6u },
+				{ 10u, 8u },
+				{ 10u, 10u },
+				{ 12u, 10u },
+				{ 12u, 12u },
+			};
+
+			if ( format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+				&& format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK )
+			{
+				auto & block = astcSizes[( format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK ) / 2];
+				return { 16u, block[0], block[1] };
+			}
+
+			if ( format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK
+				&& format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK )
+			{
+				switch ( format )
+				{
+				case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+				case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+				case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+				case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+				case VK_FORMAT_BC4_UNORM_BLOCK:
+				case VK_FORMAT_BC4_SNORM_BLOCK:
+				case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+				case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+				case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+				case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+				case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+				case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+					return { 8u, 4u, 4u };
+				default:
+					return { 16u, 4u, 4u };
+				}
+			}
+
+			if ( format == VK_FORMAT_R4G4_UNORM_PACK8
+				|| format == VK_FORMAT_S8_UINT
+				|| ( format >= VK_FORMAT_R8_UNORM && format <= VK_FORMAT_R8_SRGB ) )
+			{
+				return { 1u, 1u, 1u };
+			}
+
+			if ( ( format >= VK_FORMAT_R4G4B4A4_UNORM_PACK16 && format <= VK_FORMAT_A1R5G5B5_UNORM_PACK16 )
+				|| ( format >= VK_FORMAT_R8G8_UNORM && format <= VK_FORMAT_R8G8_SRGB )
+				|| ( format >= VK_FORMAT_R16_UNORM && format <= VK_FORMAT_R16_SFLOAT )
+				|| format == VK_FORMAT_D16_UNORM )
+			{
+				return { 2u, 1u, 1u };
+			}
+
+			if ( ( format >= VK_FORMAT_R8G8B8_UNORM && format <= VK_FORMAT_B8G8R8_SRGB )
+				|| format == VK_FORMAT_D16_UNORM_S8_UINT )
+			{
+				return { 3u, 1u, 1u };
+			}
+
+			if ( format >= VK_FORMAT_R16G16B16_UNORM && format <= VK_FORMAT_R16G16B16_SFLOAT )
+			{
+				return { 6u, 1u, 1u };
+			}
+
+			if ( ( format >= VK_FORMAT_R16G16B16A16_UNORM && format <= VK_FORMAT_R16G16B16A16_SFLOAT )
+				|| ( format >= VK_FORMAT_R32G32_UINT && format <= VK_FORMAT_R32G32_SFLOAT )
+				|| ( format >= VK_FORMAT_R64_UINT && format <= VK_FORMAT_R64_SFLOAT )
+				|| format == VK_FORMAT_D32_SFLOAT_S8_UINT )
+			{
+				// D32_SFLOAT_S8_UINT is usually stored in two planes, or padded to 8 bytes.
+				return { 8u, 1u, 1u };
+			}
+
+			if ( format >= VK_FORMAT_R32G32B32_UINT && format <= VK_FORMAT_R32G32B32_SFLOAT )
+			{
+				return { 12u, 1u, 1u };
+			}
+
+			if ( ( format >= VK_FORMAT_R32G32B32A32_UINT && format <= VK_FORMAT_R32G32B32A32_SFLOAT )
+				|| ( format >= VK_FORMAT_R64G64_UINT && format <= VK_FORMAT_R64G64_SFLOAT ) )
+			{
+				return { 16u, 1u, 1u };
+			}
+
+			if ( format >= VK_FORMAT_R64G64B64_UINT && format <= VK_FORMAT_R64G64B64_SFLOAT )
+			{
+				return { 24u, 1u, 1u };
+			}
+
+			if ( format >= VK_FORMAT_R64G64B64A64_UINT && format <= VK_FORMAT_R64G64B64A64_SFLOAT )
+			{
+				return { 32u, 1u, 1u };
+			}
+
+			// The 32 bits formats, and the unknown ones.
+			return { 4u, 1u, 1u };
+		}
+		/**
+		*\brief
+		*	Accumulates the estimated heap usage of the containers, and the part of it which is slack.
+		*/
+		class MemoryCounter
+		{
+		public:
+			// Estimated bookkeeping of a heap block, and its alignment (as done by most general purpose allocators).
+			static size_t constexpr BlockHeader = sizeof( size_t );
+			static size_t constexpr BlockAlign = 2u * sizeof( void * );
+			// Estimated size of the links and colour of a std::map/std::set node.
+			static size_t constexpr TreeNodeHeader = 4u * sizeof( void * );
+			// Estimated size of the link and cached hash of a std::unordered_map node.
+			static size_t constexpr HashNodeHeader = 2u * sizeof( void * );
+
+			void addBlock( size_t used
+				, size_t reserved )
+			{
+				if ( reserved == 0u )
+				{
+					return;
+				}
+
+				auto allocated = ( ( reserved + BlockHeader + BlockAlign - 1u ) / BlockAlign ) * BlockAlign;
+				m_bytes += allocated;
+				m_slack += allocated - used;
+			}
+
+			void addObject( size_t size )
+			{
+				m_bytes += size;
+			}
+
+			void add( std::string const & value )
+			{
+				auto begin = reinterpret_cast< char const * >( &value );
+
+				// Short strings are stored inside the object.
+				if ( value.data() < begin || value.data() >= begin + sizeof( value ) )
+				{
+					addBlock( value.size() + 1u, value.capacity() + 1u );
+				}
+			}
+
+			template< typename TypeT >
+			void addArray( std::vector< TypeT > const & value )
+			{
+				addBlock( value.size() * sizeof( TypeT )
+					, value.capacity() * sizeof( TypeT ) );
+			}
+
+			void addBlocks( size_t size
+				, size_t count )
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					addBlock( size, size );
+				}
+			}
+
+			template< typename TypeT >
+			void addTreeNodes( size_t count )
+			{
+				for ( size_t index = 0u; index < count; ++index )
+				{
+					addBlock( sizeof( TypeT ), TreeNodeHeader + sizeof( TypeT ) );
+				}
+			}
+
+			template< typename DataT >
+			void addSlotMap( SlotMap< DataT > const & value )
+			{
+				addArray( value.getSlots() );
+				addArray( value.getFreeSlots() );
+			}
+
+			template< typename MapT >
+			void addHashMap( MapT const & value )
+			{
+				// A single bucket is stored inside the object.
+				if ( value.bucket_count() > 1u )
+				{
+					addBlock( value.bucket_count() * sizeof( void * )
+						, value.bucket_count() * sizeof( void * ) );
+				}
+
+				for ( size_t index = 0u; index < value.size(); ++index )
+				{
+					addBlock( sizeof( typename MapT::value_type ), HashNodeHeader + sizeof( typename MapT::value_type ) );
+				}
+			}
+
+			void add( Attachment const & value )
+			{
+				add( value.name );
+			}
+
+			void add( BufferAttachment const & value )
+			{
+				add( value.name );
+			}
+
+			template< typename TypeT >
+			void addAll( std::vector< TypeT > const & value )
+			{
+				addArray( value );
+
+				for ( auto & element : value )
+				{
+					add( element );
+				}
+			}
+
+			void add( AttachmentPasses const & value )
+			{
+				add( value.attachment );
+				addTreeNodes< RenderPass const * >( value.passes.size() );
+			}
+
+			void add( AttachmentTransition const & value )
+			{
+				addAll( value.srcOutputs );
+				add( value.dstInput );
+			}
+
+			void add( RenderPassDependencies const & value )
+			{
+				addAll( value.srcOutputs );
+				addAll( value.dstInputs );
+				addAll( value.srcBufferOutputs );
+				addAll( value.dstBufferInputs );
+			}
+
+			void add( RenderPassCycle const & value )
+			{
+				addArray( value.passes );
+				addAll( value.dependencies );
+			}
+
+			void add( PassBarriers const & value )
+			{
+				addArray( value.images );
+				addArray( value.buffers );
+			}
+			/**
+			*\return
+			*	The bytes counted since the previous call.
+			*/
+			size_t take()
+			{
+				auto result = m_bytes;
+				m_total += m_bytes;
+				m_bytes = 0u;
+				return result;
+			}
+
+			size_t getTotal()const
+			{
+				return m_total;
+			}
+
+			size_t getSlack()const
+			{
+				return m_slack;
+			}
+
+		private:
+			size_t m_bytes{};
+			size_t m_total{};
+			size_t m_slack{};
+		};
+	}
+
+	VkDeviceSize getMemorySize( ImageData const & image )
+	{
+		auto block = details::getFormatBlock( image.format );
+		VkDeviceSize result{};
+
+		for ( uint32_t level = 0u; level < image.mipLevels; ++level )
+		{
+			auto width = std::max( 1u, image.extent.width >> level );
+			auto height = std::max( 1u, image.extent.height >> level );
+			result += VkDeviceSize( ( width + block.width - 1u ) / block.width )
+				* ( ( height + block.height - 1u ) / block.height )
+				* block.size;
+		}
+
+		return result
+			* std::max( 1u, image.arrayLayers )
+			* std::max( 1u, uint32_t( image.samples ) );
+	}
+
+	MemoryReport RenderGraph::getMemoryReport()const
+	{
+		MemoryReport result;
+		details::MemoryCounter counter;
+
+		counter.addObject( sizeof( RenderGraph ) );
+		counter.add( m_root.getName() );
+		result.graph = counter.take();
+
+		counter.addArray( m_passes );
+		counter.addBlocks( sizeof( RenderPass ), m_passIds.size() );
+		counter.addHashMap( m_passIds );
+		counter.addHashMap( m_passIndices );
+
+		for ( auto & pass : m_passes )
+		{
+			if ( pass )
+			{
+				counter.add( pass->name );
+			}
+		}
+
+		// The passes registered in the stagings, and not merged yet.
+		counter.addTreeNodes< decltype( m_stagings )::value_type >( m_stagings.size() );
+		counter.addBlocks( sizeof( PassStaging ), m_stagings.size() );
+
+		for ( auto & it : m_stagings )
+		{
+			auto & staging = *it.second;
+			counter.add( it.first );
+			counter.add( staging.getName() );
+			// The owning array grows along with the array of pointers.
+			counter.addArray( staging.getPasses() );
+			counter.addArray( staging.getPasses() );
+			counter.addBlocks( sizeof( RenderPass ), staging.getPasses().size() );
+
+			for ( auto pass : staging.getPasses() )
+			{
+				counter.add( pass->name );
+			}
+		}
+
+		result.passes = counter.take();
+
+		counter.addAll( m_attachments );
+
+		for ( auto & pass : m_passes )
+		{
+			if ( !pass )
+			{
+				continue;
+			}
+
+			counter.addAll( pass->sampled );
+			counter.addAll( pass->colourInOuts );
+			counter.addAll( pass->storages );
+			counter.addAll( pass->transfers );
+			counter.addAll( pass->buffers );
+
+			if ( pass->depthStencilInOut )
+			{
+				counter.add( *pass->depthStencilInOut );
+			}
+		}
+
+		for ( auto & it : m_stagings )
+		{
+			for ( auto pass : it.second->getPasses() )
+			{
+				counter.addAll( pass->sampled );
+				counter.addAll( pass->colourInOuts );
+				counter.addAll( pass->storages );
+				counter.addAll( pass->transfers );
+				counter.addAll( pass->buffers );
+
+				if ( pass->depthStencilInOut )
+				{
+					counter.add( *pass->depthStencilInOut );
+				}
+			}
+		}
+
+		result.attachments = counter.take();
+
+		counter.addSlotMap( m_images );
+		counter.addTreeNodes< decltype( m_historyImages )::value_type >( m_historyImages.size() );
+		counter.addTreeNodes< HistoryAliasMap::value_type >( m_historyAliases.size() );
+
+		for ( auto & history : m_historyImages )
+		{
+			counter.addArray( history.second );
+		}
+
+		for ( auto & it : m_stagings )
+		{
+			counter.addArray( it.second->getImages() );
+		}
+
+		result.images = counter.take();
+
+		counter.addSlotMap( m_imageViews );
+		counter.addHashMap( m_viewIds );
+		counter.addArray( m_viewRefCounts );
+
+		for ( auto & it : m_stagings )
+		{
+			counter.addArray( it.second->getViews() );
+		}
+
+		result.views = counter.take();
+
+		counter.addSlotMap( m_buffers );
+
+		for ( auto & it : m_stagings )
+		{
+			counter.addArray( it.second->getBuffers() );
+		}
+
+		result.buffers = counter.take();
+
+		counter.addArray( m_nodes );
+		counter.addArray( m_root.getNext() );
+
+		counter.addBlocks( sizeof( RenderPassNode ), m_nodes.size() );
+
+		for ( auto & node : m_nodes )
+		{
+			counter.add( node->getName() );
+			counter.addArray( node->getNext() );
+		}
+
+		result.nodes = counter.take();
+
+		counter.addTreeNodes< AttachmentsNodeMap::value_type >( m_root.getAllAttachsToPrev().size() );
+
+		for ( auto & node : m_nodes )
+		{
+			auto & attachsToPrev = node->getAllAttachsToPrev();
+			counter.addTreeNodes< AttachmentsNodeMap::value_type >( attachsToPrev.size() );
+
+			for ( auto & attaches : attachsToPrev )
+			{
+				counter.addAll( attaches.second );
+			}
+		}
+
+		result.attachsToPrev = counter.take();
+
+		counter.addAll( m_transitions );
+		result.transitions = counter.take();
+
+		counter.addAll( m_dependencies );
+		counter.addAll( m_historyDependencies );
+		counter.addAll( m_cycles );
+		counter.addArray( m_reachability.passComponents );
+		counter.addArray( m_reachability.bits );
+		counter.addArray( m_reachability.componentChains );
+		counter.addArray( m_reachability.chainPositions );
+		counter.addArray( m_reachability.chainReaches );
+		counter.addArray( m_reachability.nextOffsets );
+		counter.addArray( m_reachability.nexts );
+		result.dependencies = counter.take();
+
+		counter.addArray( m_executionOrder );
+		counter.addArray( m_passSignatures );
+		counter.addAll( m_barriers );
+		result.schedule = counter.take();
+
+		result.slack = counter.getSlack();
+		result.hostTotal = counter.getTotal();
+
+		m_images.forEach( [this, &result]( ImageId id, ImageData const & data )
+			{
+				// History images and their aliases are only handles on their backing images.
+				if ( m_historyImages.end() == m_historyImages.find( id )
+					&& m_historyAliases.end() == m_historyAliases.find( id ) )
+				{
+					result.gpuImages += getMemorySize( data );
+				}
+			} );
+		m_buffers.forEach( [&result]( BufferId, BufferData const & data )
+			{
+				result.gpuBuffers += data.size;
+			} );
+
+		return result;
+	}
+}
@@ -0,0 +1,188 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "OverlapKernel.hpp"
+
+#if defined( __AVX2__ )
+#	define CRG_OverlapAVX2 1
+#	include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	define CRG_OverlapSSE2 1
+#	include <emmintrin.h>
+#elif defined( __aarch64__ ) || defined( _M_ARM64 )
+#	define CRG_OverlapNEON 1
+#	include <arm_neon.h>
+#endif
+
+namespace crg
+{
+	namespace details
+	{
+		namespace
+		{
+			bool isEmpty( ViewRange const & view )
+			{
+				return view.mipBegin >= view.mipEnd
+					|| view.layerBegin >= view.layerEnd;
+			}
+
+#if CRG_OverlapAVX2
+
+			// There is no unsigned comparison, flipping the sign bit makes the signed one order unsigned values.
+			__m256i getBiased( uint32_t const * values )
+			{
+				return _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast< __m256i const * >( values ) )
+					, _mm256_set1_epi32( int( 0x80000000u ) ) );
+			}
+
+			__m256i getBiased( uint32_t value )
+			{
+				return _mm256_set1_epi32( int( value ^ 0x80000000u ) );
+			}
+
+			__m256i isLower( __m256i lhs, __m256i rhs )
+			{
+				return _mm256_cmpgt_epi32( rhs, lhs );
+			}
+
+			uint32_t getMask( ViewRange const & view
+				, ViewRanges const & ranges
+				, size_t begin )
+			{
+				auto images = _mm256_loadu_si256( reinterpret_cast< __m256i const * >( ranges.getImages() + begin ) );
+				auto mipBegins = getBiased( ranges.getMipBegins() + begin );
+				auto mipEnds = getBiased( ranges.getMipEnds() + begin );
+				auto layerBegins = getBiased( ranges.getLayerBegins() + begin );
+				auto layerEnds = getBiased( ranges.getLayerEnds() + begin );
+				auto result = _mm256_cmpeq_epi32( images, _mm256_set1_epi32( int( view.image ) ) );
+				result = _mm256_and_si256( result, isLower( getBiased( view.mipBegin ), mipEnds ) );
+				result = _mm256_and_si256( result, isLower( mipBegins, getBiased( view.mipEnd ) ) );
+				result = _mm256_and_si256( result, isLower( mipBegins, mipEnds ) );
+				result = _mm256_and_si256( result, isLower( getBiased( view.layerBegin ), layerEnds ) );
+				result = _mm256_and_si256( result, isLower( layerBegins, getBiased( view.layerEnd ) ) );
+				result = _mm256_and_si256( result, isLower( layerBegins, layerEnds ) );
+				return uint32_t( _mm256_movemask_ps( _mm256_castsi256_ps( result ) ) );
+			}
+
+#elif CRG_OverlapSSE2
+
+			// There is no unsigned comparison, flipping the sign bit makes the signed one order unsigned values.
+			__m128i getBiased( uint32_t const * values )
+			{
+				return _mm_xor_si128( _mm_loadu_si128( reinterpret_cast< __m128i const * >( values ) )
+					, _mm_set1_epi32( int( 0x80000000u ) ) );
+			}
+
+			__m128i getBiased( uint32_t value )
+			{
+				return _mm_set1_epi32( int( value ^ 0x80000000u ) );
+			}
+
+			__m128i isLower( __m128i lhs, __m128i rhs )
+			{
+				return _mm_cmplt_epi32( lhs, rhs );
+			}
+
+			uint32_t getHalfMask( ViewRange const & view
+				, ViewRanges const & ranges
+				, size_t begin )
+			{
+				auto images = _mm_loadu_si128( reinterpret_cast< __m128i const * >( ranges.getImages() + begin ) );
+				auto mipBegins = getBiased( ranges.getMipBegins() + begin );
+				auto mipEnds = getBiased( ranges.getMipEnds() + begin );
+				auto layerBegins = getBiased( ranges.getLayerBegins() + begin );
+				auto layerEnds = getBiased( ranges.getLayerEnds() + begin );
+				auto result = _mm_cmpeq_epi32( images, _mm_set1_epi32( int( view.image ) ) );
+				result = _mm_and_si128( result, isLower( getBiased( view.mipBegin ), mipEnds ) );
+				result = _mm_and_si128( result, isLower( mipBegins, getBiased( view.mipEnd ) ) );
+				result = _mm_and_si128( result, isLower( mipBegins, mipEnds ) );
+				result = _mm_and_si128( result, isLower( getBiased( view.layerBegin ), layerEnds ) );
+				result = _mm_and_si128( result, isLower( layerBegins, getBiased( view.layerEnd ) ) );
+				result = _mm_and_si128( result, isLower( layerBegins, layerEnds ) );
+				return uint32_t( _mm_movemask_ps( _mm_castsi128_ps( result ) ) );
+			}
+
+			uint32_t getMask( ViewRange const & view
+				, ViewRanges const & ranges
+				, size_t begin )
+			{
+				return getHalfMask( view, ranges, begin )
+					| ( getHalfMask( view, ranges, begin + 4u ) << 4u );
+			}
+
+#elif CRG_OverlapNEON
+
+			uint32_t getHalfMask( ViewRange const & view
+				, ViewRanges const & ranges
+				, size_t begin )
+			{
+				auto mipBegins = vld1q_u32( ranges.getMipBegins() + begin );
+				auto mipEnds = vld1q_u32( ranges.getMipEnds() + begin );
+				auto layerBegins = vld1q_u32( ranges.getLayerBegins() + begin );
+				auto layerEnds = vld1q_u32( ranges.getLayerEnds() + begin );
+				auto result = vceqq_u32( vld1q_u32( ranges.getImages() + begin ), vdupq_n_u32( view.image ) );
+				result = vandq_u32( result, vcltq_u32( vdupq_n_u32( view.mipBegin ), mipEnds ) );
+				result = vandq_u32( result, vcltq_u32( mipBegins, vdupq_n_u32( view.mipEnd ) ) );
+				result = vandq_u32( result, vcltq_u32( mipBegins, mipEnds ) );
+				result = vandq_u32( result, vcltq_u32( vdupq_n_u32( view.layerBegin ), layerEnds ) );
+				result = vandq_u32( result, vcltq_u32( layerBegins, vdupq_n_u32( view.layerEnd ) ) );
+				result = vandq_u32( result, vcltq_u32( layerBegins, layerEnds ) );
+				uint32_t const bits[4]{ 1u, 2u, 4u, 8u };
+				return vaddvq_u32( vandq_u32( result, vld1q_u32( bits ) ) );
+			}
+
+			uint32_t getMask( ViewRange const & view
+				, ViewRanges const & ranges
+				, size_t begin )
+			{
+				return getHalfMask( view, ranges, begin )
+					| ( getHalfMask( view, ranges, begin + 4u ) << 4u );
+			}
+
+#else
+
+			uint32_t getMask( ViewRange const & view
+				, ViewRanges const & ranges
+				, size_t begin )
+			{
+				return getOverlapMaskScalar( view, ranges, begin );
+			}
+
+#endif
+		}
+
+		uint32_t getOverlapMask( ViewRange const & view
+			, ViewRanges const & ranges
+			, size_t begin )
+		{
+			// The per range tests only check that the ranges are not empty, the view is checked once here.
+			return isEmpty( view )
+				? 0u
+				: getMask( view, ranges, begin );
+		}
+
+		uint32_t getOverlapMaskScalar( ViewRange const & view
+			, ViewRanges const & ranges
+			, size_t begin )
+		{
+			uint32_t result{};
+
+			for ( size_t index = 0u; index < OverlapBlockSize; ++index )
+			{
+				auto range = ViewRange{ ranges.getImages()[begin + index]
+					, ranges.getMipBegins()[begin + index]
+					, ranges.getMipEnds()[begin + index]
+					, ranges.getLayerBegins()[begin + index]
+					, ranges.getLayerEnds()[begin + index] };
+
+				if ( areOverlapping( view, range ) )
+				{
+					result |= 1u << index;
+				}
+			}
+
+			return result;
+		}
+	}
+}
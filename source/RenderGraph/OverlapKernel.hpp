@@ -0,0 +1,171 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/ImageViewData.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace crg
+{
+	namespace details
+	{
+		/**
+		*\brief
+		*	The number of views tested at once by getOverlapMask().
+		*/
+		static size_t constexpr OverlapBlockSize = 8u;
+		/**
+		*\return
+		*	The exclusive end of a range, saturated so that VK_REMAINING_* counts reach the end of the resource.
+		*/
+		inline uint32_t getRangeEnd( uint32_t begin
+			, uint32_t count )
+		{
+			return count > std::numeric_limits< uint32_t >::max() - begin
+				? std::numeric_limits< uint32_t >::max()
+				: begin + count;
+		}
+		/**
+		*\brief
+		*	The subresources of a view, as half-open mip and layer ranges.
+		*/
+		struct ViewRange
+		{
+			uint32_t image;
+			uint32_t mipBegin;
+			uint32_t mipEnd;
+			uint32_t layerBegin;
+			uint32_t layerEnd;
+		};
+
+		inline ViewRange getViewRange( ImageViewData const & data )
+		{
+			auto & range = data.subresourceRange;
+			return ViewRange{ data.image.id
+				, range.baseMipLevel
+				, getRangeEnd( range.baseMipLevel, range.levelCount )
+				, range.baseArrayLayer
+				, getRangeEnd( range.baseArrayLayer, range.layerCount ) };
+		}
+
+		inline bool areOverlapping( ViewRange const & lhs
+			, ViewRange const & rhs )
+		{
+			return lhs.image == rhs.image
+				&& std::max( lhs.mipBegin, rhs.mipBegin ) < std::min( lhs.mipEnd, rhs.mipEnd )
+				&& std::max( lhs.layerBegin, rhs.layerBegin ) < std::min( lhs.layerEnd, rhs.layerEnd );
+		}
+		/**
+		*\brief
+		*	View ranges, stored as a structure of arrays.
+		*\remarks
+		*	The arrays are padded with empty ranges up to a multiple of OverlapBlockSize,
+		*	so that getOverlapMask() always reads full blocks.
+		*/
+		class ViewRanges
+		{
+		public:
+			void push_back( ViewRange const & range )
+			{
+				if ( m_size % OverlapBlockSize == 0u )
+				{
+					auto size = m_size + OverlapBlockSize;
+					m_images.resize( size );
+					m_mipBegins.resize( size );
+					m_mipEnds.resize( size );
+					m_layerBegins.resize( size );
+					m_layerEnds.resize( size );
+				}
+
+				m_images[m_size] = range.image;
+				m_mipBegins[m_size] = range.mipBegin;
+				m_mipEnds[m_size] = range.mipEnd;
+				m_layerBegins[m_size] = range.layerBegin;
+				m_layerEnds[m_size] = range.layerEnd;
+				++m_size;
+			}
+
+			inline size_t size()const
+			{
+				return m_size;
+			}
+
+			inline uint32_t const * getImages()const
+			{
+				return m_images.data();
+			}
+
+			inline uint32_t const * getMipBegins()const
+			{
+				return m_mipBegins.data();
+			}
+
+			inline uint32_t const * getMipEnds()const
+			{
+				return m_mipEnds.data();
+			}
+
+			inline uint32_t const * getLayerBegins()const
+			{
+				return m_layerBegins.data();
+			}
+
+			inline uint32_t const * getLayerEnds()const
+			{
+				return m_layerEnds.data();
+			}
+
+		private:
+			std::vector< uint32_t > m_images;
+			std::vector< uint32_t > m_mipBegins;
+			std::vector< uint32_t > m_mipEnds;
+			std::vector< uint32_t > m_layerBegins;
+			std::vector< uint32_t > m_layerEnds;
+			size_t m_size{};
+		};
+		/**
+		*\brief
+		*	Tests a view against the block of OverlapBlockSize ranges starting at given index.
+		*\param[in] begin
+		*	A multiple of OverlapBlockSize, lower than ranges.size().
+		*\return
+		*	A mask with the bit N set if the view overlaps the range begin + N.
+		*/
+		uint32_t getOverlapMask( ViewRange const & view
+			, ViewRanges const & ranges
+			, size_t begin );
+		/**
+		*\brief
+		*	The portable version of getOverlapMask().
+		*/
+		uint32_t getOverlapMaskScalar( ViewRange const & view
+			, ViewRanges const & ranges
+			, size_t begin );
+		/**
+		*\brief
+		*	Calls given function with the index of each range overlapping the view, in increasing order.
+		*/
+		template< typename FuncT >
+		void forEachOverlap( ViewRange const & view
+			, ViewRanges const & ranges
+			, FuncT func )
+		{
+			for ( size_t begin = 0u; begin < ranges.size(); begin += OverlapBlockSize )
+			{
+				auto mask = getOverlapMask( view, ranges, begin );
+
+				for ( size_t index = begin; mask; ++index, mask >>= 1u )
+				{
+					if ( mask & 1u )
+					{
+						func( index );
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,632 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "PassComponents.hpp"
+
+#include "RenderGraph/RenderPass.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace crg
+{
+	namespace details
+	{
+		namespace
+		{
+			static uint32_t constexpr Unvisited = ~0u;
+
+			static size_t constexpr WordBits = 64u;
+
+			// Fills nexts with the components depending on given one, sorted and without duplicates.
+			void getNextComponents( PassComponents const & components
+				, std::vector< uint32_t > const & passComponents
+				, uint32_t component
+				, std::vector< uint32_t > & nexts )
+			{
+				nexts.clear();
+
+				for ( auto index = components.componentOffsets[component]; index < components.componentOffsets[component + 1u]; ++index )
+				{
+					auto pass = components.componentPasses[index];
+
+					for ( auto next = components.nextOffsets[pass]; next < components.nextOffsets[pass + 1u]; ++next )
+					{
+						auto dst = passComponents[components.dsts[components.nexts[next]]];
+
+						if ( dst != component )
+						{
+							nexts.push_back( dst );
+						}
+					}
+				}
+
+				std::sort( nexts.begin(), nexts.end() );
+				nexts.erase( std::unique( nexts.begin(), nexts.end() ), nexts.end() );
+			}
+
+			// Splits the components in chains, greedily following each one by its first next component which is not in a chain yet.
+			void buildChains( PassComponents const & components
+				, std::vector< uint32_t > const & passComponents
+				, PassReachability & result )
+			{
+				auto count = components.getComponentCount();
+				result.componentChains.resize( count, Unvisited );
+				result.chainPositions.resize( count, 0u );
+				std::vector< uint32_t > nexts;
+
+				for ( uint32_t component = 0u; component < count; ++component )
+				{
+					if ( result.componentChains[component] != Unvisited )
+					{
+						continue;
+					}
+
+					auto chain = result.chainCount++;
+					uint32_t position{};
+					auto current = component;
+
+					while ( current != Unvisited )
+					{
+						result.componentChains[current] = chain;
+						result.chainPositions[current] = position++;
+						getNextComponents( components, passComponents, current, nexts );
+						auto it = std::find_if( nexts.begin()
+							, nexts.end()
+							, [&result]( uint32_t next )
+							{
+								return result.componentChains[next] == Unvisited;
+							} );
+						current = it == nexts.end()
+							? Unvisited
+							: *it;
+					}
+				}
+			}
+
+			void buildComponentAdjacency( PassComponents const & components
+				, std::vector< uint32_t > const & passComponents
+				, PassReachability & result )
+			{
+				auto count = components.getComponentCount();
+				result.nextOffsets.resize( count + 1u, 0u );
+				result.nexts.reserve( components.nexts.size() );
+				std::vector< uint32_t > nexts;
+
+				for ( uint32_t component = 0u; component < count; ++component )
+				{
+					result.nextOffsets[component] = uint32_t( result.nexts.size() );
+					getNextComponents( components, passComponents, component, nexts );
+
+					if ( components.getComponentSize( component ) > 1u )
+					{
+						result.nexts.push_back( component );
+					}
+
+					result.nexts.insert( result.nexts.end(), nexts.begin(), nexts.end() );
+				}
+
+				result.nextOffsets[count] = uint32_t( result.nexts.size() );
+			}
+
+			// The rows of each representation are built in reverse topological order,
+			// a row being first filled with what is reached through its next components,
+			// so that a next component already in it is reached through a lower numbered one.
+			struct MatrixRows
+			{
+				PassReachability & reachability;
+
+				uint64_t * getRow( uint32_t component )
+				{
+					return reachability.bits.data() + size_t( component ) * reachability.wordCount;
+				}
+
+				bool contains( uint32_t component
+					, uint32_t other )
+				{
+					return ( getRow( component )[other / WordBits] >> ( other % WordBits ) ) & 1u;
+				}
+
+				void add( uint32_t component
+					, uint32_t other )
+				{
+					getRow( component )[other / WordBits] |= uint64_t( 1u ) << ( other % WordBits );
+				}
+
+				void merge( uint32_t component
+					, uint32_t next
+					, uint32_t )
+				{
+					// A component only reaches higher numbered ones, so the lower words are empty.
+					auto bits = getRow( component );
+					auto nextBits = getRow( next );
+
+					for ( auto word = next / WordBits; word < reachability.wordCount; ++word )
+					{
+						bits[word] |= nextBits[word];
+					}
+
+					add( component, next );
+				}
+			};
+
+			struct ChainRows
+			{
+				PassReachability & reachability;
+
+				uint32_t * getRow( uint32_t component )
+				{
+					return reachability.chainReaches.data() + size_t( component ) * reachability.chainCount;
+				}
+
+				bool contains( uint32_t component
+					, uint32_t other )
+				{
+					return getRow( component )[reachability.componentChains[other]] <= reachability.chainPositions[other];
+				}
+
+				void add( uint32_t component
+					, uint32_t other )
+				{
+					auto & position = getRow( component )[reachability.componentChains[other]];
+					position = std::min( position, reachability.chainPositions[other] );
+				}
+
+				void merge( uint32_t component
+					, uint32_t next
+					, uint32_t )
+				{
+					auto positions = getRow( component );
+					auto nextPositions = getRow( next );
+
+					for ( uint32_t chain = 0u; chain < reachability.chainCount; ++chain )
+					{
+						positions[chain] = std::min( positions[chain], nextPositions[chain] );
+					}
+
+					add( component, next );
+				}
+			};
+
+			struct SearchRows
+			{
+				PassReachability & reachability;
+				// The component for which each component was last marked as reached.
+				std::vector< uint32_t > marks;
+				std::vector< uint32_t > stack;
+
+				bool contains( uint32_t component
+					, uint32_t other )
+				{
+					return marks[other] == component;
+				}
+
+				void add( uint32_t
+					, uint32_t )
+				{
+					// The cycles are already in the components adjacency.
+				}
+
+				// Only the components up to last are searched, since the higher ones can't be next components.
+				void merge( uint32_t component
+					, uint32_t next
+					, uint32_t last )
+				{
+					marks[next] = component;
+					stack.push_back( next );
+
+					while ( !stack.empty() )
+					{
+						auto current = stack.back();
+						stack.pop_back();
+
+						for ( auto index = reachability.nextOffsets[current]; index < reachability.nextOffsets[current + 1u]; ++index )
+						{
+							auto other = reachability.nexts[index];
+
+							if ( other <= last
+								&& marks[other] != component )
+							{
+								marks[other] = component;
+								stack.push_back( other );
+							}
+						}
+					}
+				}
+			};
+
+			template< typename RowsT >
+			void reduceDependencies( RenderPassDependenciesArray & dependencies
+				, PassComponents const & components
+				, std::vector< uint32_t > const & passComponents
+				, RowsT & rows )
+			{
+				std::vector< uint32_t > nexts;
+
+				// A component only reaches higher numbered ones, so they are processed first.
+				for ( auto component = components.getComponentCount(); component > 0u; )
+				{
+					--component;
+					getNextComponents( components, passComponents, component, nexts );
+					// The redundant next components are moved to the beginning of nexts.
+					auto redundantsEnd = nexts.begin();
+
+					for ( auto next : nexts )
+					{
+						if ( rows.contains( component, next ) )
+						{
+							*redundantsEnd++ = next;
+						}
+						else
+						{
+							rows.merge( component, next, nexts.back() );
+						}
+					}
+
+					if ( components.getComponentSize( component ) > 1u )
+					{
+						rows.add( component, component );
+					}
+
+					for ( auto index = components.componentOffsets[component]; index < components.componentOffsets[component + 1u]; ++index )
+					{
+						auto pass = components.componentPasses[index];
+
+						for ( auto next = components.nextOffsets[pass]; next < components.nextOffsets[pass + 1u]; ++next )
+						{
+							auto dependency = components.nexts[next];
+							dependencies[dependency].redundant = std::binary_search( nexts.begin()
+								, redundantsEnd
+								, passComponents[components.dsts[dependency]] );
+						}
+					}
+				}
+			}
+
+			void buildAdjacency( RenderPassPtrArray const & passes
+				, RenderPassDependenciesArray const & dependencies
+				, PassComponents & result )
+			{
+				std::unordered_map< RenderPass const *, uint32_t > indices;
+				indices.reserve( passes.size() );
+
+				for ( auto & pass : passes )
+				{
+					indices.emplace( pass.get(), uint32_t( indices.size() ) );
+				}
+
+				result.srcs.reserve( dependencies.size() );
+				result.dsts.reserve( dependencies.size() );
+				result.nextOffsets.resize( passes.size() + 1u, 0u );
+
+				for ( auto & dependency : dependencies )
+				{
+					auto src = indices[dependency.srcPass];
+					result.srcs.push_back( src );
+					result.dsts.push_back( indices[dependency.dstPass] );
+					++result.nextOffsets[src];
+				}
+
+				// Each offset is first the end of the pass dependencies, then moved to their beginning
+				// while they are filled backwards, so that they are kept in the dependencies order.
+				for ( size_t index = 1u; index < result.nextOffsets.size(); ++index )
+				{
+					result.nextOffsets[index] += result.nextOffsets[index - 1u];
+				}
+
+				result.nexts.resize( dependencies.size() );
+
+				for ( auto index = uint32_t( dependencies.size() ); index > 0u; --index )
+				{
+					result.nexts[--result.nextOffsets[result.srcs[index - 1u]]] = index - 1u;
+				}
+			}
+		}
+
+		PassComponents findPassComponents( RenderPassPtrArray const & passes
+			, RenderPassDependenciesArray const & dependencies )
+		{
+			PassComponents result;
+			buildAdjacency( passes, dependencies, result );
+
+			// The depth first search state of each pass, the search path being linked through the parents.
+			struct Visit
+			{
+				uint32_t index;
+				uint32_t lowLink;
+				uint32_t next;
+				uint32_t parent;
+			};
+			auto count = uint32_t( passes.size() );
+			std::vector< Visit > visits( count, Visit{ Unvisited, Unvisited, 0u, Unvisited } );
+			uint32_t visitIndex{};
+			// The Tarjan stack grows from the beginning of componentPasses, while the components
+			// are written from its end, since they are found in reverse topological order.
+			result.componentPasses.resize( count );
+			uint32_t stackSize{};
+			uint32_t componentsBegin{ count };
+			// The passes which are visited but have no component yet are the ones on the stack.
+			result.passComponents.resize( count, Unvisited );
+			result.componentOffsets.reserve( count + 1u );
+			auto visit = [&]( uint32_t pass
+				, uint32_t parent )
+			{
+				visits[pass] = { visitIndex, visitIndex, result.nextOffsets[pass], parent };
+				++visitIndex;
+				result.componentPasses[stackSize++] = pass;
+			};
+
+			for ( uint32_t root = 0u; root < count; ++root )
+			{
+				if ( visits[root].index != Unvisited )
+				{
+					continue;
+				}
+
+				visit( root, Unvisited );
+				auto pass = root;
+
+				while ( pass != Unvisited )
+				{
+					auto & current = visits[pass];
+
+					if ( current.next < result.nextOffsets[pass + 1u] )
+					{
+						auto next = result.dsts[result.nexts[current.next++]];
+
+						if ( visits[next].index == Unvisited )
+						{
+							visit( next, pass );
+							pass = next;
+						}
+						else if ( result.passComponents[next] == Unvisited )
+						{
+							current.lowLink = std::min( current.lowLink, visits[next].index );
+						}
+
+						continue;
+					}
+
+					if ( current.lowLink == current.index )
+					{
+						// The pass is the root of a component, which passes are the ones above it on the stack.
+						auto component = uint32_t( result.componentOffsets.size() );
+						uint32_t member;
+
+						do
+						{
+							member = result.componentPasses[--stackSize];
+							result.passComponents[member] = component;
+							result.componentPasses[--componentsBegin] = member;
+						}
+						while ( member != pass );
+
+						result.componentOffsets.push_back( componentsBegin );
+					}
+
+					pass = current.parent;
+
+					if ( pass != Unvisited )
+					{
+						visits[pass].lowLink = std::min( visits[pass].lowLink, current.lowLink );
+					}
+				}
+			}
+
+			// Renumber the components in topological order, which is the order of their passes in componentPasses.
+			auto last = uint32_t( result.componentOffsets.size() ) - 1u;
+			std::reverse( result.componentOffsets.begin(), result.componentOffsets.end() );
+			result.componentOffsets.push_back( count );
+
+			for ( auto & component : result.passComponents )
+			{
+				component = last - component;
+			}
+
+			for ( uint32_t component = 0u; component < result.getComponentCount(); ++component )
+			{
+				std::sort( result.componentPasses.begin() + result.componentOffsets[component]
+					, result.componentPasses.begin() + result.componentOffsets[component + 1u] );
+			}
+
+			return result;
+		}
+
+		RenderPassCycleArray buildCycles( RenderPassPtrArray const & passes
+			, RenderPassDependenciesArray const & dependencies
+			, PassComponents const & components )
+		{
+			RenderPassCycleArray result;
+
+			if ( components.getComponentCount() == passes.size() )
+			{
+				return result;
+			}
+
+			std::vector< uint32_t > cycles( components.getComponentCount(), Unvisited );
+
+			for ( uint32_t component = 0u; component < components.getComponentCount(); ++component )
+			{
+				if ( components.getComponentSize( component ) > 1u )
+				{
+					cycles[component] = uint32_t( result.size() );
+					result.emplace_back();
+					auto & cycle = result.back();
+
+					for ( auto index = components.componentOffsets[component]; index < components.componentOffsets[component + 1u]; ++index )
+					{
+						cycle.passes.push_back( passes[components.componentPasses[index]].get() );
+					}
+				}
+			}
+
+			for ( uint32_t index = 0u; index < dependencies.size(); ++index )
+			{
+				auto component = components.passComponents[components.srcs[index]];
+
+				if ( component == components.passComponents[components.dsts[index]] )
+				{
+					result[cycles[component]].dependencies.push_back( dependencies[index] );
+				}
+			}
+
+			return result;
+		}
+
+		PassReachability buildReachability( RenderPassDependenciesArray & dependencies
+			, PassComponents components
+			, size_t maxSize )
+		{
+			PassReachability result;
+			auto count = components.getComponentCount();
+			result.componentCount = count;
+			result.passComponents = std::move( components.passComponents );
+			result.wordCount = uint32_t( ( count + WordBits - 1u ) / WordBits );
+
+			if ( size_t( count ) * result.wordCount * sizeof( uint64_t ) <= maxSize )
+			{
+				result.mode = ReachabilityMode::Matrix;
+				result.bits.resize( size_t( count ) * result.wordCount, 0u );
+				MatrixRows rows{ result };
+				reduceDependencies( dependencies, components, result.passComponents, rows );
+				return result;
+			}
+
+			result.wordCount = 0u;
+			buildChains( components, result.passComponents, result );
+
+			if ( size_t( count ) * result.chainCount * sizeof( uint32_t ) <= maxSize )
+			{
+				result.mode = ReachabilityMode::Chains;
+				result.chainReaches.resize( size_t( count ) * result.chainCount, Unvisited );
+				ChainRows rows{ result };
+				reduceDependencies( dependencies, components, result.passComponents, rows );
+				return result;
+			}
+
+			result.mode = ReachabilityMode::Search;
+			result.chainCount = 0u;
+			result.componentChains = {};
+			result.chainPositions = {};
+			buildComponentAdjacency( components, result.passComponents, result );
+			SearchRows rows{ result, std::vector< uint32_t >( count, Unvisited ), {} };
+			reduceDependencies( dependencies, components, result.passComponents, rows );
+			return result;
+		}
+
+		RenderPassArray sortPasses( RenderPassPtrArray const & passes
+			, PassComponents const & components )
+		{
+			using IndexQueue = std::priority_queue< uint32_t, std::vector< uint32_t >, std::greater< uint32_t > >;
+			auto & passComponents = components.passComponents;
+			auto hasCycles = components.getComponentCount() < passes.size();
+			// The dependencies from other components, and for the passes in cycles, the ones inside their component.
+			std::vector< uint32_t > componentInDegrees( components.getComponentCount(), 0u );
+			std::vector< uint32_t > inDegrees( hasCycles ? passes.size() : 0u, 0u );
+
+			for ( uint32_t index = 0u; index < components.srcs.size(); ++index )
+			{
+				auto dst = components.dsts[index];
+
+				if ( passComponents[components.srcs[index]] == passComponents[dst] )
+				{
+					++inDegrees[dst];
+				}
+				else
+				{
+					++componentInDegrees[passComponents[dst]];
+				}
+			}
+
+			// Ready components, by their first pass index.
+			std::vector< uint32_t > readyStorage;
+			readyStorage.reserve( componentInDegrees.size() );
+			IndexQueue ready{ std::greater< uint32_t >{}, std::move( readyStorage ) };
+
+			for ( uint32_t component = 0u; component < componentInDegrees.size(); ++component )
+			{
+				if ( !componentInDegrees[component] )
+				{
+					ready.push( components.componentPasses[components.componentOffsets[component]] );
+				}
+			}
+
+			RenderPassArray result;
+			result.reserve( passes.size() );
+			std::vector< bool > sorted( inDegrees.size(), false );
+			IndexQueue cycleReady;
+			auto addPass = [&]( uint32_t index )
+			{
+				result.push_back( passes[index].get() );
+				auto component = passComponents[index];
+
+				for ( auto next = components.nextOffsets[index]; next < components.nextOffsets[index + 1u]; ++next )
+				{
+					auto dst = components.dsts[components.nexts[next]];
+					auto dstComponent = passComponents[dst];
+
+					if ( dstComponent != component )
+					{
+						// The ready components are only processed once this one is fully sorted.
+						if ( !--componentInDegrees[dstComponent] )
+						{
+							ready.push( components.componentPasses[components.componentOffsets[dstComponent]] );
+						}
+					}
+					else if ( !sorted[dst]
+						&& inDegrees[dst]
+						&& !--inDegrees[dst] )
+					{
+						cycleReady.push( dst );
+					}
+				}
+			};
+
+			while ( !ready.empty() )
+			{
+				auto first = ready.top();
+				ready.pop();
+				auto component = passComponents[first];
+
+				if ( components.getComponentSize( component ) == 1u )
+				{
+					addPass( first );
+					continue;
+				}
+
+				// Only loops remain in the component, break them at its first registered pass which is not sorted yet.
+				auto cursor = components.componentOffsets[component];
+				auto end = result.size() + components.getComponentSize( component );
+
+				while ( result.size() < end )
+				{
+					if ( cycleReady.empty() )
+					{
+						while ( sorted[components.componentPasses[cursor]] )
+						{
+							++cursor;
+						}
+
+						auto index = components.componentPasses[cursor];
+						inDegrees[index] = 0u;
+						cycleReady.push( index );
+					}
+
+					auto index = cycleReady.top();
+					cycleReady.pop();
+
+					if ( !sorted[index] )
+					{
+						sorted[index] = true;
+						addPass( index );
+					}
+				}
+			}
+
+			return result;
+		}
+	}
+}
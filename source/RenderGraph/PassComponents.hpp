@@ -0,0 +1,79 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/PassReachability.hpp"
+#include "RenderGraph/RenderPassDependencies.hpp"
+
+namespace crg
+{
+	namespace details
+	{
+		/**
+		*\brief
+		*	The dependencies between passes, by pass index, and their strongly connected components.
+		*\remarks
+		*	Components are numbered in topological order: the passes of a component only depend
+		*	on the passes of the same component, and on the ones of lower numbered components.
+		*/
+		struct PassComponents
+		{
+			// The source and destination pass of each dependency.
+			std::vector< uint32_t > srcs;
+			std::vector< uint32_t > dsts;
+			// The dependencies for which pass N is the source are nexts[nextOffsets[N]] to nexts[nextOffsets[N + 1] - 1].
+			std::vector< uint32_t > nextOffsets;
+			std::vector< uint32_t > nexts;
+			// The component of each pass.
+			std::vector< uint32_t > passComponents;
+			// The passes of component N, in registration order, are componentPasses[componentOffsets[N]] to componentPasses[componentOffsets[N + 1] - 1].
+			std::vector< uint32_t > componentOffsets;
+			std::vector< uint32_t > componentPasses;
+
+			inline uint32_t getComponentCount()const
+			{
+				return uint32_t( componentOffsets.size() - 1u );
+			}
+
+			inline uint32_t getComponentSize( uint32_t component )const
+			{
+				return componentOffsets[component + 1u] - componentOffsets[component];
+			}
+		};
+		/**
+		*\brief
+		*	Finds the strongly connected components of the passes, using Tarjan's algorithm, in O(passes + dependencies).
+		*/
+		PassComponents findPassComponents( RenderPassPtrArray const & passes
+			, RenderPassDependenciesArray const & dependencies );
+		/**
+		*\return
+		*	The components holding more than one pass, with the dependencies between their passes.
+		*/
+		RenderPassCycleArray buildCycles( RenderPassPtrArray const & passes
+			, RenderPassDependenciesArray const & dependencies
+			, PassComponents const & components );
+		/**
+		*\brief
+		*	Computes the components reachable from each component, and marks as redundant the dependencies
+		*	between components which are already ordered through other components.
+		*\remarks
+		*	This is the transitive reduction of the components graph, the dependencies inside a cycle being all kept.
+		*	The representation is the matrix if it fits in maxSize bytes, the chains if they fit, the search otherwise.
+		*/
+		PassReachability buildReachability( RenderPassDependenciesArray & dependencies
+			, PassComponents components
+			, size_t maxSize );
+		/**
+		*\brief
+		*	Sorts the passes so that each pass comes after the passes it depends on.
+		*\remarks
+		*	Ready components are processed by registration order of their first pass, to keep the result deterministic.
+		*	The passes of a cycle are kept together, the cycle being broken at its first registered pass.
+		*/
+		RenderPassArray sortPasses( RenderPassPtrArray const & passes
+			, PassComponents const & components );
+	}
+}
@@ -0,0 +1,56 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/PassReachability.hpp"
+
+namespace crg
+{
+	bool PassReachability::reachesComponent( uint32_t src
+		, uint32_t dst )const
+	{
+		// Components only reach higher numbered ones, or themselves when they are a cycle.
+		if ( src > dst )
+		{
+			return false;
+		}
+
+		switch ( mode )
+		{
+		case ReachabilityMode::Matrix:
+			return ( bits[src * wordCount + dst / 64u] >> ( dst % 64u ) ) & 1u;
+		case ReachabilityMode::Chains:
+			return chainReaches[src * chainCount + componentChains[dst]] <= chainPositions[dst];
+		default:
+			break;
+		}
+
+		// The components higher than dst can't lead to it, so they are not visited.
+		std::vector< bool > visited( dst - src + 1u, false );
+		std::vector< uint32_t > stack{ src };
+
+		while ( !stack.empty() )
+		{
+			auto component = stack.back();
+			stack.pop_back();
+
+			for ( auto index = nextOffsets[component]; index < nextOffsets[component + 1u]; ++index )
+			{
+				auto next = nexts[index];
+
+				if ( next == dst )
+				{
+					return true;
+				}
+
+				if ( next < dst && !visited[next - src] )
+				{
+					visited[next - src] = true;
+					stack.push_back( next );
+				}
+			}
+		}
+
+		return false;
+	}
+}
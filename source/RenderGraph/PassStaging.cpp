@@ -0,0 +1,58 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/PassStaging.hpp"
+
+namespace crg
+{
+	namespace
+	{
+		template< typename DataT >
+		Id< DataT > getStagedId( std::vector< DataT > const & values
+			, uint32_t index )
+		{
+			return Id< DataT >{ uint32_t( values.size() ), PassStaging::StagedGeneration | index };
+		}
+	}
+
+	PassStaging::PassStaging( std::string name
+		, uint32_t index )
+		: m_name{ std::move( name ) }
+		, m_index{ index }
+	{
+	}
+
+	ImageId PassStaging::createImage( ImageData const & img )
+	{
+		m_images.push_back( img );
+		return getStagedId( m_images, m_index );
+	}
+
+	ImageViewId PassStaging::createView( ImageViewData const & view )
+	{
+		m_views.push_back( view );
+		return getStagedId( m_views, m_index );
+	}
+
+	BufferId PassStaging::createBuffer( BufferData const & buffer )
+	{
+		m_buffers.push_back( buffer );
+		return getStagedId( m_buffers, m_index );
+	}
+
+	void PassStaging::add( RenderPass const & pass )
+	{
+		m_passes.push_back( std::make_unique< RenderPass >( pass ) );
+		m_passArray.push_back( m_passes.back().get() );
+	}
+
+	void PassStaging::clear()
+	{
+		m_images.clear();
+		m_views.clear();
+		m_buffers.clear();
+		m_passes.clear();
+		m_passArray.clear();
+	}
+}
@@ -0,0 +1,72 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "RenderGraph/CompileStats.hpp"
+
+namespace crg
+{
+	namespace details
+	{
+		/**
+		*\brief
+		*	The stats being filled by a compilation, nullptr when they are disabled.
+		*/
+		struct StatsCollector
+		{
+			CompileStats & stats;
+			AllocationCounter const & allocationCounter;
+
+			inline AllocationCount getAllocations()const
+			{
+				return allocationCounter
+					? allocationCounter()
+					: AllocationCount{};
+			}
+		};
+		/**
+		*\brief
+		*	Measures the wall time and allocations of a compilation phase, for its lifetime.
+		*	Does nothing when the collector is null.
+		*/
+		class PhaseTimer
+		{
+		public:
+			PhaseTimer( StatsCollector * collector
+				, CompilePhase phase )
+				: m_collector{ collector }
+				, m_phase{ phase }
+			{
+				if ( m_collector )
+				{
+					m_allocations = m_collector->getAllocations();
+					m_begin = std::chrono::steady_clock::now();
+				}
+			}
+
+			~PhaseTimer()
+			{
+				if ( m_collector )
+				{
+					auto end = std::chrono::steady_clock::now();
+					auto & stats = m_collector->stats;
+					stats.phaseTimes[size_t( m_phase )] += std::chrono::duration_cast< std::chrono::nanoseconds >( end - m_begin );
+					auto allocations = m_collector->getAllocations();
+					stats.phaseAllocations[size_t( m_phase )] += allocations.allocations - m_allocations.allocations;
+					stats.phaseAllocatedBytes[size_t( m_phase )] += allocations.bytes - m_allocations.bytes;
+				}
+			}
+
+			PhaseTimer( PhaseTimer const & ) = delete;
+			PhaseTimer & operator=( PhaseTimer const & ) = delete;
+
+		private:
+			StatsCollector * m_collector;
+			CompilePhase m_phase;
+			AllocationCount m_allocations;
+			std::chrono::steady_clock::time_point m_begin;
+		};
+	}
+}
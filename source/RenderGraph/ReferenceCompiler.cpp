@@ -0,0 +1,802 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "ReferenceCompiler.hpp"
+#include "RenderPassDependenciesBuilder.hpp"
+
+#include "RenderGraph/BufferAttachment.hpp"
+#include "RenderGraph/Exception.hpp"
+#include "RenderGraph/RenderPass.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace crg
+{
+	namespace details
+	{
+		namespace reference
+		{
+			AttachmentTransitionArray mergeIdenticalTransitions( AttachmentTransitionArray transitions )
+			{
+				AttachmentTransitionArray result;
+				auto findSrcAttach = [&result]( auto it )
+				{
+					return std::find_if( result.begin()
+						, result.end()
+						, [&it]( AttachmentTransition const & lookup )
+						{
+							return lookup.srcOutputs.front().attachment == it->srcOutputs.front().attachment
+								&& lookup.dstInput.attachment == it->dstInput.attachment;
+						} );
+				};
+				auto it = transitions.begin();
+
+				while ( it != transitions.end() )
+				{
+					auto itr = findSrcAttach( it );
+
+					if ( itr == result.end() )
+					{
+						result.push_back( std::move( *it ) );
+						++it;
+					}
+					else
+					{
+						for ( auto pass : it->srcOutputs.front().passes )
+						{
+							itr->srcOutputs.front().passes.insert( pass );
+						}
+
+						for ( auto pass : it->dstInput.passes )
+						{
+							itr->dstInput.passes.insert( pass );
+						}
+
+						it = transitions.erase( it );
+					}
+				}
+
+				return result;
+			}
+
+			AttachmentTransitionArray mergeTransitionsPerInput( AttachmentTransitionArray transitions )
+			{
+				AttachmentTransitionArray result;
+				auto findSrcAttach = [&result]( auto it )
+				{
+					return std::find_if( result.begin()
+						, result.end()
+						, [&it]( AttachmentTransition const & lookup )
+						{
+							return lookup.dstInput.attachment == it->dstInput.attachment;
+						} );
+				};
+				auto it = transitions.begin();
+
+				while ( it != transitions.end() )
+				{
+					auto itr = findSrcAttach( it );
+
+					if ( itr == result.end() )
+					{
+						result.push_back( std::move( *it ) );
+						++it;
+					}
+					else
+					{
+						itr->srcOutputs.insert( itr->srcOutputs.end()
+							, it->srcOutputs.begin()
+							, it->srcOutputs.end() );
+						it = transitions.erase( it );
+					}
+				}
+
+				return result;
+			}
+
+			AttachmentTransitionArray reduceDirectPaths( AttachmentTransitionArray transitions )
+			{
+				for ( auto & transition : transitions )
+				{
+					if ( transition.dstInput.attachment.isSampled() )
+					{
+						auto passIt = transition.dstInput.passes.begin();
+
+						while ( passIt != transition.dstInput.passes.end() )
+						{
+							auto inputPass = *passIt;
+							auto it = std::find( inputPass->sampled.begin()
+								, inputPass->sampled.end()
+								, transition.dstInput.attachment );
+
+							if ( it == inputPass->sampled.end() )
+							{
+								passIt = transition.dstInput.passes.erase( passIt );
+							}
+							else
+							{
+								++passIt;
+							}
+						}
+					}
+				}
+
+				return transitions;
+			}
+
+			struct PassAttach
+			{
+				Attachment const attach;
+				std::set< RenderPass const * > passes{};
+			};
+
+			using PassAttachCont = std::vector< PassAttach >;
+
+			inline bool areOverlapping( RenderGraph const & graph
+				, ImageViewId const & lhs
+				, ImageViewId const & rhs )
+			{
+				auto & lhsData = graph.getView( lhs );
+				auto & rhsData = graph.getView( rhs );
+				return lhsData.image == rhsData.image
+					&& areIntersecting( lhsData.subresourceRange
+						, rhsData.subresourceRange );
+			}
+
+			void processAttach( Attachment const & attach
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats
+				, std::function< bool( Attachment const & ) > processAttach )
+			{
+				if ( stats )
+				{
+					stats->stats.overlapTests += cont.size();
+				}
+
+				for ( auto & lookup : cont )
+				{
+					if ( processAttach( lookup.attach ) )
+					{
+						if ( lookup.passes.end() == std::find( lookup.passes.begin()
+							, lookup.passes.end()
+							, &pass ) )
+						{
+							lookup.passes.insert( &pass );
+						}
+					}
+				}
+
+				auto it = std::find_if( cont.begin()
+					, cont.end()
+					, [&attach]( PassAttach const & lookup )
+					{
+						return lookup.attach.name == attach.name
+							&& lookup.attach.view == attach.view;
+					} );
+
+				if ( cont.end() == it )
+				{
+					cont.push_back( PassAttach{ attach } );
+					it = std::prev( cont.end() );
+				}
+
+				it->passes.insert( &pass );
+			}
+
+			void processSampledAttach( RenderGraph const & graph
+				, Attachment const & attach
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				if ( attach.isSampled() )
+				{
+					processAttach( attach
+						, pass
+						, cont
+						, stats
+						, [&graph, &attach]( Attachment const & lookup )
+						{
+							return areOverlapping( graph, lookup.view, attach.view );
+						} );
+				}
+			}
+
+			void processColourInputAttach( RenderGraph const & graph
+				, Attachment const & attach
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				if ( attach.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD )
+				{
+					processAttach( attach
+						, pass
+						, cont
+						, stats
+						, [&graph, &attach]( Attachment const & lookup )
+						{
+							return areOverlapping( graph, lookup.view, attach.view );
+						} );
+				}
+			}
+
+			void processColourOutputAttach( RenderGraph const & graph
+				, Attachment const & attach
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				if ( attach.storeOp == VK_ATTACHMENT_STORE_OP_STORE )
+				{
+					return processAttach( attach
+						, pass
+						, cont
+						, stats
+						, [&graph, &attach]( Attachment const & lookup )
+						{
+							return areOverlapping( graph, lookup.view, attach.view );
+						} );
+				}
+			}
+
+			void processDepthStencilInputAttach( RenderGraph const & graph
+				, Attachment const & attach
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				if ( attach.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD
+					|| attach.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD )
+				{
+					processAttach( attach
+						, pass
+						, cont
+						, stats
+						, [&graph, &attach]( Attachment const & lookup )
+						{
+							return areOverlapping( graph, lookup.view, attach.view );
+						} );
+				}
+			}
+
+			void processDepthStencilOutputAttach( RenderGraph const & graph
+				, Attachment const & attach
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				if ( attach.storeOp == VK_ATTACHMENT_STORE_OP_STORE
+					|| attach.stencilStoreOp == VK_ATTACHMENT_STORE_OP_STORE )
+				{
+					processAttach( attach
+						, pass
+						, cont
+						, stats
+						, [&graph, &attach]( Attachment const & lookup )
+						{
+							return areOverlapping( graph, lookup.view, attach.view );
+						} );
+				}
+			}
+
+			void processSampledAttachs( RenderGraph const & graph
+				, AttachmentArray const & attachs
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				for ( auto & attach : attachs )
+				{
+					processSampledAttach( graph, attach, pass, cont, stats );
+				}
+			}
+
+			void processColourInputAttachs( RenderGraph const & graph
+				, AttachmentArray const & attachs
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				for ( auto & attach : attachs )
+				{
+					processColourInputAttach( graph, attach, pass, cont, stats );
+				}
+			}
+
+			void processColourOutputAttachs( RenderGraph const & graph
+				, AttachmentArray const & attachs
+				, RenderPass const & pass
+				, PassAttachCont & cont
+				, StatsCollector * stats )
+			{
+				for ( auto & attach : attachs )
+				{
+					processColourOutputAttach( graph, attach, pass, cont, stats );
+				}
+			}
+
+			void addDependency( Attachment const & outAttach
+				, Attachment const & inAttach
+				, std::set< RenderPass const * > const & srcs
+				, std::set< RenderPass const * > const & dsts
+				, RenderPassDependenciesArray & dependencies )
+			{
+				for ( auto & src : srcs )
+				{
+					for ( auto & dst : dsts )
+					{
+						if ( src != dst )
+						{
+							auto it = std::find_if( dependencies.begin()
+								, dependencies.end()
+								, [&dst, &src]( RenderPassDependencies & lookup )
+								{
+									return lookup.srcPass == src
+										&& lookup.dstPass == dst;
+								} );
+
+							if ( it == dependencies.end() )
+							{
+								dependencies.push_back( { src, dst } );
+								it = std::prev( dependencies.end() );
+							}
+
+							auto & dep = *it;
+
+							if ( dep.srcOutputs.end() == std::find( dep.srcOutputs.begin()
+									, dep.srcOutputs.end()
+									, outAttach )
+								|| dep.dstInputs.end() == std::find( dep.dstInputs.begin()
+									, dep.dstInputs.end()
+									, inAttach ) )
+							{
+								dep.srcOutputs.push_back( outAttach );
+								dep.dstInputs.push_back( inAttach );
+							}
+						}
+					}
+				}
+			}
+
+			struct PassBufferAttach
+			{
+				RenderPass const * pass;
+				BufferAttachment const * attach;
+			};
+
+			void addBufferDependency( PassBufferAttach const & src
+				, PassBufferAttach const & dst
+				, RenderPassDependenciesArray & dependencies )
+			{
+				auto it = std::find_if( dependencies.begin()
+					, dependencies.end()
+					, [&src, &dst]( RenderPassDependencies & lookup )
+					{
+						return lookup.srcPass == src.pass
+							&& lookup.dstPass == dst.pass;
+					} );
+
+				if ( it == dependencies.end() )
+				{
+					dependencies.push_back( { src.pass, dst.pass } );
+					it = std::prev( dependencies.end() );
+				}
+
+				it->srcBufferOutputs.push_back( *src.attach );
+				it->dstBufferInputs.push_back( *dst.attach );
+			}
+
+			bool isWrittenBefore( RenderGraph const & graph
+				, std::vector< PassBufferAttach > const & attaches
+				, size_t index )
+			{
+				auto & read = attaches[index];
+
+				for ( size_t lookup = 0u; lookup < index; ++lookup )
+				{
+					auto & write = attaches[lookup];
+
+					if ( write.pass != read.pass
+						&& write.attach->isWrite()
+						&& details::areOverlapping( graph, *write.attach, *read.attach ) )
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			void buildBufferDependencies( RenderGraph const & graph
+				, std::vector< RenderPassPtr > const & passes
+				, RenderPassDependenciesArray & dependencies )
+			{
+				std::map< BufferId, std::vector< PassBufferAttach > > buffers;
+
+				for ( auto & pass : passes )
+				{
+					for ( auto & attach : pass->buffers )
+					{
+						buffers[attach.buffer].push_back( { pass.get(), &attach } );
+					}
+				}
+
+				for ( auto & buffer : buffers )
+				{
+					auto & attaches = buffer.second;
+
+					for ( size_t dstIndex = 0u; dstIndex < attaches.size(); ++dstIndex )
+					{
+						auto & dst = attaches[dstIndex];
+
+						for ( size_t srcIndex = 0u; srcIndex < dstIndex; ++srcIndex )
+						{
+							auto & src = attaches[srcIndex];
+
+							if ( src.pass == dst.pass
+								|| !details::areOverlapping( graph, *src.attach, *dst.attach ) )
+							{
+								continue;
+							}
+
+							if ( src.attach->isWrite() )
+							{
+								// Read or write after write.
+								addBufferDependency( src, dst, dependencies );
+							}
+							else if ( dst.attach->isWrite() )
+							{
+								// Write after read, or a read of what the later write produces.
+								if ( isWrittenBefore( graph, attaches, srcIndex ) )
+								{
+									addBufferDependency( src, dst, dependencies );
+								}
+								else
+								{
+									addBufferDependency( dst, src, dependencies );
+								}
+							}
+						}
+					}
+				}
+			}
+
+			RenderPassDependenciesArray buildPassDependencies( RenderGraph const & graph
+				, RenderPassPtrArray const & passes
+				, StatsCollector * stats )
+			{
+				PassAttachCont sampled;
+				PassAttachCont inputs;
+				PassAttachCont outputs;
+
+				for ( auto & pass : passes )
+				{
+					processSampledAttachs( graph, pass->sampled, *pass, sampled, stats );
+					processColourInputAttachs( graph, pass->colourInOuts, *pass, inputs, stats );
+					processColourOutputAttachs( graph, pass->colourInOuts, *pass, outputs, stats );
+					// Storage images and transfer attachments follow the same load/store rules as colour ones.
+					processColourInputAttachs( graph, pass->storages, *pass, inputs, stats );
+					processColourOutputAttachs( graph, pass->storages, *pass, outputs, stats );
+					processColourInputAttachs( graph, pass->transfers, *pass, inputs, stats );
+					processColourOutputAttachs( graph, pass->transfers, *pass, outputs, stats );
+
+					if ( pass->depthStencilInOut )
+					{
+						processDepthStencilInputAttach( graph, *pass->depthStencilInOut, *pass, inputs, stats );
+						processDepthStencilOutputAttach( graph, *pass->depthStencilInOut, *pass, outputs, stats );
+					}
+				}
+
+				RenderPassDependenciesArray result;
+
+				if ( stats )
+				{
+					stats->stats.overlapTests += outputs.size() * ( inputs.size() + sampled.size() );
+				}
+
+				for ( auto & output : outputs )
+				{
+					for ( auto & input : inputs )
+					{
+						if ( areOverlapping( graph, output.attach.view, input.attach.view ) )
+						{
+							addDependency( output.attach
+								, input.attach
+								, output.passes
+								, input.passes
+								, result );
+						}
+					}
+
+					for ( auto & sample : sampled )
+					{
+						if ( areOverlapping( graph, output.attach.view, sample.attach.view ) )
+						{
+							addDependency( output.attach
+								, sample.attach
+								, output.passes
+								, sample.passes
+								, result );
+						}
+					}
+				}
+
+				buildBufferDependencies( graph, passes, result );
+
+				if ( stats )
+				{
+					stats->stats.dependenciesCreated += result.size();
+				}
+
+				return result;
+			}
+
+			template< typename PredT >
+			GraphAdjacentNode findIf( RenderPassNodePtrArray const & nodes
+				, GraphNode::Kind kind
+				, PredT predicate )
+			{
+				auto it = std::find_if( nodes.begin()
+					, nodes.end()
+					, [&kind, &predicate]( RenderPassNodePtr const & lookup )
+					{
+						return ( ( kind == GraphNode::Kind::Undefined || kind == lookup->getKind() )
+							&& predicate( lookup.get() ) );
+					} );
+
+				if ( it == nodes.end() )
+				{
+					return nullptr;
+				}
+
+				return it->get();
+			}
+
+			GraphAdjacentNode find( RenderPass const * pass
+				, RenderPassNodePtrArray const & nodes )
+			{
+				return findIf( nodes
+					, GraphNode::Kind::RenderPass
+					, [&pass]( GraphAdjacentNode lookup )
+					{
+						return ( pass == &nodeCast< RenderPassNode >( *lookup ).getRenderPass() );
+					} );
+			}
+
+			using RenderPassSet = std::set< RenderPass const * >;
+
+			RenderPassSet retrieveRoots( RenderPassPtrArray const & passes
+				, RenderPassDependenciesArray const & dependencies )
+			{
+				RenderPassSet result;
+				filter< RenderPassPtr >( passes
+					, [&dependencies]( RenderPassPtr const & pass )
+					{
+						// We want the passes that are not listed as destination to other passes.
+						return dependencies.end() == std::find_if( dependencies.begin()
+							, dependencies.end()
+							, [&pass]( RenderPassDependencies const & lookup )
+							{
+								return lookup.dstPass == pass.get();
+							} );
+					}
+					, [&result]( RenderPassPtr const & lookup )
+					{
+						result.insert( lookup.get() );
+					} );
+				return result;
+			}
+
+			RenderPassSet retrieveLeafs( RenderPassPtrArray const & passes
+				, RenderPassDependenciesArray const & dependencies )
+			{
+				RenderPassSet result;
+				filter< RenderPassPtr >( passes
+					, [&dependencies]( RenderPassPtr const & pass )
+					{
+						// We want the passes that are not listed as source to other passes.
+						return dependencies.end() == std::find_if( dependencies.begin()
+							, dependencies.end()
+							, [&pass]( RenderPassDependencies const & lookup )
+							{
+								return lookup.srcPass == pass.get();
+							} );
+					}
+					, [&result]( RenderPassPtr const & lookup )
+					{
+						result.insert( lookup.get() );
+					} );
+				return result;
+			}
+
+			GraphAdjacentNode createNode( RenderPass const * pass
+				, RenderPassNodePtrArray & nodes )
+			{
+				auto result = find( pass, nodes );
+
+				if ( !result )
+				{
+					nodes.push_back( std::make_unique< RenderPassNode >( *pass, uint32_t( nodes.size() + 1u ) ) );
+					result = nodes.back().get();
+				}
+
+				return result;
+			}
+
+			AttachmentTransitionArray buildTransitions( AttachmentArray const & srcOutputs
+				, AttachmentArray const & dstInputs
+				, RenderPass const * srcPass
+				, RenderPass const * dstPass )
+			{
+				assert( srcOutputs.size() == dstInputs.size() );
+				AttachmentTransitionArray result;
+				auto srcOutputIt = srcOutputs.begin();
+				auto end = srcOutputs.end();
+				auto dstInputIt = dstInputs.begin();
+				std::set< RenderPass const * > srcPasses{ srcPass };
+				std::set< RenderPass const * > dstPasses{ dstPass };
+
+				while ( srcOutputIt != end )
+				{
+					result.push_back( AttachmentTransition
+						{
+							{ { *srcOutputIt, srcPasses } },
+							{ *dstInputIt, dstPasses },
+						} );
+					++srcOutputIt;
+					++dstInputIt;
+				}
+
+				return reference::mergeIdenticalTransitions( std::move( result ) );
+			}
+
+			void buildGraphRec( RenderPass const * curr
+				, AttachmentTransitionArray prevAttaches
+				, RenderPassDependenciesArray const & dependencies
+				, RenderPassNodePtrArray & nodes
+				, RootNode & fullGraph
+				, AttachmentTransitionArray & allAttaches
+				, GraphAdjacentNode prevNode
+				, StatsCollector * stats )
+			{
+				if ( prevNode->getKind() == GraphNode::Kind::Root
+					|| curr != getRenderPass( *prevNode ) )
+				{
+					// We want the dependencies for which the current pass is the source.
+					std::set< RenderPassDependencies const * > attaches;
+					RenderPassDependenciesArray nextDependencies;
+					filter< RenderPassDependencies >( dependencies
+						, [&curr]( RenderPassDependencies const & lookup )
+						{
+							return curr->name == lookup.srcPass->name;
+						}
+						, [&attaches]( RenderPassDependencies const & lookup )
+						{
+							attaches.insert( &lookup );
+						}
+						, [&nextDependencies]( RenderPassDependencies const & lookup )
+						{
+							nextDependencies.push_back( lookup );
+						} );
+
+					GraphAdjacentNode result{ createNode( curr, nodes ) };
+					allAttaches.insert( allAttaches.end()
+						, prevAttaches.begin()
+						, prevAttaches.end() );
+					prevNode->attachNode( result
+						, std::move( prevAttaches ) );
+
+					for ( auto & dependency : attaches )
+					{
+						if ( stats )
+						{
+							++stats->stats.graphVisits;
+						}
+
+						buildGraphRec( dependency->dstPass
+							, buildTransitions( dependency->srcOutputs
+								, dependency->dstInputs
+								, curr
+								, dependency->dstPass )
+							, nextDependencies
+							, nodes
+							, fullGraph
+							, allAttaches
+							, result
+							, stats );
+					}
+				}
+			}
+
+			RenderPassNodePtrArray buildGraph( RenderPassPtrArray const & passes
+				, RootNode & rootNode
+				, AttachmentTransitionArray & allAttaches
+				, RenderPassDependenciesArray const & dependencies
+				, StatsCollector * stats )
+			{
+				RenderPassNodePtrArray nodes;
+				// Retrieve root and leave passes.
+				RenderPassSet roots;
+				{
+					PhaseTimer timer{ stats, CompilePhase::RetrieveRoots };
+					roots = retrieveRoots( passes, dependencies );
+				}
+
+				if ( roots.empty() )
+				{
+					CRG_Exception( "No root to start with" );
+				}
+
+				RenderPassSet leaves;
+				{
+					PhaseTimer timer{ stats, CompilePhase::RetrieveLeafs };
+					leaves = retrieveLeafs( passes, dependencies );
+				}
+
+				if ( leaves.empty() )
+				{
+					CRG_Exception( "No leaf to end with" );
+				}
+
+				// Build paths from each root pass to leaf pass
+				GraphAdjacentNode curr{ &rootNode };
+				{
+					PhaseTimer timer{ stats, CompilePhase::BuildGraphNodes };
+
+					for ( auto & root : roots )
+					{
+						buildGraphRec( root
+							, {}
+							, dependencies
+							, nodes
+							, rootNode
+							, allAttaches
+							, curr
+							, stats );
+					}
+				}
+
+				if ( stats )
+				{
+					stats->stats.transitionsBeforeMerges = allAttaches.size();
+				}
+
+				{
+					PhaseTimer timer{ stats, CompilePhase::MergeIdenticalTransitions };
+					allAttaches = reference::mergeIdenticalTransitions( std::move( allAttaches ) );
+				}
+
+				if ( stats )
+				{
+					stats->stats.transitionsAfterMergeIdentical = allAttaches.size();
+				}
+
+				{
+					PhaseTimer timer{ stats, CompilePhase::MergeTransitionsPerInput };
+					allAttaches = reference::mergeTransitionsPerInput( std::move( allAttaches ) );
+				}
+
+				if ( stats )
+				{
+					stats->stats.transitionsAfterMergePerInput = allAttaches.size();
+				}
+
+				{
+					PhaseTimer timer{ stats, CompilePhase::ReduceDirectPaths };
+					allAttaches = reference::reduceDirectPaths( std::move( allAttaches ) );
+				}
+
+				if ( stats )
+				{
+					stats->stats.transitionsAfterReduceDirectPaths = allAttaches.size();
+				}
+
+				return nodes;
+			}
+		}
+	}
+}
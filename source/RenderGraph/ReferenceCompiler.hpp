@@ -0,0 +1,42 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#pragma once
+
+#include "PhaseTimer.hpp"
+
+#include "RenderGraph/GraphNode.hpp"
+
+namespace crg
+{
+	namespace details
+	{
+		/**
+		*\brief
+		*	The straightforward compilation algorithms, without any index.
+		*\remarks
+		*	They are kept as the reference the optimised ones are checked against, in CompileMode::CrossCheck,
+		*	so they must be kept simple rather than fast.
+		*/
+		namespace reference
+		{
+			/**
+			*\brief
+			*	Lists the dependencies between passes, comparing each attachment to all the other ones.
+			*/
+			RenderPassDependenciesArray buildPassDependencies( RenderGraph const & graph
+				, RenderPassPtrArray const & passes
+				, StatsCollector * stats );
+			/**
+			*\brief
+			*	Builds the graph nodes, following every path from the roots, then merges the transitions.
+			*/
+			RenderPassNodePtrArray buildGraph( RenderPassPtrArray const & passes
+				, RootNode & rootNode
+				, AttachmentTransitionArray & allAttaches
+				, RenderPassDependenciesArray const & dependencies
+				, StatsCollector * stats );
+		}
+	}
+}
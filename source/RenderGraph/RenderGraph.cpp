@@ -4,79 +4,119 @@ See LICENSE file in root folder.
 */
 #include "RenderGraph/RenderGraph.hpp"
 
+#include "BarriersBuilder.hpp"
+#include "CompileDivergence.hpp"
+#include "Hash.hpp"
+#include "PassComponents.hpp"
+#include "PhaseTimer.hpp"
+#include "ReferenceCompiler.hpp"
 #include "RenderPassDependenciesBuilder.hpp"
 
+#include "RenderGraph/CompileCache.hpp"
 #include "RenderGraph/Exception.hpp"
 #include "RenderGraph/RenderPass.hpp"
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace crg
 {
 	namespace details
 	{
-		template< typename PredT >
-		GraphAdjacentNode findIf( GraphNodePtrArray const & nodes
-			, GraphNode::Kind kind
-			, PredT predicate )
-		{
-			GraphAdjacentNode result{ nullptr };
-			auto it = std::find_if( nodes.begin()
-				, nodes.end()
-				, [&kind, &predicate]( GraphNodePtr const & lookup )
-				{
-					return ( ( kind == GraphNode::Kind::Undefined || kind == lookup->getKind() )
-						&& predicate( lookup.get() ) );
-				} );
+		using RenderPassSet = std::set< RenderPass const * >;
+
+		template< typename DataT >
+		Id< DataT > resolveStaged( Id< DataT > id
+			, PassStaging const & staging
+			, std::vector< Id< DataT > > const & ids )
+		{
+			if ( !PassStaging::isStaged( id ) )
+			{
+				return id;
+			}
 
-			if ( it == nodes.end() )
+			if ( PassStaging::getStagingIndex( id ) != staging.getIndex()
+				|| id.id == 0u
+				|| id.id > ids.size() )
 			{
-				return nullptr;
+				CRG_Exception( "Staging " + staging.getName() + " uses a handle from another staging." );
 			}
 
-			return it->get();
+			return ids[id.id - 1u];
 		}
 
-		GraphAdjacentNode find( RenderPass const * pass
-			, GraphNodePtrArray const & nodes )
+		AttachmentArray resolveStaged( AttachmentArray attaches
+			, PassStaging const & staging
+			, std::vector< ImageViewId > const & views )
 		{
-			return findIf( nodes
-				, GraphNode::Kind::RenderPass
-				, [&pass]( GraphAdjacentNode lookup )
-				{
-					return ( pass == &nodeCast< RenderPassNode >( *lookup ).getRenderPass() );
-				} );
+			for ( auto & attach : attaches )
+			{
+				attach.view = resolveStaged( attach.view, staging, views );
+			}
+
+			return attaches;
 		}
 
-		GraphAdjacentNode find( std::string const & name
-			, GraphNodePtrArray const & nodes )
+		RenderPass resolveStaged( RenderPass const & pass
+			, PassStaging const & staging
+			, std::vector< ImageViewId > const & views
+			, std::vector< BufferId > const & buffers )
 		{
-			return findIf( nodes
-				, GraphNode::Kind::Undefined
-				, [&name]( GraphAdjacentNode lookup )
+			auto bufferAttaches = pass.buffers;
+
+			for ( auto & attach : bufferAttaches )
+			{
+				attach.buffer = resolveStaged( attach.buffer, staging, buffers );
+			}
+
+			switch ( pass.kind )
+			{
+			case RenderPass::Kind::Compute:
+				return RenderPass::createCompute( pass.name
+					, resolveStaged( pass.sampled, staging, views )
+					, resolveStaged( pass.storages, staging, views )
+					, bufferAttaches );
+			case RenderPass::Kind::Transfer:
+				return RenderPass::createTransfer( pass.name
+					, resolveStaged( pass.transfers, staging, views )
+					, bufferAttaches );
+			default:
 				{
-					return name == lookup->getName();
-				} );
-		}
+					auto depthStencil = pass.depthStencilInOut;
 
-		using RenderPassSet = std::set< RenderPass const * >;
+					if ( depthStencil )
+					{
+						depthStencil->view = resolveStaged( depthStencil->view, staging, views );
+					}
+
+					return RenderPass{ pass.name
+						, resolveStaged( pass.sampled, staging, views )
+						, resolveStaged( pass.colourInOuts, staging, views )
+						, depthStencil
+						, bufferAttaches };
+				}
+			}
+		}
 
 		RenderPassSet retrieveRoots( RenderPassPtrArray const & passes
 			, RenderPassDependenciesArray const & dependencies )
 		{
+			// We want the passes that are not listed as destination to other passes.
+			RenderPassSet dsts;
+
+			for ( auto & dependency : dependencies )
+			{
+				dsts.insert( dependency.dstPass );
+			}
+
 			RenderPassSet result;
 			filter< RenderPassPtr >( passes
-				, [&dependencies]( RenderPassPtr const & pass )
+				, [&dsts]( RenderPassPtr const & pass )
 				{
-					// We want the passes that are not listed as destination to other passes.
-					return dependencies.end() == std::find_if( dependencies.begin()
-						, dependencies.end()
-						, [&pass]( RenderPassDependencies const & lookup )
-						{
-							return lookup.dstPass == pass.get();
-						} );
+					return dsts.end() == dsts.find( pass.get() );
 				}
 				, [&result]( RenderPassPtr const & lookup )
 				{
@@ -88,17 +128,19 @@ namespace crg
 		RenderPassSet retrieveLeafs( RenderPassPtrArray const & passes
 			, RenderPassDependenciesArray const & dependencies )
 		{
+			// We want the passes that are not listed as source to other passes.
+			RenderPassSet srcs;
+
+			for ( auto & dependency : dependencies )
+			{
+				srcs.insert( dependency.srcPass );
+			}
+
 			RenderPassSet result;
 			filter< RenderPassPtr >( passes
-				, [&dependencies]( RenderPassPtr const & pass )
+				, [&srcs]( RenderPassPtr const & pass )
 				{
-					// We want the passes that are not listed as source to other passes.
-					return dependencies.end() == std::find_if( dependencies.begin()
-						, dependencies.end()
-						, [&pass]( RenderPassDependencies const & lookup )
-						{
-							return lookup.srcPass == pass.get();
-						} );
+					return srcs.end() == srcs.find( pass.get() );
 				}
 				, [&result]( RenderPassPtr const & lookup )
 				{
@@ -107,20 +149,6 @@ namespace crg
 			return result;
 		}
 
-		GraphAdjacentNode createNode( RenderPass const * pass
-			, GraphNodePtrArray & nodes )
-		{
-			auto result = find( pass, nodes );
-
-			if ( !result )
-			{
-				nodes.push_back( std::make_unique< RenderPassNode >( *pass ) );
-				result = nodes.back().get();
-			}
-
-			return result;
-		}
-
 		AttachmentTransitionArray buildTransitions( AttachmentArray const & srcOutputs
 			, AttachmentArray const & dstInputs
 			, RenderPass const * srcPass
@@ -148,72 +176,125 @@ namespace crg
 			return mergeIdenticalTransitions( std::move( result ) );
 		}
 
-		void buildGraphRec( RenderPass const * curr
-			, AttachmentTransitionArray prevAttaches
+		/**
+		*\brief
+		*	Creates the nodes of the passes reachable from the roots, and links them following the dependencies.
+		*\remarks
+		*	Each dependency is traversed once, depth first and in the dependencies order,
+		*	so nodes and transitions are created in the order the paths from the roots reach them.
+		*/
+		void buildGraphNodes( RenderPassPtrArray const & passes
+			, RenderPassSet const & roots
 			, RenderPassDependenciesArray const & dependencies
-			, GraphNodePtrArray & nodes
-			, RootNode & fullGraph
+			, RenderPassNodePtrArray & nodes
+			, RootNode & rootNode
 			, AttachmentTransitionArray & allAttaches
-			, GraphAdjacentNode prevNode )
+			, StatsCollector * stats )
 		{
-			if ( prevNode->getKind() == GraphNode::Kind::Root
-				|| curr != getRenderPass( *prevNode ) )
+			std::unordered_map< RenderPass const *, uint32_t > indices;
+
+			for ( auto & pass : passes )
+			{
+				indices.emplace( pass.get(), uint32_t( indices.size() ) );
+			}
+
+			// The dependencies for which each pass is the source.
+			std::vector< std::vector< RenderPassDependencies const * > > nexts( passes.size() );
+
+			for ( auto & dependency : dependencies )
+			{
+				nexts[indices[dependency.srcPass]].push_back( &dependency );
+			}
+
+			struct Frame
 			{
-				// We want the dependencies for which the current pass is the source.
-				std::set< RenderPassDependencies const * > attaches;
-				RenderPassDependenciesArray nextDependencies;
-				filter< RenderPassDependencies >( dependencies
-					, [&curr]( RenderPassDependencies const & lookup )
+				uint32_t pass;
+				uint32_t next;
+			};
+			std::vector< GraphAdjacentNode > passNodes( passes.size(), nullptr );
+			std::vector< Frame > stack;
+			auto visit = [&]( uint32_t index
+				, AttachmentTransitionArray transitions
+				, GraphAdjacentNode prevNode )
+			{
+				auto & node = passNodes[index];
+				bool expand = node == nullptr;
+
+				if ( expand )
+				{
+					nodes.push_back( std::make_unique< RenderPassNode >( *passes[index], uint32_t( nodes.size() + 1u ) ) );
+					node = nodes.back().get();
+				}
+
+				allAttaches.insert( allAttaches.end()
+					, transitions.begin()
+					, transitions.end() );
+				prevNode->attachNode( node
+					, std::move( transitions ) );
+
+				if ( expand )
+				{
+					stack.push_back( { index, 0u } );
+				}
+			};
+
+			for ( auto & root : roots )
+			{
+				visit( indices[root], {}, &rootNode );
+
+				while ( !stack.empty() )
+				{
+					auto & frame = stack.back();
+					auto & passNexts = nexts[frame.pass];
+
+					if ( frame.next == passNexts.size() )
 					{
-						return curr->name == lookup.srcPass->name;
+						stack.pop_back();
+						continue;
 					}
-					, [&attaches]( RenderPassDependencies const & lookup )
+
+					auto src = frame.pass;
+					auto & dependency = *passNexts[frame.next++];
+
+					if ( stats )
 					{
-						attaches.insert( &lookup );
+						++stats->stats.graphVisits;
 					}
-					, [&nextDependencies]( RenderPassDependencies const & lookup )
-					{
-						nextDependencies.push_back( lookup );
-					} );
-
-				GraphAdjacentNode result{ createNode( curr, nodes ) };
-				allAttaches.insert( allAttaches.end()
-					, prevAttaches.begin()
-					, prevAttaches.end() );
-				prevNode->attachNode( result
-					, std::move( prevAttaches ) );
 
-				for ( auto & dependency : attaches )
-				{
-					buildGraphRec( dependency->dstPass
-						, buildTransitions( dependency->srcOutputs
-							, dependency->dstInputs
-							, curr
-							, dependency->dstPass )
-						, nextDependencies
-						, nodes
-						, fullGraph
-						, allAttaches
-						, result );
+					visit( indices[dependency.dstPass]
+						, buildTransitions( dependency.srcOutputs
+							, dependency.dstInputs
+							, dependency.srcPass
+							, dependency.dstPass )
+						, passNodes[src] );
 				}
 			}
 		}
 
-		GraphNodePtrArray buildGraph( std::vector< RenderPassPtr > const & passes
+		RenderPassNodePtrArray buildGraph( std::vector< RenderPassPtr > const & passes
 			, RootNode & rootNode
 			, AttachmentTransitionArray & allAttaches
-			, RenderPassDependenciesArray const & dependencies )
+			, RenderPassDependenciesArray const & dependencies
+			, StatsCollector * stats )
 		{
-			GraphNodePtrArray nodes;
+			RenderPassNodePtrArray nodes;
 			// Retrieve root and leave passes.
-			auto roots = retrieveRoots( passes, dependencies );
+			RenderPassSet roots;
+			{
+				PhaseTimer timer{ stats, CompilePhase::RetrieveRoots };
+				roots = retrieveRoots( passes, dependencies );
+			}
 
 			if ( roots.empty() )
 			{
 				CRG_Exception( "No root to start with" );
 			}
 
-			auto leaves = retrieveLeafs( passes, dependencies );
+			RenderPassSet leaves;
+			{
+				PhaseTimer timer{ stats, CompilePhase::RetrieveLeafs };
+				leaves = retrieveLeafs( passes, dependencies );
+			}
 
 			if ( leaves.empty() )
 			{
@@ -221,24 +302,125 @@ namespace crg
 			}
 
 			// Build paths from each root pass to leaf pass
-			GraphAdjacentNode curr{ &rootNode };
-
-			for ( auto & root : roots )
 			{
-				buildGraphRec( root
-					, {}
+				PhaseTimer timer{ stats, CompilePhase::BuildGraphNodes };
+				buildGraphNodes( passes
+					, roots
 					, dependencies
 					, nodes
 					, rootNode
 					, allAttaches
-					, curr );
+					, stats );
+			}
+
+			if ( stats )
+			{
+				stats->stats.transitionsBeforeMerges = allAttaches.size();
+			}
+
+			{
+				PhaseTimer timer{ stats, CompilePhase::MergeIdenticalTransitions };
+				allAttaches = mergeIdenticalTransitions( std::move( allAttaches ) );
+			}
+
+			if ( stats )
+			{
+				stats->stats.transitionsAfterMergeIdentical = allAttaches.size();
+			}
+
+			{
+				PhaseTimer timer{ stats, CompilePhase::MergeTransitionsPerInput };
+				allAttaches = mergeTransitionsPerInput( std::move( allAttaches ) );
+			}
+
+			if ( stats )
+			{
+				stats->stats.transitionsAfterMergePerInput = allAttaches.size();
+			}
+
+			{
+				PhaseTimer timer{ stats, CompilePhase::ReduceDirectPaths };
+				allAttaches = reduceDirectPaths( std::move( allAttaches ) );
+			}
+
+			if ( stats )
+			{
+				stats->stats.transitionsAfterReduceDirectPaths = allAttaches.size();
 			}
 
-			allAttaches = mergeIdenticalTransitions( std::move( allAttaches ) );
-			allAttaches = mergeTransitionsPerInput( std::move( allAttaches ) );
-			allAttaches = reduceDirectPaths( std::move( allAttaches ) );
 			return nodes;
 		}
+
+		std::vector< size_t > signPasses( RenderPassArray const & passes
+			, AttachmentTransitionArray const & transitions )
+		{
+			std::unordered_map< RenderPass const *, size_t > signatures;
+
+			for ( auto & pass : passes )
+			{
+				auto & signature = signatures[pass];
+				hashCombine( signature, pass->name );
+				hashCombine( signature, int( pass->kind ) );
+
+				for ( auto & attach : pass->sampled )
+				{
+					hashCombine( signature, getHash( attach ) );
+				}
+
+				for ( auto & attach : pass->colourInOuts )
+				{
+					hashCombine( signature, getHash( attach ) );
+				}
+
+				if ( pass->depthStencilInOut )
+				{
+					hashCombine( signature, getHash( *pass->depthStencilInOut ) );
+				}
+
+				for ( auto & attach : pass->storages )
+				{
+					hashCombine( signature, getHash( attach ) );
+				}
+
+				for ( auto & attach : pass->transfers )
+				{
+					hashCombine( signature, getHash( attach ) );
+				}
+
+				for ( auto & attach : pass->buffers )
+				{
+					hashCombine( signature, getHash( attach ) );
+				}
+			}
+
+			for ( auto & transition : transitions )
+			{
+				auto hash = getHash( transition );
+
+				for ( auto & srcOutput : transition.srcOutputs )
+				{
+					for ( auto & pass : srcOutput.passes )
+					{
+						hashCombine( signatures[pass], hash );
+					}
+				}
+
+				for ( auto & pass : transition.dstInput.passes )
+				{
+					hashCombine( signatures[pass], hash );
+				}
+			}
+
+			std::vector< size_t > result;
+			result.reserve( passes.size() );
+
+			for ( auto & pass : passes )
+			{
+				result.push_back( signatures[pass] );
+			}
+
+			return result;
+		}
 	}
 
 	RenderGraph::RenderGraph( std::string name )
@@ -246,62 +428,559 @@ namespace crg
 	{
 	}
 
-	void RenderGraph::add( RenderPass const & pass )
+	PassId RenderGraph::add( RenderPass const & pass )
 	{
-		if ( m_passes.end() != std::find_if( m_passes.begin()
-			, m_passes.end()
-			, [&pass]( RenderPassPtr const & lookup )
-			{
-				return lookup->name == pass.name;
-			} ) )
+		if ( m_passIds.end() != m_passIds.find( pass.name ) )
 		{
 			CRG_Exception( "Duplicate RenderPass name detected." );
 		}
 
-		m_passes.push_back( std::make_unique< RenderPass >( pass ) );
+		auto data = std::make_unique< RenderPass >( pass );
+		PassId result{ ++m_lastPassId, 0u };
+		m_passIds.emplace( data->name, result.id );
+		m_passIndices.emplace( result.id, uint32_t( m_passes.size() ) );
+		m_passes.push_back( std::move( data ) );
+		return result;
+	}
+
+	void RenderGraph::remove( PassId pass )
+	{
+		auto it = m_passIndices.find( pass.id );
+
+		if ( m_passIndices.end() == it )
+		{
+			CRG_Exception( "RenderPass was not found." );
+		}
+
+		// The slot is only reset, the passes are compacted at the next compilation.
+		auto & slot = m_passes[it->second];
+		m_passIds.erase( slot->name );
+		m_passIndices.erase( it );
+		slot.reset();
+		++m_removedPassCount;
+		clearCompiled();
 	}
 
-	void RenderGraph::remove( RenderPass const & pass )
+	RenderPass const & RenderGraph::getPass( PassId pass )const
 	{
-		auto it = std::find_if( m_passes.begin()
-			, m_passes.end()
-			, [&pass]( RenderPassPtr const & lookup )
+		auto it = m_passIndices.find( pass.id );
+
+		if ( m_passIndices.end() == it )
+		{
+			CRG_Exception( "RenderPass was not found." );
+		}
+
+		return *m_passes[it->second];
+	}
+
+	bool RenderGraph::dependsOn( PassId pass
+		, PassId other )const
+	{
+		return m_reachability.reaches( getCompiledPassIndex( other.id )
+			, getCompiledPassIndex( pass.id ) );
+	}
+
+	bool RenderGraph::dependsOn( RenderPass const & pass
+		, RenderPass const & other )const
+	{
+		return m_reachability.reaches( getCompiledPassIndex( other )
+			, getCompiledPassIndex( pass ) );
+	}
+
+	std::vector< bool > RenderGraph::dependsOn( RenderPass const & pass
+		, RenderPassArray const & others )const
+	{
+		auto dst = getCompiledPassIndex( pass );
+		std::vector< bool > result;
+		result.reserve( others.size() );
+
+		for ( auto & other : others )
+		{
+			result.push_back( m_reachability.reaches( getCompiledPassIndex( *other ), dst ) );
+		}
+
+		return result;
+	}
+
+	RenderPassArray RenderGraph::getTransitiveDependencies( RenderPass const & pass )const
+	{
+		auto dst = getCompiledPassIndex( pass );
+		RenderPassArray result;
+
+		for ( uint32_t src = 0u; src < m_reachability.passComponents.size(); ++src )
+		{
+			if ( m_reachability.reaches( src, dst ) )
 			{
-				return lookup->name == pass.name;
-			} );
+				result.push_back( m_passes[src].get() );
+			}
+		}
+
+		return result;
+	}
+
+	PassStaging & RenderGraph::getStaging( std::string const & name )
+	{
+		std::lock_guard< std::mutex > lock( *m_stagingsMutex );
+		auto & result = m_stagings[name];
+
+		if ( !result )
+		{
+			result = std::make_unique< PassStaging >( name, uint32_t( m_stagings.size() ) );
+		}
+
+		return *result;
+	}
+
+	void RenderGraph::mergeStagings()
+	{
+		std::lock_guard< std::mutex > lock( *m_stagingsMutex );
+		// Everything is checked before anything is created, so that a failure leaves the graph and the stagings untouched.
+		std::set< std::string_view > names;
+
+		for ( auto & it : m_stagings )
+		{
+			auto & staging = *it.second;
+			ImageIdArray images( staging.getImages().size() );
+			std::vector< BufferId > buffers( staging.getBuffers().size() );
+			std::vector< ImageViewId > views( staging.getViews().size() );
+
+			for ( auto & view : staging.getViews() )
+			{
+				details::resolveStaged( view.image, staging, images );
+			}
 
-		if ( m_passes.end() == it )
+			for ( auto pass : staging.getPasses() )
+			{
+				if ( m_passIds.end() != m_passIds.find( pass->name )
+					|| !names.insert( pass->name ).second )
+				{
+					CRG_Exception( "Duplicate RenderPass name detected in staging " + staging.getName() + "." );
+				}
+
+				details::resolveStaged( *pass, staging, views, buffers );
+			}
+		}
+
+		for ( auto & it : m_stagings )
+		{
+			auto & staging = *it.second;
+
+			if ( staging.empty() )
+			{
+				continue;
+			}
+
+			// The resources are created first, since the views and passes reference them.
+			ImageIdArray images;
+			images.reserve( staging.getImages().size() );
+
+			for ( auto & image : staging.getImages() )
+			{
+				images.push_back( createImage( image ) );
+			}
+
+			std::vector< BufferId > buffers;
+			buffers.reserve( staging.getBuffers().size() );
+
+			for ( auto & buffer : staging.getBuffers() )
+			{
+				buffers.push_back( createBuffer( buffer ) );
+			}
+
+			std::vector< ImageViewId > views;
+			views.reserve( staging.getViews().size() );
+
+			for ( auto view : staging.getViews() )
+			{
+				view.image = details::resolveStaged( view.image, staging, images );
+				views.push_back( createView( view ) );
+			}
+
+			for ( auto pass : staging.getPasses() )
+			{
+				add( details::resolveStaged( *pass, staging, views, buffers ) );
+			}
+
+			staging.clear();
+		}
+	}
+
+	void RenderGraph::remove( RenderPass const & pass )
+	{
+		auto it = m_passIds.find( pass.name );
+
+		if ( m_passIds.end() == it )
 		{
 			CRG_Exception( "RenderPass was not found." );
 		}
 
-		m_passes.erase( it );
+		remove( PassId{ it->second, 0u } );
 	}
 
 	void RenderGraph::compile()
 	{
+		mergeStagings();
+		compactPasses();
+
 		if ( m_passes.empty() )
 		{
 			CRG_Exception( "No RenderPass registered." );
 		}
 
-		auto dependencies = details::buildPassDependencies( m_passes );
-		m_nodes = details::buildGraph( m_passes, m_root, m_transitions, dependencies );
+		CompileStats stats;
+		details::StatsCollector collector{ stats, m_allocationCounter };
+		auto statsCollector = m_compileStatsEnabled
+			? &collector
+			: nullptr;
+		auto begin = statsCollector
+			? std::chrono::steady_clock::now()
+			: std::chrono::steady_clock::time_point{};
+		auto allocations = statsCollector
+			? collector.getAllocations()
+			: AllocationCount{};
+		bool loaded{ false };
+
+		if ( m_compileCache )
+		{
+			details::PhaseTimer timer{ statsCollector, CompilePhase::CacheLoad };
+			loaded = m_compileCache->load( *this );
+		}
+
+		if ( !loaded )
+		{
+			m_root = RootNode{ m_root.getName() };
+			m_nodes.clear();
+			m_transitions.clear();
+			details::PassComponents components;
+
+			{
+				details::PhaseTimer timer{ statsCollector, CompilePhase::BuildPassDependencies };
+				m_dependencies = m_compileMode == CompileMode::Reference
+					? details::reference::buildPassDependencies( *this, m_passes, statsCollector )
+					: details::buildPassDependencies( *this, m_passes, statsCollector );
+			}
+			{
+				// The cycles are found before building the graph, so that they are available when it throws.
+				details::PhaseTimer timer{ statsCollector, CompilePhase::FindCycles };
+				components = details::findPassComponents( m_passes, m_dependencies );
+				m_cycles = details::buildCycles( m_passes, m_dependencies, components );
+			}
+			m_nodes = m_compileMode == CompileMode::Reference
+				? details::reference::buildGraph( m_passes, m_root, m_transitions, m_dependencies, statsCollector )
+				: details::buildGraph( m_passes, m_root, m_transitions, m_dependencies, statsCollector );
+
+			{
+				details::PhaseTimer timer{ statsCollector, CompilePhase::SortPasses };
+				m_executionOrder = details::sortPasses( m_passes, components );
+			}
+			{
+				details::PhaseTimer timer{ statsCollector, CompilePhase::BuildReachability };
+				m_reachability = details::buildReachability( m_dependencies, std::move( components ), m_reachabilityMaxSize );
+
+				if ( statsCollector )
+				{
+					stats.dependenciesAfterReduction = uint64_t( std::count_if( m_dependencies.begin()
+						, m_dependencies.end()
+						, []( RenderPassDependencies const & lookup )
+						{
+							return !lookup.redundant;
+						} ) );
+				}
+			}
+			{
+				details::PhaseTimer timer{ statsCollector, CompilePhase::SignPasses };
+				m_passSignatures = details::signPasses( m_executionOrder, m_transitions );
+			}
+			{
+				details::PhaseTimer timer{ statsCollector, CompilePhase::BuildPassBarriers };
+				m_barriers = details::buildPassBarriers( *this, m_executionOrder, m_historyAliases );
+			}
+			{
+				details::PhaseTimer timer{ statsCollector, CompilePhase::BuildHistoryDependencies };
+				m_historyDependencies = details::buildHistoryDependencies( *this, m_executionOrder, m_historyAliases );
+			}
+			++m_compileCount;
+
+			if ( m_compileMode == CompileMode::CrossCheck )
+			{
+				crossCheck();
+			}
+
+			if ( m_compileCache )
+			{
+				details::PhaseTimer timer{ statsCollector, CompilePhase::CacheStore };
+				m_compileCache->store( *this );
+			}
+		}
+
+		if ( statsCollector )
+		{
+			stats.fromCache = loaded;
+			stats.totalTime = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - begin );
+			auto endAllocations = collector.getAllocations();
+			stats.allocations = endAllocations.allocations - allocations.allocations;
+			stats.allocatedBytes = endAllocations.bytes - allocations.bytes;
+			m_compileStats = stats;
+
+			if ( m_compileStatsCallback )
+			{
+				m_compileStatsCallback( m_compileStats );
+			}
+		}
+	}
+
+	void RenderGraph::compactPasses()
+	{
+		if ( !m_removedPassCount )
+		{
+			return;
+		}
+
+		m_passes.erase( std::remove( m_passes.begin(), m_passes.end(), nullptr )
+			, m_passes.end() );
+		m_removedPassCount = 0u;
+
+		for ( uint32_t index = 0u; index < m_passes.size(); ++index )
+		{
+			m_passIndices[m_passIds.find( m_passes[index]->name )->second] = index;
+		}
+	}
+
+	void RenderGraph::clearCompiled()
+	{
+		m_root = RootNode{ m_root.getName() };
+		m_nodes.clear();
+		m_transitions.clear();
+		m_dependencies.clear();
+		m_cycles.clear();
+		m_reachability = PassReachability{};
+		m_executionOrder.clear();
+		m_passSignatures.clear();
+		m_barriers.clear();
+		m_historyDependencies.clear();
+	}
+
+	uint32_t RenderGraph::getCompiledPassIndex( RenderPass const & pass )const
+	{
+		auto it = m_passIds.find( pass.name );
+
+		if ( m_passIds.end() == it )
+		{
+			CRG_Exception( "RenderPass was not found." );
+		}
+
+		return getCompiledPassIndex( it->second );
+	}
+
+	uint32_t RenderGraph::getCompiledPassIndex( uint32_t passId )const
+	{
+		auto it = m_passIndices.find( passId );
+
+		if ( m_passIndices.end() == it )
+		{
+			CRG_Exception( "RenderPass was not found." );
+		}
+
+		// Passes added since the last compilation are not in the reachability.
+		if ( it->second >= m_reachability.passComponents.size() )
+		{
+			CRG_Exception( "The graph must be compiled before querying its dependencies." );
+		}
+
+		return it->second;
+	}
+
+	void RenderGraph::crossCheck()const
+	{
+		// The reference algorithms run on the same passes, since some orders depend on the passes addresses.
+		RootNode root{ m_root.getName() };
+		AttachmentTransitionArray transitions;
+		auto dependencies = details::reference::buildPassDependencies( *this, m_passes, nullptr );
+		auto nodes = details::reference::buildGraph( m_passes, root, transitions, dependencies, nullptr );
+		auto divergence = details::findDivergence( { m_dependencies, m_root, m_transitions }
+			, { dependencies, root, transitions } );
+
+		if ( !divergence.empty() )
+		{
+			CRG_Exception( "Optimised and reference compilations diverge: " + divergence );
+		}
 	}
 
 	ImageId RenderGraph::createImage( ImageData const & img )
 	{
-		auto data = std::make_unique< ImageData >( img );
-		ImageId result{ uint32_t( m_images.size() + 1u ), data.get() };
-		m_images.insert( { result, std::move( data ) } );
-		return result;
+		return m_images.insert( img );
 	}
 
 	ImageViewId RenderGraph::createView( ImageViewData const & img )
 	{
-		auto data = std::make_unique< ImageViewData >( img );
-		ImageViewId result{ uint32_t( m_imageViews.size() + 1u ), data.get() };
-		m_imageViews.insert( { result, std::move( data ) } );
+		auto hash = details::getHash( img );
+		auto range = m_viewIds.equal_range( hash );
+
+		for ( auto it = range.first; it != range.second; ++it )
+		{
+			if ( getView( it->second ) == img )
+			{
+				++m_viewRefCounts[it->second.id - 1u];
+				return it->second;
+			}
+		}
+
+		auto result = m_imageViews.insert( img );
+		m_viewIds.emplace( hash, result );
+
+		if ( m_viewRefCounts.size() < result.id )
+		{
+			m_viewRefCounts.resize( result.id );
+		}
+
+		m_viewRefCounts[result.id - 1u] = 1u;
+		return result;
+	}
+
+	BufferId RenderGraph::createBuffer( BufferData const & buffer )
+	{
+		return m_buffers.insert( buffer );
+	}
+
+	void RenderGraph::destroyImage( ImageId image )
+	{
+		if ( !m_images.erase( image ) )
+		{
+			CRG_Exception( "Stale or invalid image handle." );
+		}
+
+		auto historyIt = m_historyImages.find( image );
+
+		if ( historyIt != m_historyImages.end() )
+		{
+			for ( auto & backing : historyIt->second )
+			{
+				m_images.erase( backing );
+			}
+
+			m_historyImages.erase( historyIt );
+
+			for ( auto it = m_historyAliases.begin(); it != m_historyAliases.end(); )
+			{
+				if ( it->second.image == image )
+				{
+					m_images.erase( it->first );
+					it = m_historyAliases.erase( it );
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		m_historyAliases.erase( image );
+	}
+
+	void RenderGraph::destroyView( ImageViewId view )
+	{
+		if ( !m_imageViews.contains( view ) )
+		{
+			CRG_Exception( "Stale or invalid view handle." );
+		}
+
+		if ( --m_viewRefCounts[view.id - 1u] )
+		{
+			return;
+		}
+
+		auto range = m_viewIds.equal_range( details::getHash( getView( view ) ) );
+		auto it = std::find_if( range.first
+			, range.second
+			, [&view]( std::pair< size_t const, ImageViewId > const & lookup )
+			{
+				return lookup.second == view;
+			} );
+		m_viewIds.erase( it );
+		m_imageViews.erase( view );
+	}
+
+	ImageId RenderGraph::createHistoryImage( ImageData const & img
+		, uint32_t count )
+	{
+		if ( count < 2u )
+		{
+			CRG_Exception( "A history image needs at least two backing images." );
+		}
+
+		auto result = createImage( img );
+		auto & backings = m_historyImages[result];
+
+		for ( uint32_t index = 0u; index < count; ++index )
+		{
+			backings.push_back( createImage( img ) );
+		}
+
 		return result;
 	}
+
+	ImageViewId RenderGraph::createHistoryView( ImageViewId view
+		, uint32_t frameOffset )
+	{
+		auto viewData = getView( view );
+		auto image = viewData.image;
+		auto it = m_historyImages.find( image );
+
+		if ( it == m_historyImages.end() )
+		{
+			CRG_Exception( "The view doesn't target a history image." );
+		}
+
+		if ( frameOffset == 0u || frameOffset >= it->second.size() )
+		{
+			CRG_Exception( "The frame offset is out of the history image backings range." );
+		}
+
+		auto aliasIt = std::find_if( m_historyAliases.begin()
+			, m_historyAliases.end()
+			, [&image, &frameOffset]( HistoryAliasMap::value_type const & lookup )
+			{
+				return lookup.second.image == image
+					&& lookup.second.frameOffset == frameOffset;
+			} );
+
+		if ( aliasIt == m_historyAliases.end() )
+		{
+			// The alias is a distinct image, so that it is never considered as overlapping the current frame's content.
+			aliasIt = m_historyAliases.emplace( createImage( getImage( image ) )
+				, HistoryAlias{ image, frameOffset } ).first;
+		}
+
+		viewData.image = aliasIt->first;
+		return createView( viewData );
+	}
+
+	bool RenderGraph::isHistoryImage( ImageId image )const
+	{
+		return m_historyImages.end() != m_historyImages.find( image )
+			|| m_historyAliases.end() != m_historyAliases.find( image );
+	}
+
+	ImageId RenderGraph::getBackingImage( ImageId image
+		, uint32_t frameIndex )const
+	{
+		uint32_t frameOffset{};
+		auto aliasIt = m_historyAliases.find( image );
+
+		if ( aliasIt != m_historyAliases.end() )
+		{
+			image = aliasIt->second.image;
+			frameOffset = aliasIt->second.frameOffset;
+		}
+
+		auto it = m_historyImages.find( image );
+
+		if ( it == m_historyImages.end() )
+		{
+			return image;
+		}
+
+		auto count = uint32_t( it->second.size() );
+		return it->second[( frameIndex % count + count - frameOffset ) % count];
+	}
 }
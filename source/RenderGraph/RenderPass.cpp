@@ -11,11 +11,64 @@ namespace crg
 	RenderPass::RenderPass( std::string const & name
 		, AttachmentArray const & sampled
 		, AttachmentArray const & colourInOuts
-		, std::optional< Attachment > const & depthStencilInOut )
-		: name{ name }
+		, std::optional< Attachment > const & depthStencilInOut
+		, BufferAttachmentArray const & buffers )
+		: RenderPass{ Kind::Graphics
+			, name
+			, sampled
+			, colourInOuts
+			, depthStencilInOut
+			, {}
+			, {}
+			, buffers }
+	{
+	}
+
+	RenderPass::RenderPass( Kind kind
+		, std::string const & name
+		, AttachmentArray const & sampled
+		, AttachmentArray const & colourInOuts
+		, std::optional< Attachment > const & depthStencilInOut
+		, AttachmentArray const & storages
+		, AttachmentArray const & transfers
+		, BufferAttachmentArray const & buffers )
+		: kind{ kind }
+		, name{ name }
 		, sampled{ sampled }
 		, colourInOuts{ colourInOuts }
 		, depthStencilInOut{ depthStencilInOut }
+		, storages{ storages }
+		, transfers{ transfers }
+		, buffers{ buffers }
+	{
+	}
+
+	RenderPass RenderPass::createCompute( std::string const & name
+		, AttachmentArray const & sampled
+		, AttachmentArray const & storages
+		, BufferAttachmentArray const & buffers )
+	{
+		return RenderPass{ Kind::Compute
+			, name
+			, sampled
+			, {}
+			, std::nullopt
+			, storages
+			, {}
+			, buffers };
+	}
+
+	RenderPass RenderPass::createTransfer( std::string const & name
+		, AttachmentArray const & transfers
+		, BufferAttachmentArray const & buffers )
 	{
+		return RenderPass{ Kind::Transfer
+			, name
+			, {}
+			, {}
+			, std::nullopt
+			, {}
+			, transfers
+			, buffers };
 	}
 }
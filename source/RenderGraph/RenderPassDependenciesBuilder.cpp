@@ -4,7 +4,9 @@ See LICENSE file in root folder.
 */
 #include "RenderPassDependenciesBuilder.hpp"
 
+#include "RenderGraph/BufferAttachment.hpp"
 #include "RenderGraph/Exception.hpp"
+#include "RenderGraph/ImageViewData.hpp"
 #include "RenderGraph/RenderPass.hpp"
 
 #include <algorithm>
@@ -20,13 +22,68 @@ namespace crg
 {
 	namespace details
 	{
+		static size_t constexpr InvalidIndex = ~size_t{};
+		/**
+		*\brief
+		*	An attachment, with the passes using it or a later overlapping attachment.
+		*/
 		struct PassAttach
 		{
 			Attachment const attach;
-			std::set< RenderPass const * > passes;
+			ViewRange const range;
+			// The view of the attachment, in its image views.
+			size_t const view;
+			// The next attachment on the same view, in registration order.
+			size_t next{ InvalidIndex };
+			std::set< RenderPass const * > passes{};
 		};
+		/**
+		*\brief
+		*	The views of an image, with their ranges laid out for getOverlapMask().
+		*\remarks
+		*	The attachments of a view are linked from its first to its last one,
+		*	so that the attachments sharing a view cost a single overlap test.
+		*/
+		struct ImageAttaches
+		{
+			std::vector< std::pair< size_t, size_t > > views;
+			ViewRanges ranges;
+		};
+		/**
+		*\brief
+		*	The attachments, in registration order, indexed by image and view, and by view and name.
+		*/
+		struct PassAttachCont
+		{
+			RenderGraph const & graph;
+			std::vector< PassAttach > attaches{};
+			std::map< ImageId, ImageAttaches > images{};
+			std::map< std::pair< ImageViewId, std::string >, size_t > indices{};
+
+			std::vector< PassAttach >::const_iterator begin()const
+			{
+				return attaches.begin();
+			}
 
-		using PassAttachCont = std::vector< PassAttach >;
+			std::vector< PassAttach >::const_iterator end()const
+			{
+				return attaches.end();
+			}
+
+			ImageAttaches const & getImageAttaches( ImageId image )const
+			{
+				static ImageAttaches const dummy;
+				auto it = images.find( image );
+				return it == images.end()
+					? dummy
+					: it->second;
+			}
+		};
+		/**
+		*\brief
+		*	The dependencies, indexed by source and destination passes.
+		*/
+		using DependencyIndices = std::map< std::pair< RenderPass const *, RenderPass const * >, size_t >;
 
 		std::ostream & operator<<( std::ostream & stream, PassAttach const & attach )
 		{
@@ -69,6 +126,18 @@ namespace crg
 				sep = ", ";
 			}
 
+			for ( auto & attach : dependency.srcBufferOutputs )
+			{
+				stream << sep << attach.name;
+				sep = ", ";
+			}
+
+			for ( auto & attach : dependency.dstBufferInputs )
+			{
+				stream << sep << attach.name;
+				sep = ", ";
+			}
+
 			stream << "]";
 			return stream;
 		}
@@ -102,134 +171,136 @@ namespace crg
 #endif
 		}
 
-		inline bool isInRange( uint32_t value
-			, uint32_t left
-			, uint32_t count )
-		{
-			return value >= left && value < left + count;
-		}
-
-		inline bool areIntersecting( uint32_t lhsLBound
-			, uint32_t lhsCount
-			, uint32_t rhsLBound
-			, uint32_t rhsCount )
-		{
-			return isInRange( lhsLBound, rhsLBound, rhsCount )
-				|| isInRange( rhsLBound, lhsLBound, lhsCount );
-		}
-		
-		inline bool areIntersecting( VkImageSubresourceRange const & lhs
-			, VkImageSubresourceRange const & rhs )
-		{
-			return areIntersecting( lhs.baseMipLevel
-					, lhs.levelCount
-					, rhs.baseMipLevel
-					, rhs.levelCount )
-				&& areIntersecting( lhs.baseArrayLayer
-					, lhs.layerCount
-					, rhs.baseArrayLayer
-					, lhs.layerCount );
-		}
-
-		inline bool areOverlapping( ImageViewId const & lhs
-			, ImageViewId const & rhs )
-		{
-			return lhs.data->image == rhs.data->image
-				&& areIntersecting( lhs.data->subresourceRange
-					, rhs.data->subresourceRange );
-		}
-
 		void processAttach( Attachment const & attach
 			, RenderPass const & pass
 			, PassAttachCont & cont
-			, std::function< bool( Attachment const & ) > processAttach )
+			, StatsCollector * stats )
 		{
-			bool found{ false };
-			std::vector< RenderPass const * > passes;
+			// The pass is added to the last attachment of the overlapping views, only the ones on the same image can overlap.
+			// The earlier attachments of these views take it in propagatePasses().
+			auto & viewData = cont.graph.getView( attach.view );
+			auto & imageAttaches = cont.images[viewData.image];
 
-			for ( auto & lookup : cont )
+			if ( stats )
 			{
-				if ( processAttach( lookup.attach ) )
-				{
-					if ( lookup.passes.end() == std::find( lookup.passes.begin()
-						, lookup.passes.end()
-						, &pass ) )
-					{
-						lookup.passes.insert( &pass );
-					}
-
-					found = true;
-				}
+				stats->stats.overlapTests += imageAttaches.ranges.size();
 			}
 
-			auto it = std::find_if( cont.begin()
-				, cont.end()
-				, [&attach]( PassAttach const & lookup )
+			forEachOverlap( getViewRange( viewData )
+				, imageAttaches.ranges
+				, [&cont, &imageAttaches, &pass]( size_t view )
 				{
-					return lookup.attach.name == attach.name
-						&& lookup.attach.view == attach.view;
+					cont.attaches[imageAttaches.views[view].second].passes.insert( &pass );
 				} );
 
-			if ( cont.end() == it )
+			auto key = std::make_pair( attach.view, attach.name );
+			auto it = cont.indices.lower_bound( key );
+
+			if ( it == cont.indices.end()
+				|| it->first != key )
 			{
-				cont.push_back( PassAttach{ attach } );
-				it = std::prev( cont.end() );
+				// The attachments on the same view are neighbours in the index, the new one is linked after the last of them.
+				auto index = cont.attaches.size();
+				auto view = InvalidIndex;
+
+				if ( it != cont.indices.end()
+					&& it->first.first == attach.view )
+				{
+					view = cont.attaches[it->second].view;
+				}
+				else if ( it != cont.indices.begin()
+					&& std::prev( it )->first.first == attach.view )
+				{
+					view = cont.attaches[std::prev( it )->second].view;
+				}
+
+				auto range = getViewRange( viewData );
+
+				if ( view == InvalidIndex )
+				{
+					view = imageAttaches.views.size();
+					imageAttaches.views.emplace_back( index, index );
+					imageAttaches.ranges.push_back( range );
+				}
+				else
+				{
+					cont.attaches[imageAttaches.views[view].second].next = index;
+					imageAttaches.views[view].second = index;
+				}
+
+				it = cont.indices.emplace_hint( it, std::move( key ), index );
+				cont.attaches.push_back( PassAttach{ attach, range, view } );
 			}
 
-			it->passes.insert( &pass );
+			cont.attaches[it->second].passes.insert( &pass );
+		}
+		/**
+		*\brief
+		*	Gives each attachment the passes of the later attachments on its view.
+		*\remarks
+		*	processAttach() only adds a pass to the last attachment of a view,
+		*	it is propagated here once, from the last attachment to the first one.
+		*/
+		void propagatePasses( PassAttachCont & cont )
+		{
+			for ( auto index = cont.attaches.size(); index > 0u; --index )
+			{
+				auto & attach = cont.attaches[index - 1u];
+
+				if ( attach.next != InvalidIndex )
+				{
+					auto & next = cont.attaches[attach.next].passes;
+					attach.passes.insert( next.begin(), next.end() );
+				}
+			}
 		}
 
 		void processSampledAttach( Attachment const & attach
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
-			if ( attach.isSampled )
+			if ( attach.isSampled() )
 			{
 				processAttach( attach
 					, pass
 					, cont
-					, [&attach]( Attachment const & lookup )
-					{
-						return areOverlapping( lookup.view, attach.view );
-					} );
+					, stats );
 			}
 		}
 
 		void processColourInputAttach( Attachment const & attach
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
 			if ( attach.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD )
 			{
 				processAttach( attach
 					, pass
 					, cont
-					, [&attach]( Attachment const & lookup )
-					{
-						return areOverlapping( lookup.view, attach.view );
-					} );
+					, stats );
 			}
 		}
 
 		void processColourOutputAttach( Attachment const & attach
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
 			if ( attach.storeOp == VK_ATTACHMENT_STORE_OP_STORE )
 			{
 				return processAttach( attach
 					, pass
 					, cont
-					, [&attach]( Attachment const & lookup )
-					{
-						return areOverlapping( lookup.view, attach.view );
-					} );
+					, stats );
 			}
 		}
 
 		void processDepthStencilInputAttach( Attachment const & attach
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
 			if ( attach.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD
 				|| attach.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD )
@@ -237,16 +308,14 @@ namespace crg
 				processAttach( attach
 					, pass
 					, cont
-					, [&attach]( Attachment const & lookup )
-					{
-						return areOverlapping( lookup.view, attach.view );
-					} );
+					, stats );
 			}
 		}
 
 		void processDepthStencilOutputAttach( Attachment const & attach
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
 			if ( attach.storeOp == VK_ATTACHMENT_STORE_OP_STORE
 				|| attach.stencilStoreOp == VK_ATTACHMENT_STORE_OP_STORE )
@@ -254,48 +323,66 @@ namespace crg
 				processAttach( attach
 					, pass
 					, cont
-					, [&attach]( Attachment const & lookup )
-					{
-						return areOverlapping( lookup.view, attach.view );
-					} );
+					, stats );
 			}
 		}
 
 		void processSampledAttachs( AttachmentArray const & attachs
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
 			for ( auto & attach : attachs )
 			{
-				processSampledAttach( attach, pass, cont );
+				processSampledAttach( attach, pass, cont, stats );
 			}
 		}
 
 		void processColourInputAttachs( AttachmentArray const & attachs
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
 			for ( auto & attach : attachs )
 			{
-				processColourInputAttach( attach, pass, cont );
+				processColourInputAttach( attach, pass, cont, stats );
 			}
 		}
 
 		void processColourOutputAttachs( AttachmentArray const & attachs
 			, RenderPass const & pass
-			, PassAttachCont & cont )
+			, PassAttachCont & cont
+			, StatsCollector * stats )
 		{
 			for ( auto & attach : attachs )
 			{
-				processColourOutputAttach( attach, pass, cont );
+				processColourOutputAttach( attach, pass, cont, stats );
+			}
+		}
+
+		RenderPassDependencies & getDependency( RenderPass const * src
+			, RenderPass const * dst
+			, RenderPassDependenciesArray & dependencies
+			, DependencyIndices & indices )
+		{
+			auto ires = indices.emplace( std::make_pair( src, dst )
+				, dependencies.size() );
+
+			if ( ires.second )
+			{
+				dependencies.push_back( { src, dst } );
 			}
+
+			return dependencies[ires.first->second];
 		}
 
 		void addDependency( Attachment const & outAttach
 			, Attachment const & inAttach
 			, std::set< RenderPass const * > const & srcs
 			, std::set< RenderPass const * > const & dsts
-			, RenderPassDependenciesArray & dependencies )
+			, RenderPassDependenciesArray & dependencies
+			, DependencyIndices & indices
+			, StatsCollector * stats )
 		{
 			for ( auto & src : srcs )
 			{
@@ -303,21 +390,12 @@ namespace crg
 				{
 					if ( src != dst )
 					{
-						auto it = std::find_if( dependencies.begin()
-							, dependencies.end()
-							, [&dst, &src]( RenderPassDependencies & lookup )
-							{
-								return lookup.srcPass == src
-									&& lookup.dstPass == dst;
-							} );
-
-						if ( it == dependencies.end() )
+						if ( stats )
 						{
-							dependencies.push_back( { src, dst } );
-							it = std::prev( dependencies.end() );
+							++stats->stats.dependencyLookups;
 						}
 
-						auto & dep = *it;
+						auto & dep = getDependency( src, dst, dependencies, indices );
 
 						if ( dep.srcOutputs.end() == std::find( dep.srcOutputs.begin()
 								, dep.srcOutputs.end()
@@ -334,54 +412,206 @@ namespace crg
 			}
 		}
 
-		RenderPassDependenciesArray buildPassDependencies( std::vector< RenderPassPtr > const & passes )
+		struct PassBufferAttach
+		{
+			RenderPass const * pass;
+			BufferAttachment const * attach;
+		};
+
+		void addBufferDependency( PassBufferAttach const & src
+			, PassBufferAttach const & dst
+			, RenderPassDependenciesArray & dependencies
+			, DependencyIndices & indices
+			, StatsCollector * stats )
+		{
+			if ( stats )
+			{
+				++stats->stats.dependencyLookups;
+			}
+
+			auto & dep = getDependency( src.pass, dst.pass, dependencies, indices );
+			dep.srcBufferOutputs.push_back( *src.attach );
+			dep.dstBufferInputs.push_back( *dst.attach );
+		}
+		/**
+		*\brief
+		*	Links the passes using overlapping ranges of a buffer, following their registration order.
+		*\remarks
+		*	A write is followed by the later reads (read after write) and writes (write after write).
+		*	A read is followed by the later writes (write after read), unless no write precedes it:
+		*	it then reads what the later writes produce, and follows them.
+		*	Since two reads aren't linked, a read is only tested against the writes preceding it,
+		*	and the buffers without writes aren't tested at all.
+		*/
+		void buildBufferDependencies( RenderGraph const & graph
+			, std::vector< RenderPassPtr > const & passes
+			, RenderPassDependenciesArray & dependencies
+			, DependencyIndices & indices
+			, StatsCollector * stats )
+		{
+			std::map< BufferId, std::vector< PassBufferAttach > > buffers;
+
+			for ( auto & pass : passes )
+			{
+				for ( auto & attach : pass->buffers )
+				{
+					buffers[attach.buffer].push_back( { pass.get(), &attach } );
+				}
+			}
+
+			std::vector< bool > writtenBefore;
+			std::vector< size_t > writes;
+
+			for ( auto & buffer : buffers )
+			{
+				auto & attaches = buffer.second;
+				writtenBefore.assign( attaches.size(), false );
+				writes.clear();
+
+				for ( size_t dstIndex = 0u; dstIndex < attaches.size(); ++dstIndex )
+				{
+					auto & dst = attaches[dstIndex];
+					auto process = [&]( size_t srcIndex )
+					{
+						auto & src = attaches[srcIndex];
+
+						if ( src.pass == dst.pass
+							|| !areOverlapping( graph, *src.attach, *dst.attach ) )
+						{
+							return;
+						}
+
+						if ( src.attach->isWrite() )
+						{
+							writtenBefore[dstIndex] = true;
+							addBufferDependency( src, dst, dependencies, indices, stats );
+						}
+						else if ( writtenBefore[srcIndex] )
+						{
+							addBufferDependency( src, dst, dependencies, indices, stats );
+						}
+						else
+						{
+							addBufferDependency( dst, src, dependencies, indices, stats );
+						}
+					};
+
+					if ( dst.attach->isWrite() )
+					{
+						if ( stats )
+						{
+							stats->stats.overlapTests += dstIndex;
+						}
+
+						for ( size_t srcIndex = 0u; srcIndex < dstIndex; ++srcIndex )
+						{
+							process( srcIndex );
+						}
+
+						writes.push_back( dstIndex );
+					}
+					else
+					{
+						if ( stats )
+						{
+							stats->stats.overlapTests += writes.size();
+						}
+
+						for ( auto srcIndex : writes )
+						{
+							process( srcIndex );
+						}
+					}
+				}
+			}
+		}
+
+		RenderPassDependenciesArray buildPassDependencies( RenderGraph const & graph
+			, std::vector< RenderPassPtr > const & passes
+			, StatsCollector * stats )
 		{
-			PassAttachCont sampled;
-			PassAttachCont inputs;
-			PassAttachCont outputs;
+			PassAttachCont sampled{ graph };
+			PassAttachCont inputs{ graph };
+			PassAttachCont outputs{ graph };
 
 			for ( auto & pass : passes )
 			{
-				processSampledAttachs( pass->sampled, *pass, sampled );
-				processColourInputAttachs( pass->colourInOuts, *pass, inputs );
-				processColourOutputAttachs( pass->colourInOuts, *pass, outputs );
+				processSampledAttachs( pass->sampled, *pass, sampled, stats );
+				processColourInputAttachs( pass->colourInOuts, *pass, inputs, stats );
+				processColourOutputAttachs( pass->colourInOuts, *pass, outputs, stats );
+				// Storage images and transfer attachments follow the same load/store rules as colour ones.
+				processColourInputAttachs( pass->storages, *pass, inputs, stats );
+				processColourOutputAttachs( pass->storages, *pass, outputs, stats );
+				processColourInputAttachs( pass->transfers, *pass, inputs, stats );
+				processColourOutputAttachs( pass->transfers, *pass, outputs, stats );
 
 				if ( pass->depthStencilInOut )
 				{
-					processDepthStencilInputAttach( *pass->depthStencilInOut, *pass, inputs );
-					processDepthStencilOutputAttach( *pass->depthStencilInOut, *pass, outputs );
+					processDepthStencilInputAttach( *pass->depthStencilInOut, *pass, inputs, stats );
+					processDepthStencilOutputAttach( *pass->depthStencilInOut, *pass, outputs, stats );
 				}
 			}
 
+			propagatePasses( sampled );
+			propagatePasses( inputs );
+			propagatePasses( outputs );
+
 			RenderPassDependenciesArray result;
+			DependencyIndices indices;
+			std::vector< size_t > overlapping;
 
 			for ( auto & output : outputs )
 			{
-				for ( auto & input : inputs )
+				// Only the inputs on the same image can overlap, they are processed in registration order.
+				for ( auto cont : { &inputs, &sampled } )
 				{
-					if ( details::areOverlapping( output.attach.view, input.attach.view ) )
+					auto & imageAttaches = cont->getImageAttaches( graph.getView( output.attach.view ).image );
+
+					if ( stats )
 					{
-						details::addDependency( output.attach
-							, input.attach
-							, output.passes
-							, input.passes
-							, result );
+						stats->stats.overlapTests += imageAttaches.ranges.size();
 					}
-				}
 
-				for ( auto & sample : sampled )
-				{
-					if ( details::areOverlapping( output.attach.view, sample.attach.view ) )
+					overlapping.clear();
+					size_t views{};
+					forEachOverlap( output.range
+						, imageAttaches.ranges
+						, [cont, &imageAttaches, &overlapping, &views]( size_t view )
+						{
+							for ( auto index = imageAttaches.views[view].first; index != InvalidIndex; index = cont->attaches[index].next )
+							{
+								overlapping.push_back( index );
+							}
+
+							++views;
+						} );
+
+					if ( views > 1u )
 					{
+						std::sort( overlapping.begin(), overlapping.end() );
+					}
+
+					for ( auto index : overlapping )
+					{
+						auto & input = cont->attaches[index];
 						details::addDependency( output.attach
-							, sample.attach
+							, input.attach
 							, output.passes
-							, sample.passes
-							, result );
+							, input.passes
+							, result
+							, indices
+							, stats );
 					}
 				}
 			}
 
+			buildBufferDependencies( graph, passes, result, indices, stats );
+
+			if ( stats )
+			{
+				stats->stats.dependenciesCreated += result.size();
+			}
+
 			printDebug( sampled, inputs, outputs, result );
 			return result;
 		}
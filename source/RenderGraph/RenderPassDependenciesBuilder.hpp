@@ -4,6 +4,11 @@ See LICENSE file in root folder.
 */
 #pragma once
 
+#include "OverlapKernel.hpp"
+#include "PhaseTimer.hpp"
+
+#include "RenderGraph/BufferData.hpp"
+#include "RenderGraph/RenderGraph.hpp"
 #include "RenderGraph/RenderPassDependencies.hpp"
 
 #include <functional>
@@ -12,7 +17,75 @@ namespace crg
 {
 	namespace details
 	{
-		RenderPassDependenciesArray buildPassDependencies( std::vector< RenderPassPtr > const & passes );
+		RenderPassDependenciesArray buildPassDependencies( RenderGraph const & graph
+			, std::vector< RenderPassPtr > const & passes
+			, StatsCollector * stats = nullptr );
+
+		/**
+		*\brief
+		*	Empty ranges never intersect, VK_REMAINING_* counts reach the end of the resource.
+		*/
+		inline bool areIntersecting( uint32_t lhsLBound
+			, uint32_t lhsCount
+			, uint32_t rhsLBound
+			, uint32_t rhsCount )
+		{
+			return std::max( lhsLBound, rhsLBound )
+				< std::min( getRangeEnd( lhsLBound, lhsCount ), getRangeEnd( rhsLBound, rhsCount ) );
+		}
+
+		inline bool areIntersecting( VkImageSubresourceRange const & lhs
+			, VkImageSubresourceRange const & rhs )
+		{
+			return areIntersecting( lhs.baseMipLevel
+					, lhs.levelCount
+					, rhs.baseMipLevel
+					, rhs.levelCount )
+				&& areIntersecting( lhs.baseArrayLayer
+					, lhs.layerCount
+					, rhs.baseArrayLayer
+					, rhs.layerCount );
+		}
+
+		inline bool isInRange( VkDeviceSize value
+			, VkDeviceSize left
+			, VkDeviceSize count )
+		{
+			// Written so that left + count can't overflow.
+			return value >= left && value - left < count;
+		}
+
+		inline bool areIntersecting( VkDeviceSize lhsLBound
+			, VkDeviceSize lhsCount
+			, VkDeviceSize rhsLBound
+			, VkDeviceSize rhsCount )
+		{
+			return isInRange( lhsLBound, rhsLBound, rhsCount )
+				|| isInRange( rhsLBound, lhsLBound, lhsCount );
+		}
+
+		/**
+		*\brief
+		*	The size of the attachment range, clamped to the end of its buffer (VK_WHOLE_SIZE reaching it).
+		*/
+		inline VkDeviceSize getSize( RenderGraph const & graph
+			, BufferAttachment const & attach )
+		{
+			auto size = graph.getBuffer( attach.buffer ).size;
+			auto remaining = size - std::min( attach.offset, size );
+			return std::min( attach.range, remaining );
+		}
+
+		inline bool areOverlapping( RenderGraph const & graph
+			, BufferAttachment const & lhs
+			, BufferAttachment const & rhs )
+		{
+			return lhs.buffer == rhs.buffer
+				&& areIntersecting( lhs.offset
+					, getSize( graph, lhs )
+					, rhs.offset
+					, getSize( graph, rhs ) );
+		}
 
 		template< typename TypeT >
 		void filter( std::vector< TypeT > const & inputs
@@ -0,0 +1,206 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/ThreadPool.hpp"
+
+namespace crg
+{
+	ThreadPool::ThreadPool( uint32_t threadCount )
+	{
+		m_ranges.reserve( threadCount + 1u );
+
+		for ( uint32_t thread = 0u; thread <= threadCount; ++thread )
+		{
+			m_ranges.push_back( std::make_unique< Range >() );
+		}
+
+		m_threads.reserve( threadCount );
+
+		for ( uint32_t thread = 1u; thread <= threadCount; ++thread )
+		{
+			m_threads.emplace_back( [this, thread]()
+				{
+					doWorkerLoop( thread );
+				} );
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_stopped = true;
+		}
+
+		m_wakeWorkers.notify_all();
+
+		for ( auto & thread : m_threads )
+		{
+			thread.join();
+		}
+	}
+
+	void ThreadPool::parallelFor( uint32_t count
+		, JobFunc const & func )
+	{
+		if ( !count )
+		{
+			return;
+		}
+
+		auto threadCount = getThreadCount();
+
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_func = &func;
+			m_exception = nullptr;
+
+			for ( uint32_t thread = 0u; thread < threadCount; ++thread )
+			{
+				auto & range = *m_ranges[thread];
+				std::lock_guard< std::mutex > rangeLock( range.mutex );
+				range.begin = uint32_t( ( uint64_t( count ) * thread ) / threadCount );
+				range.end = uint32_t( ( uint64_t( count ) * ( thread + 1u ) ) / threadCount );
+			}
+
+			m_busyWorkers = uint32_t( m_threads.size() );
+			++m_generation;
+		}
+
+		m_wakeWorkers.notify_all();
+		doWork( 0u );
+		std::exception_ptr exception;
+
+		{
+			std::unique_lock< std::mutex > lock( m_mutex );
+			m_wakeCaller.wait( lock
+				, [this]()
+				{
+					return m_busyWorkers == 0u;
+				} );
+			m_func = nullptr;
+			std::swap( exception, m_exception );
+		}
+
+		if ( exception )
+		{
+			std::rethrow_exception( exception );
+		}
+	}
+
+	void ThreadPool::doWork( uint32_t thread )
+	{
+		uint32_t index{};
+
+		while ( doPopJob( thread, index )
+			|| ( doStealJobs( thread ) && doPopJob( thread, index ) ) )
+		{
+			doRunJob( index, thread );
+		}
+	}
+
+	bool ThreadPool::doPopJob( uint32_t thread
+		, uint32_t & index )
+	{
+		auto & range = *m_ranges[thread];
+		std::lock_guard< std::mutex > lock( range.mutex );
+
+		if ( range.begin == range.end )
+		{
+			return false;
+		}
+
+		index = range.begin++;
+		return true;
+	}
+
+	bool ThreadPool::doStealJobs( uint32_t thread )
+	{
+		auto threadCount = getThreadCount();
+
+		for ( uint32_t offset = 1u; offset < threadCount; ++offset )
+		{
+			auto & victim = *m_ranges[( thread + offset ) % threadCount];
+			uint32_t begin{};
+			uint32_t end{};
+
+			{
+				std::lock_guard< std::mutex > lock( victim.mutex );
+				auto remaining = victim.end - victim.begin;
+
+				if ( remaining )
+				{
+					// Take the back half, the victim keeps consuming its front.
+					end = victim.end;
+					begin = end - ( remaining + 1u ) / 2u;
+					victim.end = begin;
+				}
+			}
+
+			if ( begin != end )
+			{
+				auto & range = *m_ranges[thread];
+				std::lock_guard< std::mutex > lock( range.mutex );
+				range.begin = begin;
+				range.end = end;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ThreadPool::doRunJob( uint32_t index
+		, uint32_t thread )
+	{
+		try
+		{
+			( *m_func )( index, thread );
+		}
+		catch ( ... )
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+
+			if ( !m_exception )
+			{
+				m_exception = std::current_exception();
+			}
+		}
+	}
+
+	void ThreadPool::doWorkerLoop( uint32_t thread )
+	{
+		uint64_t generation{};
+
+		while ( true )
+		{
+			{
+				std::unique_lock< std::mutex > lock( m_mutex );
+				m_wakeWorkers.wait( lock
+					, [this, &generation]()
+					{
+						return m_stopped || m_generation != generation;
+					} );
+
+				if ( m_stopped )
+				{
+					return;
+				}
+
+				generation = m_generation;
+			}
+
+			doWork( thread );
+
+			{
+				std::lock_guard< std::mutex > lock( m_mutex );
+
+				if ( !--m_busyWorkers )
+				{
+					m_wakeCaller.notify_one();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,403 @@
+﻿/*
+This file belongs to RenderGraph.
+See LICENSE file in root folder.
+*/
+#include "RenderGraph/TraceExport.hpp"
+
+#include "RenderGraph/Exception.hpp"
+#include "RenderGraph/RenderGraph.hpp"
+#include "RenderGraph/RenderPass.hpp"
+#include "RenderGraph/RenderPassDependencies.hpp"
+
+#include <iomanip>
+#include <ostream>
+#include <unordered_map>
+
+namespace crg
+{
+	namespace
+	{
+		enum ProcessId : uint32_t
+		{
+			CompileProcess = 1u,
+			FrameProcess = 2u,
+		};
+
+		char const * getQueueName( RenderPass::Kind kind )
+		{
+			switch ( kind )
+			{
+			case RenderPass::Kind::Graphics:
+				return "Graphics queue";
+			case RenderPass::Kind::Compute:
+				return "Compute queue";
+			case RenderPass::Kind::Transfer:
+				return "Transfer queue";
+			default:
+				return "Unknown queue";
+			}
+		}
+
+		uint32_t getQueueId( RenderPass::Kind kind )
+		{
+			return uint32_t( kind ) + 1u;
+		}
+
+		class TraceWriter
+		{
+		public:
+			explicit TraceWriter( std::ostream & stream )
+				: m_stream{ stream }
+			{
+				m_flags = m_stream.flags();
+				m_precision = m_stream.precision();
+				m_stream << std::fixed << std::setprecision( 3 );
+				m_stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+			}
+
+			~TraceWriter()
+			{
+				m_stream << "\n]}\n";
+				m_stream.flags( m_flags );
+				m_stream.precision( m_precision );
+			}
+
+			TraceWriter( TraceWriter const & ) = delete;
+			TraceWriter & operator=( TraceWriter const & ) = delete;
+
+			void writeProcessName( uint32_t pid
+				, std::string const & name )
+			{
+				doBeginEvent( "M", "process_name", pid, 0u );
+				m_stream << ",\"args\":{\"name\":";
+				doWriteString( name );
+				m_stream << "}}";
+			}
+
+			void writeThreadName( uint32_t pid
+				, uint32_t tid
+				, std::string const & name )
+			{
+				doBeginEvent( "M", "thread_name", pid, tid );
+				m_stream << ",\"args\":{\"name\":";
+				doWriteString( name );
+				m_stream << "}}";
+			}
+			/**
+			*\brief
+			*	Begins a complete event, the caller may add fields, and must call endEvent().
+			*/
+			void beginSlice( std::string const & name
+				, uint32_t pid
+				, uint32_t tid
+				, std::chrono::nanoseconds ts
+				, std::chrono::nanoseconds dur )
+			{
+				doBeginEvent( "X", name, pid, tid );
+				m_stream << ",\"ts\":" << toMicroseconds( ts )
+					<< ",\"dur\":" << toMicroseconds( dur );
+			}
+
+			void writeArg( char const * name
+				, uint64_t value
+				, bool first = false )
+			{
+				m_stream << ( first ? ",\"args\":{" : "," ) << "\"" << name << "\":" << value;
+			}
+
+			void endArgs()
+			{
+				m_stream << "}";
+			}
+
+			void endEvent()
+			{
+				m_stream << "}";
+			}
+
+			void writeFlow( char const * category
+				, uint32_t pid
+				, uint32_t srcTid
+				, std::chrono::nanoseconds srcTs
+				, uint32_t dstTid
+				, std::chrono::nanoseconds dstTs )
+			{
+				auto id = ++m_flowId;
+				doBeginEvent( "s", category, pid, srcTid );
+				m_stream << ",\"cat\":\"" << category << "\""
+					<< ",\"id\":" << id
+					<< ",\"ts\":" << toMicroseconds( srcTs ) << "}";
+				doBeginEvent( "f", category, pid, dstTid );
+				m_stream << ",\"cat\":\"" << category << "\""
+					<< ",\"id\":" << id
+					<< ",\"bp\":\"e\""
+					<< ",\"ts\":" << toMicroseconds( dstTs ) << "}";
+			}
+
+		private:
+			static double toMicroseconds( std::chrono::nanoseconds value )
+			{
+				return double( value.count() ) / 1000.0;
+			}
+
+			void doBeginEvent( char const * phase
+				, std::string const & name
+				, uint32_t pid
+				, uint32_t tid )
+			{
+				m_stream << ( m_first ? "\n" : ",\n" );
+				m_first = false;
+				m_stream << "{\"ph\":\"" << phase << "\",\"name\":";
+				doWriteString( name );
+				m_stream << ",\"pid\":" << pid << ",\"tid\":" << tid;
+			}
+
+			void doWriteString( std::string const & value )
+			{
+				static char const * const hex = "0123456789abcdef";
+				m_stream << '"';
+
+				for ( auto c : value )
+				{
+					switch ( c )
+					{
+					case '"':
+						m_stream << "\\\"";
+						break;
+					case '\\':
+						m_stream << "\\\\";
+						break;
+					case '\n':
+						m_stream << "\\n";
+						break;
+					case '\t':
+						m_stream << "\\t";
+						break;
+					default:
+						if ( uint8_t( c ) < 0x20u )
+						{
+							m_stream << "\\u00" << hex[uint8_t( c ) >> 4] << hex[uint8_t( c ) & 0x0Fu];
+						}
+						else
+						{
+							m_stream << c;
+						}
+						break;
+					}
+				}
+
+				m_stream << '"';
+			}
+
+		private:
+			std::ostream & m_stream;
+			std::ios_base::fmtflags m_flags;
+			std::streamsize m_precision;
+			bool m_first{ true };
+			uint64_t m_flowId{};
+		};
+
+		void writeCompileEvents( TraceWriter & writer
+			, CompileStats const & stats )
+		{
+			writer.writeProcessName( CompileProcess, "compile" );
+			writer.writeThreadName( CompileProcess, 1u, "RenderGraph::compile" );
+			writer.beginSlice( "compile"
+				, CompileProcess
+				, 1u
+				, std::chrono::nanoseconds{}
+				, stats.totalTime );
+			writer.writeArg( "fromCache", stats.fromCache ? 1u : 0u, true );
+			writer.writeArg( "allocations", stats.allocations );
+			writer.writeArg( "allocatedBytes", stats.allocatedBytes );
+			writer.writeArg( "overlapTests", stats.overlapTests );
+			writer.writeArg( "dependencyLookups", stats.dependencyLookups );
+			writer.writeArg( "graphVisits", stats.graphVisits );
+			writer.writeArg( "dependenciesCreated", stats.dependenciesCreated );
+			writer.writeArg( "dependenciesAfterReduction", stats.dependenciesAfterReduction );
+			writer.writeArg( "transitionsBeforeMerges", stats.transitionsBeforeMerges );
+			writer.writeArg( "transitionsAfterMergeIdentical", stats.transitionsAfterMergeIdentical );
+			writer.writeArg( "transitionsAfterMergePerInput", stats.transitionsAfterMergePerInput );
+			writer.writeArg( "transitionsAfterReduceDirectPaths", stats.transitionsAfterReduceDirectPaths );
+			writer.endArgs();
+			writer.endEvent();
+			// The phases run one after the other, in enumeration order.
+			std::chrono::nanoseconds ts{};
+
+			for ( size_t index = 0u; index < size_t( CompilePhase::Count ); ++index )
+			{
+				auto time = stats.phaseTimes[index];
+
+				if ( time.count() > 0 )
+				{
+					writer.beginSlice( getName( CompilePhase( index ) )
+						, CompileProcess
+						, 1u
+						, ts
+						, time );
+					writer.writeArg( "allocations", stats.phaseAllocations[index], true );
+					writer.writeArg( "allocatedBytes", stats.phaseAllocatedBytes[index] );
+					writer.endArgs();
+					writer.endEvent();
+					ts += time;
+				}
+			}
+		}
+
+		void checkPassTimes( RenderGraph const & graph
+			, PassTimeArray const & passTimes )
+		{
+			if ( passTimes.size() != graph.getExecutionOrder().size() )
+			{
+				CRG_Exception( "Pass times count doesn't match the execution order." );
+			}
+		}
+
+		void writeScheduleEvents( TraceWriter & writer
+			, RenderGraph const & graph
+			, PassTimeArray const & passTimes )
+		{
+			auto & order = graph.getExecutionOrder();
+			std::unordered_map< RenderPass const *, uint32_t > indices;
+
+			for ( uint32_t index = 0u; index < order.size(); ++index )
+			{
+				indices.emplace( order[index], index );
+			}
+
+			std::vector< std::vector< uint32_t > > sources( order.size() );
+
+			for ( auto & dependency : graph.getDependencies() )
+			{
+				// The passes are already synchronised through other dependencies.
+				if ( dependency.redundant )
+				{
+					continue;
+				}
+
+				auto src = indices.find( dependency.srcPass );
+				auto dst = indices.find( dependency.dstPass );
+
+				if ( src != indices.end()
+					&& dst != indices.end() )
+				{
+					auto & dstSources = sources[dst->second];
+
+					if ( dstSources.end() == std::find( dstSources.begin(), dstSources.end(), src->second ) )
+					{
+						dstSources.push_back( src->second );
+					}
+				}
+			}
+
+			// Simulate the frame: a pass starts when its queue is free and its sources are done.
+			std::vector< std::chrono::nanoseconds > starts( order.size() );
+			std::vector< std::chrono::nanoseconds > ends( order.size() );
+			// The position of each pass in its queue.
+			std::vector< uint32_t > queueIndices( order.size() );
+			std::map< uint32_t, std::chrono::nanoseconds > queueEnds;
+			std::map< uint32_t, uint32_t > queueCounts;
+
+			for ( uint32_t index = 0u; index < order.size(); ++index )
+			{
+				auto queue = getQueueId( order[index]->kind );
+				auto start = queueEnds[queue];
+
+				for ( auto source : sources[index] )
+				{
+					start = std::max( start, ends[source] );
+				}
+
+				starts[index] = start;
+				ends[index] = start + passTimes[index];
+				queueEnds[queue] = ends[index];
+				queueIndices[index] = queueCounts[queue]++;
+			}
+
+			writer.writeProcessName( FrameProcess, "frame" );
+
+			for ( auto & queue : queueCounts )
+			{
+				writer.writeThreadName( FrameProcess
+					, queue.first
+					, getQueueName( RenderPass::Kind( queue.first - 1u ) ) );
+			}
+
+			auto & barriers = graph.getBarriers();
+
+			for ( uint32_t index = 0u; index < order.size(); ++index )
+			{
+				writer.beginSlice( order[index]->name
+					, FrameProcess
+					, getQueueId( order[index]->kind )
+					, starts[index]
+					, passTimes[index] );
+				writer.writeArg( "index", index, true );
+
+				if ( index < barriers.size() )
+				{
+					writer.writeArg( "imageBarriers", barriers[index].images.size() );
+					writer.writeArg( "bufferBarriers", barriers[index].buffers.size() );
+				}
+
+				writer.endArgs();
+				writer.endEvent();
+			}
+
+			for ( uint32_t index = 0u; index < order.size(); ++index )
+			{
+				auto dstQueue = getQueueId( order[index]->kind );
+
+				for ( auto source : sources[index] )
+				{
+					auto srcQueue = getQueueId( order[source]->kind );
+
+					if ( srcQueue != dstQueue )
+					{
+						writer.writeFlow( "semaphore"
+							, FrameProcess
+							, srcQueue
+							, starts[source]
+							, dstQueue
+							, starts[index] );
+					}
+					else if ( queueIndices[index] > queueIndices[source] + 1u )
+					{
+						writer.writeFlow( "splitBarrier"
+							, FrameProcess
+							, srcQueue
+							, starts[source]
+							, dstQueue
+							, starts[index] );
+					}
+				}
+			}
+		}
+	}
+
+	void writeCompileTrace( std::ostream & stream
+		, CompileStats const & stats )
+	{
+		TraceWriter writer{ stream };
+		writeCompileEvents( writer, stats );
+	}
+
+	void writeScheduleTrace( std::ostream & stream
+		, RenderGraph const & graph
+		, PassTimeArray const & passTimes )
+	{
+		checkPassTimes( graph, passTimes );
+		TraceWriter writer{ stream };
+		writeScheduleEvents( writer, graph, passTimes );
+	}
+
+	void writeTrace( std::ostream & stream
+		, RenderGraph const & graph
+		, PassTimeArray const & passTimes )
+	{
+		checkPassTimes( graph, passTimes );
+		TraceWriter writer{ stream };
+		writeCompileEvents( writer, graph.getCompileStats() );
+		writeScheduleEvents( writer, graph, passTimes );
+	}
+}
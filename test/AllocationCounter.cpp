@@ -0,0 +1,150 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace test
+{
+	namespace
+	{
+		// Every block is prefixed with its size, so that live bytes can be tracked.
+		// The prefix is padded to the block alignment, its size being stored at its end, just before the returned pointer.
+		static size_t constexpr HeaderSize = alignof( std::max_align_t );
+
+		std::atomic< uint64_t > allocations{};
+		std::atomic< uint64_t > allocatedBytes{};
+		std::atomic< int64_t > liveBytes{};
+		std::atomic< int64_t > peakBytes{};
+
+		size_t getHeaderSize( size_t alignment )
+		{
+			return alignment > HeaderSize
+				? alignment
+				: HeaderSize;
+		}
+
+		void * allocate( size_t size
+			, size_t alignment = HeaderSize )
+		{
+			auto headerSize = getHeaderSize( alignment );
+			auto block = static_cast< uint8_t * >( alignment > HeaderSize
+				? std::aligned_alloc( alignment, ( ( size + headerSize + alignment - 1u ) / alignment ) * alignment )
+				: std::malloc( size + headerSize ) );
+
+			if ( !block )
+			{
+				return nullptr;
+			}
+
+			auto result = block + headerSize;
+			*( reinterpret_cast< size_t * >( result ) - 1 ) = size;
+			++allocations;
+			allocatedBytes += size;
+			auto live = liveBytes += int64_t( size );
+			auto peak = peakBytes.load();
+
+			while ( live > peak
+				&& !peakBytes.compare_exchange_weak( peak, live ) )
+			{
+			}
+
+			return result;
+		}
+
+		void deallocate( void * ptr
+			, size_t alignment = HeaderSize )
+		{
+			if ( ptr )
+			{
+				auto data = static_cast< uint8_t * >( ptr );
+				liveBytes -= int64_t( *( reinterpret_cast< size_t * >( data ) - 1 ) );
+				std::free( data - getHeaderSize( alignment ) );
+			}
+		}
+	}
+
+	crg::AllocationCount getAllocationCount()
+	{
+		return { allocations.load(), allocatedBytes.load() };
+	}
+
+	int64_t getLiveBytes()
+	{
+		return liveBytes.load();
+	}
+
+	int64_t getPeakBytes()
+	{
+		return peakBytes.load();
+	}
+
+	void resetPeakBytes()
+	{
+		peakBytes = liveBytes.load();
+	}
+}
+
+void * operator new( size_t size )
+{
+	if ( auto result = test::allocate( size ) )
+	{
+		return result;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void operator delete( void * ptr )noexcept
+{
+	test::deallocate( ptr );
+}
+
+void operator delete( void * ptr, size_t )noexcept
+{
+	test::deallocate( ptr );
+}
+
+void * operator new( size_t size
+	, std::align_val_t alignment )
+{
+	if ( auto result = test::allocate( size, size_t( alignment ) ) )
+	{
+		return result;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void * operator new[]( size_t size
+	, std::align_val_t alignment )
+{
+	return operator new( size, alignment );
+}
+
+void operator delete( void * ptr
+	, std::align_val_t alignment )noexcept
+{
+	test::deallocate( ptr, size_t( alignment ) );
+}
+
+void operator delete( void * ptr
+	, size_t
+	, std::align_val_t alignment )noexcept
+{
+	test::deallocate( ptr, size_t( alignment ) );
+}
+
+void operator delete[]( void * ptr
+	, std::align_val_t alignment )noexcept
+{
+	test::deallocate( ptr, size_t( alignment ) );
+}
+
+void operator delete[]( void * ptr
+	, size_t
+	, std::align_val_t alignment )noexcept
+{
+	test::deallocate( ptr, size_t( alignment ) );
+}
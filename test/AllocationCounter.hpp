@@ -0,0 +1,47 @@
+#pragma once
+
+#include <RenderGraph/CompileStats.hpp>
+
+namespace test
+{
+	/**
+	*\brief
+	*	The allocations made through the global operator new, since the process start.
+	*\remarks
+	*	Only available in the executables linking AllocationCounter.cpp, which replaces the global operator new and delete.
+	*/
+	crg::AllocationCount getAllocationCount();
+	/**
+	*\return
+	*	The size of the blocks currently allocated.
+	*/
+	int64_t getLiveBytes();
+	/**
+	*\return
+	*	The highest live bytes since the last resetPeakBytes() call.
+	*/
+	int64_t getPeakBytes();
+	void resetPeakBytes();
+	/**
+	*\brief
+	*	Counts the allocations made during its lifetime, by any thread.
+	*/
+	class AllocationScope
+	{
+	public:
+		AllocationScope()
+			: m_begin{ getAllocationCount() }
+		{
+		}
+
+		crg::AllocationCount getCount()const
+		{
+			auto end = getAllocationCount();
+			return { end.allocations - m_begin.allocations
+				, end.bytes - m_begin.bytes };
+		}
+
+	private:
+		crg::AllocationCount m_begin;
+	};
+}
@@ -1,6 +1,6 @@
 #include "Common.hpp"
 
-#include <RenderGraph/GraphVisitor.hpp>
+#include <RenderGraph/GraphVisit.hpp>
 #include <RenderGraph/ImageData.hpp>
 #include <RenderGraph/ImageViewData.hpp>
 #include <RenderGraph/RenderGraph.hpp>
@@ -35,22 +35,24 @@ namespace test
 		}
 
 		class DotOutVisitor
-			: public crg::GraphVisitor
 		{
 		public:
 			static void submit( std::ostream & stream
-				, crg::GraphAdjacentNode node
-				, std::set< crg::GraphNode const * > & visited )
+				, crg::RenderGraph & graph )
 			{
-				DotOutVisitor vis{ stream, visited };
-				node->accept( &vis );
-			}
+				DotOutVisitor vis{ stream };
+				crg::GraphTraversal traversal{ graph };
 
-			static void submit( std::ostream & stream
-				, crg::GraphAdjacentNode node )
-			{
-				std::set< crg::GraphNode const * > visited;
-				submit( stream, node, visited );
+				crg::visit( traversal.depthFirst()
+					, [&vis]( crg::RootNode & node )
+					{
+						vis.visitRootNode( node );
+					}
+					, [&vis]( crg::RenderPassNode & node )
+					{
+						vis.visitRenderPassNode( node );
+					} );
+				stream << "}\n";
 			}
 
 			static void submit( std::ostream & stream
@@ -82,10 +84,8 @@ namespace test
 			}
 
 		private:
-			DotOutVisitor( std::ostream & stream
-				, std::set< crg::GraphNode const * > & visited )
+			DotOutVisitor( std::ostream & stream )
 				: m_stream{ stream }
-				, m_visited{ visited }
 			{
 			}
 
@@ -112,53 +112,30 @@ namespace test
 				}
 			}
 
-			void submit( crg::GraphNode * node )
+			void visitRootNode( crg::RootNode & node )
 			{
-				submit( m_stream
-					, node
-					, m_visited );
+				m_stream << "digraph \"" << node.getName() << "\" {\n";
 			}
 
-			void visitRootNode( crg::RootNode * node )override
+			void visitRenderPassNode( crg::RenderPassNode & node )
 			{
-				m_stream << "digraph \"" << node->getName() << "\" {\n";
-
-				for ( auto & next : node->getNext() )
+				for ( auto & next : node.getNext() )
 				{
-					submit( next );
-				}
-
-				m_stream << "}\n";
-			}
-
-			void visitRenderPassNode( crg::RenderPassNode * node )override
-			{
-				m_visited.insert( node );
-				auto nexts = node->getNext();
-
-				for ( auto & next : nexts )
-				{
-					printEdge( node, next );
-
-					if ( m_visited.end() == m_visited.find( next ) )
-					{
-						submit( next );
-					}
+					printEdge( &node, next );
 				}
 			}
 
 		private:
 			std::ostream & m_stream;
-			std::set< crg::GraphNode const * > & m_visited;
 		};
 
 		void displayPasses( TestCounts & testCounts
 			, std::ostream & stream
 			, crg::RenderGraph & value )
 		{
-			DotOutVisitor::submit( stream, value.getGraph() );
+			DotOutVisitor::submit( stream, value );
 			std::ofstream file{ testCounts.testName + ".dot" };
-			DotOutVisitor::submit( file, value.getGraph() );
+			DotOutVisitor::submit( file, value );
 		}
 
 		void displayTransitions( TestCounts & testCounts
@@ -25,6 +25,6 @@ namespace test
 	template< typename TypeT >
 	crg::Id< TypeT > makeId( TypeT const & data )
 	{
-		return { 0u, nullptr };
+		return { 0u, 0u };
 	}
 }
@@ -0,0 +1,536 @@
+#include "GraphGenerator.hpp"
+
+#include "Common.hpp"
+
+#include <RenderGraph/ImageData.hpp>
+#include <RenderGraph/ImageViewData.hpp>
+#include <RenderGraph/RenderGraph.hpp>
+#include <RenderGraph/RenderPass.hpp>
+
+#include <optional>
+#include <random>
+
+namespace test
+{
+	namespace
+	{
+		static VkFormat constexpr Format = VK_FORMAT_R16G16B16A16_SFLOAT;
+		static uint32_t constexpr MipLevels = 10u;
+		static uint32_t constexpr RingSize = 4u;
+
+		class Generator
+		{
+		public:
+			explicit Generator( crg::RenderGraph & graph
+				, bool sampledPerPass = false )
+				: m_graph{ graph }
+				, m_sampledPerPass{ sampledPerPass }
+			{
+			}
+
+			crg::ImageViewId createView( uint32_t mipLevels = 1u )
+			{
+				auto image = m_graph.createImage( test::createImage( Format, mipLevels ) );
+				return m_graph.createView( test::createView( image, Format ) );
+			}
+
+			crg::ImageViewId createView( crg::ImageId image
+				, uint32_t mipLevel )
+			{
+				return m_graph.createView( test::createView( image, Format, mipLevel ) );
+			}
+
+			void addPass( std::vector< crg::ImageViewId > const & inputs
+				, std::vector< crg::ImageViewId > const & outputs
+				, crg::BufferAttachmentArray const & buffers = {} )
+			{
+				auto name = std::to_string( m_passCount++ );
+				crg::AttachmentArray sampled;
+				crg::AttachmentArray colours;
+
+				// Like in the hand written graphs, the passes sampling a view share the same attachment, unless asked otherwise.
+				for ( auto & input : inputs )
+				{
+					sampled.push_back( crg::Attachment::createSampled( "Sp" + std::to_string( input.id ) + ( m_sampledPerPass ? "_" + name : std::string{} )
+						, input ) );
+				}
+
+				for ( auto & output : outputs )
+				{
+					colours.push_back( crg::Attachment::createOutputColour( "Tg" + std::to_string( output.id )
+						, output ) );
+				}
+
+				m_graph.add( crg::RenderPass{ "pass" + name
+					, sampled
+					, colours
+					, std::nullopt
+					, buffers } );
+			}
+
+			uint32_t getPassCount()const
+			{
+				return m_passCount;
+			}
+
+		private:
+			crg::RenderGraph & m_graph;
+			bool m_sampledPerPass;
+			uint32_t m_passCount{};
+		};
+		/**
+		*\brief
+		*	Adds chained passes until the graph holds passCount ones.
+		*/
+		void completeChain( Generator & generator
+			, crg::ImageViewId input
+			, uint32_t passCount )
+		{
+			while ( generator.getPassCount() < passCount )
+			{
+				auto output = generator.createView();
+				generator.addPass( { input }, { output } );
+				input = output;
+			}
+		}
+
+		void generateChain( Generator & generator
+			, uint32_t passCount )
+		{
+			auto output = generator.createView();
+			generator.addPass( {}, { output } );
+			completeChain( generator, output, passCount );
+		}
+
+		void generateFan( Generator & generator
+			, uint32_t passCount )
+		{
+			auto root = generator.createView();
+			generator.addPass( {}, { root } );
+			std::vector< crg::ImageViewId > outputs;
+
+			while ( generator.getPassCount() + 1u < passCount )
+			{
+				outputs.push_back( generator.createView() );
+				generator.addPass( { root }, { outputs.back() } );
+			}
+
+			if ( generator.getPassCount() < passCount )
+			{
+				generator.addPass( outputs, { generator.createView() } );
+			}
+		}
+
+		void generateBufferFan( Generator & generator
+			, crg::RenderGraph & graph
+			, uint32_t passCount )
+		{
+			auto buffer = graph.createBuffer( { 0u, 1024u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT } );
+			auto input = generator.createView();
+			generator.addPass( {}, { input }, { crg::BufferAttachment::createStorageWrite( "BufW", buffer ) } );
+
+			while ( generator.getPassCount() < passCount )
+			{
+				auto output = generator.createView();
+				generator.addPass( { input }, { output }, { crg::BufferAttachment::createStorageRead( "BufR", buffer ) } );
+				input = output;
+			}
+		}
+
+		void generateDiamond( Generator & generator
+			, uint32_t passCount )
+		{
+			auto top = generator.createView();
+			generator.addPass( {}, { top } );
+
+			while ( generator.getPassCount() + 3u <= passCount )
+			{
+				auto left = generator.createView();
+				generator.addPass( { top }, { left } );
+				auto right = generator.createView();
+				generator.addPass( { top }, { right } );
+				top = generator.createView();
+				generator.addPass( { left, right }, { top } );
+			}
+
+			completeChain( generator, top, passCount );
+		}
+
+		void generateMipChain( Generator & generator
+			, crg::RenderGraph & graph
+			, uint32_t passCount )
+		{
+			while ( generator.getPassCount() < passCount )
+			{
+				auto image = graph.createImage( test::createImage( Format, MipLevels ) );
+				auto input = generator.createView( image, 0u );
+				generator.addPass( {}, { input } );
+
+				for ( uint32_t level = 1u; level < MipLevels && generator.getPassCount() < passCount; ++level )
+				{
+					auto output = generator.createView( image, level );
+					generator.addPass( { input }, { output } );
+					input = output;
+				}
+			}
+		}
+
+		void generateSsao( Generator & generator
+			, crg::RenderGraph & graph
+			, uint32_t passCount )
+		{
+			static uint32_t constexpr MinifyCount = 3u;
+			static uint32_t constexpr SubgraphPassCount = MinifyCount + 4u;
+			auto depth = generator.createView();
+			auto normals = generator.createView();
+			generator.addPass( {}, { depth, normals } );
+
+			while ( generator.getPassCount() + SubgraphPassCount <= passCount )
+			{
+				auto linear = graph.createImage( test::createImage( Format, MinifyCount + 1u ) );
+				auto input = generator.createView( linear, 0u );
+				generator.addPass( { depth }, { input } );
+
+				for ( uint32_t level = 1u; level <= MinifyCount; ++level )
+				{
+					auto output = generator.createView( linear, level );
+					generator.addPass( { input }, { output } );
+					input = output;
+				}
+
+				auto linearAll = graph.createView( test::createView( linear, Format, 0u, MinifyCount + 1u ) );
+				auto raw = generator.createView();
+				generator.addPass( { linearAll, normals }, { raw } );
+				auto blurX = generator.createView();
+				generator.addPass( { raw, normals }, { blurX } );
+				auto blurY = generator.createView();
+				generator.addPass( { blurX, normals }, { blurY } );
+			}
+
+			completeChain( generator, depth, passCount );
+		}
+
+		void generateRings( Generator & generator
+			, uint32_t passCount )
+		{
+			auto input = generator.createView();
+			generator.addPass( {}, { input } );
+
+			// A pass is kept after the last ring, so that the graph has a leaf.
+			while ( generator.getPassCount() + RingSize < passCount )
+			{
+				auto back = generator.createView();
+				auto output = generator.createView();
+				generator.addPass( { input, back }, { output } );
+
+				for ( uint32_t index = 2u; index < RingSize; ++index )
+				{
+					auto next = generator.createView();
+					generator.addPass( { output }, { next } );
+					output = next;
+				}
+
+				generator.addPass( { output }, { back } );
+				input = back;
+			}
+
+			completeChain( generator, input, passCount );
+		}
+
+		void generateRandomDag( Generator & generator
+			, uint32_t passCount
+			, uint32_t seed )
+		{
+			// mt19937 output is specified by the standard, the distributions aren't.
+			std::mt19937 random{ seed };
+			std::vector< crg::ImageViewId > outputs;
+
+			while ( generator.getPassCount() < passCount )
+			{
+				std::vector< crg::ImageViewId > inputs;
+
+				if ( !outputs.empty() )
+				{
+					auto count = 1u + random() % 3u;
+
+					for ( uint32_t index = 0u; index < count; ++index )
+					{
+						auto input = outputs[random() % outputs.size()];
+
+						if ( inputs.end() == std::find( inputs.begin(), inputs.end(), input ) )
+						{
+							inputs.push_back( input );
+						}
+					}
+				}
+
+				outputs.push_back( generator.createView() );
+				generator.addPass( inputs, { outputs.back() } );
+			}
+		}
+	}
+
+	namespace
+	{
+		class ByteReader
+		{
+		public:
+			ByteReader( uint8_t const * data
+				, size_t size )
+				: m_data{ data }
+				, m_size{ size }
+			{
+			}
+
+			uint32_t read()
+			{
+				return m_index < m_size
+					? m_data[m_index++]
+					: 0u;
+			}
+
+			uint32_t read( uint32_t count )
+			{
+				return read() % count;
+			}
+
+			bool atEnd()const
+			{
+				return m_index >= m_size;
+			}
+
+		private:
+			uint8_t const * m_data;
+			size_t m_size;
+			size_t m_index{};
+		};
+
+		uint32_t readRange( ByteReader & reader
+			, uint32_t & base
+			, uint32_t count )
+		{
+			auto value = reader.read();
+			base = value % ( count + 1u );
+			value = reader.read();
+			// Some ranges overflow the image, or use the remaining levels or layers.
+			return value == 0xFFu
+				? ~0u
+				: 1u + value % count;
+		}
+
+		crg::Attachment decodeAttachment( ByteReader & reader
+			, crg::RenderPass::Kind passKind
+			, crg::ImageViewId view
+			, std::string const & name )
+		{
+			auto loadOp = VkAttachmentLoadOp( reader.read( 3u ) );
+			auto storeOp = VkAttachmentStoreOp( reader.read( 2u ) );
+
+			switch ( passKind )
+			{
+			case crg::RenderPass::Kind::Compute:
+				return crg::Attachment::createStorage( name, loadOp, storeOp, view );
+			case crg::RenderPass::Kind::Transfer:
+				return storeOp == VK_ATTACHMENT_STORE_OP_STORE
+					? crg::Attachment::createTransferDst( name, view )
+					: crg::Attachment::createTransferSrc( name, view );
+			default:
+				return crg::Attachment::createColour( name, loadOp, storeOp, view );
+			}
+		}
+	}
+
+	char const * getName( GraphShape shape )
+	{
+		switch ( shape )
+		{
+		case GraphShape::Chain:
+			return "chain";
+		case GraphShape::Fan:
+			return "fan";
+		case GraphShape::Diamond:
+			return "diamond";
+		case GraphShape::MipChain:
+			return "mipChain";
+		case GraphShape::Ssao:
+			return "ssao";
+		case GraphShape::RandomDag:
+			return "randomDag";
+		case GraphShape::Rings:
+			return "rings";
+		case GraphShape::FanPerPass:
+			return "fanPerPass";
+		case GraphShape::BufferFan:
+			return "bufferFan";
+		default:
+			return "unknown";
+		}
+	}
+
+	void generateGraph( crg::RenderGraph & graph
+		, GraphShape shape
+		, uint32_t passCount
+		, uint32_t seed )
+	{
+		Generator generator{ graph, shape == GraphShape::FanPerPass };
+
+		switch ( shape )
+		{
+		case GraphShape::Chain:
+			generateChain( generator, passCount );
+			break;
+		case GraphShape::Fan:
+		case GraphShape::FanPerPass:
+			generateFan( generator, passCount );
+			break;
+		case GraphShape::Diamond:
+			generateDiamond( generator, passCount );
+			break;
+		case GraphShape::MipChain:
+			generateMipChain( generator, graph, passCount );
+			break;
+		case GraphShape::Ssao:
+			generateSsao( generator, graph, passCount );
+			break;
+		case GraphShape::RandomDag:
+			generateRandomDag( generator, passCount, seed );
+			break;
+		case GraphShape::Rings:
+			generateRings( generator, passCount );
+			break;
+		case GraphShape::BufferFan:
+			generateBufferFan( generator, graph, passCount );
+			break;
+		default:
+			break;
+		}
+	}
+
+	uint32_t decodeGraph( crg::RenderGraph & graph
+		, uint8_t const * data
+		, size_t size )
+	{
+		static VkFormat const formats[]
+		{
+			VK_FORMAT_R8_UNORM,
+			VK_FORMAT_R8G8B8A8_UNORM,
+			VK_FORMAT_R16G16B16A16_SFLOAT,
+			VK_FORMAT_R32_SFLOAT,
+			VK_FORMAT_D32_SFLOAT,
+			VK_FORMAT_D24_UNORM_S8_UINT,
+		};
+		static uint32_t constexpr MaxPassCount = 64u;
+		ByteReader reader{ data, size };
+		std::vector< crg::ImageViewId > views;
+		std::vector< crg::BufferId > buffers;
+		auto imageCount = 1u + reader.read( 8u );
+
+		for ( uint32_t index = 0u; index < imageCount; ++index )
+		{
+			auto format = formats[reader.read( uint32_t( sizeof( formats ) / sizeof( formats[0] ) ) )];
+			auto image = test::createImage( format, 1u + reader.read( 6u ) );
+			image.arrayLayers = 1u + reader.read( 6u );
+			auto id = graph.createImage( image );
+			auto viewCount = 1u + reader.read( 4u );
+
+			for ( uint32_t viewIndex = 0u; viewIndex < viewCount; ++viewIndex )
+			{
+				auto view = test::createView( id, format );
+				auto & range = view.subresourceRange;
+				range.levelCount = readRange( reader, range.baseMipLevel, image.mipLevels );
+				range.layerCount = readRange( reader, range.baseArrayLayer, image.arrayLayers );
+				views.push_back( graph.createView( view ) );
+			}
+		}
+
+		auto bufferCount = reader.read( 4u );
+
+		for ( uint32_t index = 0u; index < bufferCount; ++index )
+		{
+			buffers.push_back( graph.createBuffer( { 0u, 1024u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT } ) );
+		}
+
+		uint32_t passCount{};
+
+		while ( passCount < MaxPassCount
+			&& ( passCount == 0u || !reader.atEnd() ) )
+		{
+			auto kind = crg::RenderPass::Kind( reader.read( 3u ) );
+			crg::AttachmentArray sampled;
+			crg::AttachmentArray attaches;
+			crg::BufferAttachmentArray bufferAttaches;
+			std::optional< crg::Attachment > depthStencil;
+			auto attachCount = 1u + reader.read( 4u );
+
+			for ( uint32_t index = 0u; index < attachCount; ++index )
+			{
+				auto selector = reader.read();
+				auto view = views[reader.read( uint32_t( views.size() ) )];
+				// Attachments of different passes share their name half of the time.
+				auto name = "A" + std::to_string( view.id ) + ( ( selector & 0x80u )
+					? "_" + std::to_string( passCount )
+					: std::string{} );
+
+				switch ( selector % 4u )
+				{
+				case 0u:
+					if ( kind != crg::RenderPass::Kind::Transfer )
+					{
+						sampled.push_back( crg::Attachment::createSampled( name + "Sp", view ) );
+						break;
+					}
+					[[fallthrough]];
+				case 1u:
+				case 2u:
+					attaches.push_back( decodeAttachment( reader, kind, view, name ) );
+					break;
+				default:
+					if ( kind == crg::RenderPass::Kind::Graphics
+						&& !depthStencil )
+					{
+						depthStencil = crg::Attachment::createDepthStencil( name + "Ds"
+							, VkAttachmentLoadOp( reader.read( 3u ) )
+							, VkAttachmentStoreOp( reader.read( 2u ) )
+							, VkAttachmentLoadOp( reader.read( 3u ) )
+							, VkAttachmentStoreOp( reader.read( 2u ) )
+							, view );
+					}
+					else if ( !buffers.empty() )
+					{
+						auto buffer = buffers[reader.read( uint32_t( buffers.size() ) )];
+						auto offset = VkDeviceSize( reader.read( 4u ) * 256u );
+						auto range = reader.read( 5u );
+						auto bufferName = "B" + std::to_string( buffer.id );
+						bufferAttaches.push_back( ( selector & 0x40u )
+							? crg::BufferAttachment::createStorageWrite( bufferName + "W"
+								, buffer
+								, offset
+								, range ? range * 128u : VK_WHOLE_SIZE )
+							: crg::BufferAttachment::createStorageRead( bufferName + "R"
+								, buffer
+								, offset
+								, range ? range * 128u : VK_WHOLE_SIZE ) );
+					}
+					break;
+				}
+			}
+
+			auto name = "pass" + std::to_string( passCount++ );
+
+			switch ( kind )
+			{
+			case crg::RenderPass::Kind::Compute:
+				graph.add( crg::RenderPass::createCompute( name, sampled, attaches, bufferAttaches ) );
+				break;
+			case crg::RenderPass::Kind::Transfer:
+				graph.add( crg::RenderPass::createTransfer( name, attaches, bufferAttaches ) );
+				break;
+			default:
+				graph.add( crg::RenderPass{ name, sampled, attaches, depthStencil, bufferAttaches } );
+				break;
+			}
+		}
+
+		return passCount;
+	}
+}
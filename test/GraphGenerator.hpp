@@ -0,0 +1,59 @@
+#pragma once
+
+#include <RenderGraph/RenderGraphPrerequisites.hpp>
+
+namespace test
+{
+	/**
+	*\brief
+	*	The shapes of the generated graphs.
+	*/
+	enum class GraphShape
+	{
+		// Each pass samples the output of the previous one.
+		Chain,
+		// One pass written by a root pass is sampled by all the other passes, a last pass samples all their outputs.
+		Fan,
+		// Chained diamonds: a pass output is sampled by two passes, whose outputs are sampled by a join pass.
+		Diamond,
+		// Downsampling chains over the mip levels of images, like test3MipDependencies.
+		MipChain,
+		// SSAO subgraphs (linearise, minify, raw, blur), all reading the same depth and normals.
+		Ssao,
+		// Random DAG, each pass sampling up to three outputs of previous passes.
+		RandomDag,
+		// Chained rings of passes, each pass of a ring depending on the previous one, the first one on the last one.
+		Rings,
+		// Like Fan, but each pass samples the root output through its own attachment, named after the pass.
+		// Each of these attachments takes the passes of the later ones, so the transitions count is quadratic.
+		FanPerPass,
+		// Like Chain, but the first pass also writes a buffer, which all the other passes read.
+		BufferFan,
+		Count,
+	};
+
+	char const * getName( GraphShape shape );
+	/**
+	*\brief
+	*	Registers passCount passes, and the images they use, in given graph.
+	*\param[in] seed
+	*	The random DAG seed, the same seed gives the same graph on every platform.
+	*/
+	void generateGraph( crg::RenderGraph & graph
+		, GraphShape shape
+		, uint32_t passCount
+		, uint32_t seed = 0u );
+	/**
+	*\brief
+	*	Registers the images, views, buffers and passes described by arbitrary bytes, in given graph.
+	*\remarks
+	*	Any byte sequence gives a valid registration, missing bytes being read as zeroes.
+	*	Views can target any mip and layer range, including out of the image ones,
+	*	and passes get random attachment kinds.
+	*\return
+	*	The number of registered passes.
+	*/
+	uint32_t decodeGraph( crg::RenderGraph & graph
+		, uint8_t const * data
+		, size_t size );
+}
@@ -0,0 +1,230 @@
+﻿#include "AllocationCounter.hpp"
+#include "Common.hpp"
+#include "GraphGenerator.hpp"
+
+#include <RenderGraph/GraphExecutor.hpp>
+#include <RenderGraph/GraphTraversal.hpp>
+#include <RenderGraph/RenderGraph.hpp>
+#include <RenderGraph/RenderPass.hpp>
+#include <RenderGraph/ThreadPool.hpp>
+
+#include <atomic>
+
+namespace
+{
+	struct CompileBound
+	{
+		test::GraphShape shape;
+		uint32_t passCount;
+		uint64_t maxAllocations;
+	};
+
+	uint64_t countCompileAllocations( crg::RenderGraph & graph )
+	{
+		test::AllocationScope scope;
+		graph.compile();
+		return scope.getCount().allocations;
+	}
+
+	void testAllocationCounter( test::TestCounts & testCounts )
+	{
+		testBegin( "testAllocationCounter" );
+		test::AllocationScope scope;
+		auto live = test::getLiveBytes();
+		test::resetPeakBytes();
+		{
+			auto values = std::make_unique< std::vector< uint32_t > >( 1000u );
+			check( test::getLiveBytes() >= live + int64_t( 1000u * sizeof( uint32_t ) ) );
+		}
+		auto count = scope.getCount();
+		check( count.allocations == 2u );
+		check( count.bytes >= 1000u * sizeof( uint32_t ) );
+		check( test::getLiveBytes() == live );
+		check( test::getPeakBytes() >= live + int64_t( 1000u * sizeof( uint32_t ) ) );
+
+		// The over-aligned allocations go through the aligned operators.
+		struct alignas( 64 ) Aligned
+		{
+			uint8_t data[64];
+		};
+		test::AllocationScope alignedScope;
+		{
+			auto value = std::make_unique< Aligned >();
+			auto values = std::make_unique< Aligned[] >( 4u );
+			check( reinterpret_cast< uintptr_t >( value.get() ) % alignof( Aligned ) == 0u );
+			check( reinterpret_cast< uintptr_t >( values.get() ) % alignof( Aligned ) == 0u );
+			check( test::getLiveBytes() >= live + int64_t( 5u * sizeof( Aligned ) ) );
+		}
+		count = alignedScope.getCount();
+		check( count.allocations == 2u );
+		check( count.bytes >= 5u * sizeof( Aligned ) );
+		check( test::getLiveBytes() == live );
+		testEnd();
+	}
+
+	void testCompileAllocations( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileAllocations" );
+		// Chain, mip chain and SSAO graphs match the ones from TestRenderGraph.
+		static CompileBound const bounds[]
+		{
+			{ test::GraphShape::Chain, 3u, 200u },
+			{ test::GraphShape::Chain, 16u, 1100u },
+			{ test::GraphShape::Fan, 16u, 1600u },
+			{ test::GraphShape::Diamond, 16u, 1300u },
+			{ test::GraphShape::MipChain, 4u, 250u },
+			{ test::GraphShape::MipChain, 16u, 1000u },
+			{ test::GraphShape::Ssao, 8u, 850u },
+			{ test::GraphShape::Ssao, 16u, 1650u },
+			{ test::GraphShape::RandomDag, 16u, 1350u },
+		};
+
+		for ( auto & bound : bounds )
+		{
+			crg::RenderGraph graph{ test::getName( bound.shape ) };
+			test::generateGraph( graph, bound.shape, bound.passCount );
+			auto allocations = countCompileAllocations( graph );
+			check( allocations > 0u );
+			check( allocations <= bound.maxAllocations );
+			// Compiling again doesn't accumulate anything.
+			check( countCompileAllocations( graph ) <= allocations );
+		}
+
+		testEnd();
+	}
+
+	void testCompileStatsAllocations( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileStatsAllocations" );
+		crg::RenderGraph graph{ testCounts.testName };
+		test::generateGraph( graph, test::GraphShape::Ssao, 16u );
+		graph.setAllocationCounter( test::getAllocationCount );
+		graph.enableCompileStats( true );
+		test::AllocationScope scope;
+		checkNoThrow( graph.compile() );
+		auto count = scope.getCount();
+		auto & stats = graph.getCompileStats();
+		uint64_t phasesAllocations{};
+		uint64_t phasesBytes{};
+
+		for ( size_t index = 0u; index < size_t( crg::CompilePhase::Count ); ++index )
+		{
+			phasesAllocations += stats.phaseAllocations[index];
+			phasesBytes += stats.phaseAllocatedBytes[index];
+		}
+
+		check( stats.phaseAllocations[size_t( crg::CompilePhase::BuildPassDependencies )] > 0u );
+		check( stats.phaseAllocations[size_t( crg::CompilePhase::BuildGraphNodes )] > 0u );
+		check( phasesAllocations <= stats.allocations );
+		check( phasesBytes <= stats.allocatedBytes );
+		check( stats.allocations <= count.allocations );
+		testEnd();
+	}
+
+	void runFrames( test::TestCounts & testCounts
+		, crg::GraphExecutor & executor
+		, uint32_t passCount )
+	{
+		std::atomic< uint32_t > recorded{};
+		uint32_t stitched{};
+		crg::GraphExecutor::RecordFunc record = [&recorded]( crg::RenderPass const &, uint32_t, uint32_t )
+		{
+			++recorded;
+		};
+		crg::GraphExecutor::StitchFunc stitch = [&stitched]( crg::RenderPass const &, uint32_t )
+		{
+			++stitched;
+		};
+		// The first run sets up the executor for the compiled graph.
+		executor.run( record, stitch );
+		recorded = 0u;
+		stitched = 0u;
+		test::AllocationScope scope;
+
+		for ( uint32_t frame = 0u; frame < 100u; ++frame )
+		{
+			executor.run( record, stitch );
+		}
+
+		check( scope.getCount().allocations == 0u );
+		check( stitched == 100u * passCount );
+		check( recorded <= 100u * passCount );
+	}
+
+	void testExecutorAllocations( test::TestCounts & testCounts )
+	{
+		testBegin( "testExecutorAllocations" );
+		static uint32_t constexpr PassCount = 64u;
+		crg::RenderGraph graph{ testCounts.testName };
+		test::generateGraph( graph, test::GraphShape::Ssao, PassCount );
+		checkNoThrow( graph.compile() );
+		crg::ThreadPool pool{ 3u };
+		{
+			crg::GraphExecutor executor{ graph, pool };
+			runFrames( testCounts, executor, PassCount );
+		}
+		{
+			crg::GraphExecutor executor{ graph, pool };
+			executor.enableRecordTimes( true );
+
+			for ( uint32_t index = 0u; index < PassCount; index += 2u )
+			{
+				executor.setCacheable( "pass" + std::to_string( index ) );
+			}
+
+			runFrames( testCounts, executor, PassCount );
+			check( executor.getCacheStats().hits > 0u );
+		}
+		{
+			crg::GraphExecutor executor{ graph
+				, []( uint32_t count, std::function< void( uint32_t, uint32_t ) > const & job )
+				{
+					for ( uint32_t index = 0u; index < count; ++index )
+					{
+						job( index, 0u );
+					}
+				} };
+			runFrames( testCounts, executor, PassCount );
+		}
+		testEnd();
+	}
+
+	void testTraversalAllocations( test::TestCounts & testCounts )
+	{
+		testBegin( "testTraversalAllocations" );
+		crg::RenderGraph graph{ testCounts.testName };
+		test::generateGraph( graph, test::GraphShape::RandomDag, 256u );
+		checkNoThrow( graph.compile() );
+		crg::GraphTraversal traversal{ graph };
+		uint32_t visited{};
+		test::AllocationScope scope;
+
+		for ( uint32_t run = 0u; run < 10u; ++run )
+		{
+			for ( auto order : { crg::GraphTraversal::Order::BreadthFirst
+				, crg::GraphTraversal::Order::DepthFirst
+				, crg::GraphTraversal::Order::Topological } )
+			{
+				for ( auto node : traversal.traverse( order ) )
+				{
+					visited += node->getIndex() ? 1u : 0u;
+				}
+			}
+		}
+
+		check( scope.getCount().allocations == 0u );
+		check( visited == 30u * 256u );
+		testEnd();
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	testSuiteBegin( "TestAllocations" );
+	testAllocationCounter( testCounts );
+	testCompileAllocations( testCounts );
+	testCompileStatsAllocations( testCounts );
+	testExecutorAllocations( testCounts );
+	testTraversalAllocations( testCounts );
+	testSuiteEnd();
+}
@@ -0,0 +1,399 @@
+#include "Common.hpp"
+
+#include <RenderGraph/BufferAttachment.hpp>
+#include <RenderGraph/CompileCache.hpp>
+#include <RenderGraph/CompiledGraph.hpp>
+#include <RenderGraph/ImageData.hpp>
+#include <RenderGraph/MappedFile.hpp>
+#include <RenderGraph/RenderGraph.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+	void buildGraph( test::TestCounts & testCounts
+		, crg::RenderGraph & graph
+		, bool withBlur )
+	{
+		auto d = graph.createImage( test::createImage( VK_FORMAT_D32_SFLOAT ) );
+		auto dv = graph.createView( test::createView( d, VK_FORMAT_D32_SFLOAT ) );
+		auto c = graph.createImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto cv = graph.createView( test::createView( c, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto h = graph.createHistoryImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto hv = graph.createView( test::createView( h, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto prevv = graph.createHistoryView( hv );
+		auto args = graph.createBuffer( { 0u, 256u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT } );
+		auto cullPass = crg::RenderPass::createCompute( "cullPass"
+			, {}
+			, {}
+			, { crg::BufferAttachment::createStorageWrite( "Args", args ) } );
+		checkNoThrow( graph.add( cullPass ) );
+		crg::RenderPass geometryPass
+		{
+			"geometryPass",
+			{},
+			{ crg::Attachment::createOutputColour( "ColourTg", cv ) },
+			crg::Attachment::createOutputDepth( "DepthTg", dv ),
+			{ crg::BufferAttachment::createIndirect( "Args", args ) },
+		};
+		checkNoThrow( graph.add( geometryPass ) );
+		crg::RenderPass taaPass
+		{
+			"taaPass",
+			{ crg::Attachment::createSampled( "ColourSp", cv ), crg::Attachment::createSampled( "HistorySp", prevv ) },
+			{ crg::Attachment::createOutputColour( "HistoryTg", hv ) },
+		};
+		checkNoThrow( graph.add( taaPass ) );
+
+		if ( withBlur )
+		{
+			auto b = graph.createImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+			auto bv = graph.createView( test::createView( b, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+			auto blurPass = crg::RenderPass::createCompute( "blurPass"
+				, { crg::Attachment::createSampled( "HistorySp", hv ) }
+				, { crg::Attachment::createOutputStorage( "BlurSt", bv ) } );
+			checkNoThrow( graph.add( blurPass ) );
+		}
+	}
+
+	std::vector< std::string > getNames( crg::RenderPassArray const & passes )
+	{
+		std::vector< std::string > result;
+
+		for ( auto & pass : passes )
+		{
+			result.push_back( pass->name );
+		}
+
+		return result;
+	}
+
+	void testRoundTrip( test::TestCounts & testCounts )
+	{
+		testBegin( "testRoundTrip" );
+		crg::RenderGraph source{ testCounts.testName };
+		buildGraph( testCounts, source, true );
+		checkThrow( source.serialise() );
+		checkNoThrow( source.compile() );
+		auto data = source.serialise();
+		crg::CompiledGraph compiled{ data.data(), data.size() };
+		require( compiled.isValid() );
+		check( compiled.getGraphHash() == source.getGraphHash() );
+		require( compiled.getPasses().size() == 4u );
+		check( compiled.getString( compiled.getPasses()[0].name ) == "cullPass" );
+		check( compiled.getImageBarriers( compiled.getPasses()[0] ).empty() );
+		check( compiled.getBufferBarriers( compiled.getPasses()[1] ).size() == 1u );
+
+		crg::RenderGraph loaded{ testCounts.testName };
+		buildGraph( testCounts, loaded, true );
+		check( loaded.getGraphHash() == source.getGraphHash() );
+		require( loaded.load( compiled ) );
+		check( getNames( loaded.getExecutionOrder() ) == getNames( source.getExecutionOrder() ) );
+		check( loaded.getPassSignatures() == source.getPassSignatures() );
+		check( loaded.getBarriers().size() == source.getBarriers().size() );
+
+		for ( size_t index = 0u; index < source.getBarriers().size(); ++index )
+		{
+			check( loaded.getBarriers()[index].images == source.getBarriers()[index].images );
+			check( loaded.getBarriers()[index].buffers == source.getBarriers()[index].buffers );
+		}
+
+		require( loaded.getDependencies().size() == source.getDependencies().size() );
+
+		for ( size_t index = 0u; index < source.getDependencies().size(); ++index )
+		{
+			auto & lhs = loaded.getDependencies()[index];
+			auto & rhs = source.getDependencies()[index];
+			check( lhs.srcPass->name == rhs.srcPass->name );
+			check( lhs.dstPass->name == rhs.dstPass->name );
+			check( lhs.srcOutputs == rhs.srcOutputs );
+			check( lhs.dstInputs == rhs.dstInputs );
+			check( lhs.srcBufferOutputs == rhs.srcBufferOutputs );
+			check( lhs.dstBufferInputs == rhs.dstBufferInputs );
+		}
+
+		check( loaded.getHistoryDependencies().size() == source.getHistoryDependencies().size() );
+		check( loaded.getTransitions().size() == source.getTransitions().size() );
+		check( loaded.getGraph()->getNext().size() == source.getGraph()->getNext().size() );
+		// Same graph, same bytes.
+		check( loaded.serialise() == data );
+		testEnd();
+	}
+
+	void testMappedFile( test::TestCounts & testCounts )
+	{
+		testBegin( "testMappedFile" );
+		crg::RenderGraph source{ testCounts.testName };
+		buildGraph( testCounts, source, false );
+		checkNoThrow( source.compile() );
+		auto data = source.serialise();
+		std::string path = testCounts.testName + ".crg";
+		{
+			std::ofstream file{ path, std::ios::binary };
+			file.write( reinterpret_cast< char const * >( data.data() ), std::streamsize( data.size() ) );
+		}
+		{
+			crg::MappedFile file{ path };
+			require( file.isOpen() );
+			check( file.getSize() == data.size() );
+			crg::CompiledGraph compiled{ file.getData(), file.getSize() };
+			require( compiled.isValid() );
+			crg::RenderGraph loaded{ testCounts.testName };
+			buildGraph( testCounts, loaded, false );
+			check( loaded.load( compiled ) );
+			check( getNames( loaded.getExecutionOrder() ) == getNames( source.getExecutionOrder() ) );
+		}
+		std::remove( path.c_str() );
+		crg::MappedFile missing{ path };
+		check( !missing.isOpen() );
+		testEnd();
+	}
+
+	void testRejected( test::TestCounts & testCounts )
+	{
+		testBegin( "testRejected" );
+		crg::RenderGraph source{ testCounts.testName };
+		buildGraph( testCounts, source, false );
+		checkNoThrow( source.compile() );
+		auto data = source.serialise();
+
+		// The registered passes changed.
+		crg::RenderGraph other{ testCounts.testName };
+		buildGraph( testCounts, other, true );
+		check( other.getGraphHash() != source.getGraphHash() );
+		check( !other.load( crg::CompiledGraph{ data.data(), data.size() } ) );
+		check( other.getExecutionOrder().empty() );
+
+		// Truncated data.
+		check( !crg::CompiledGraph( data.data(), data.size() - 8u ).isValid() );
+
+		// Corrupted content.
+		auto corrupted = data;
+		corrupted.back() ^= 0xFFu;
+		check( !crg::CompiledGraph( corrupted.data(), corrupted.size() ).isValid() );
+
+		// Other version.
+		auto versioned = data;
+		reinterpret_cast< crg::binary::Header * >( versioned.data() )->version = crg::binary::Version + 1u;
+		check( !crg::CompiledGraph( versioned.data(), versioned.size() ).isValid() );
+		testEnd();
+	}
+
+	template< typename TypeT >
+	TypeT * getRecords( std::vector< uint8_t > & data
+		, crg::binary::SectionKind kind )
+	{
+		auto & header = *reinterpret_cast< crg::binary::Header * >( data.data() );
+		return reinterpret_cast< TypeT * >( data.data() + header.sections[size_t( kind )].offset );
+	}
+	/**
+	*\brief
+	*	Recomputes the content hash (a 64 bits FNV-1a of everything following the header), so that modified data stays valid.
+	*/
+	void updateContentHash( std::vector< uint8_t > & data )
+	{
+		uint64_t hash{ 14695981039346656037ull };
+
+		for ( auto it = data.begin() + sizeof( crg::binary::Header ); it != data.end(); ++it )
+		{
+			hash ^= *it;
+			hash *= 1099511628211ull;
+		}
+
+		reinterpret_cast< crg::binary::Header * >( data.data() )->contentHash = hash;
+	}
+
+	void testRejectedContent( test::TestCounts & testCounts )
+	{
+		testBegin( "testRejectedContent" );
+		crg::RenderGraph source{ testCounts.testName };
+		buildGraph( testCounts, source, false );
+		checkNoThrow( source.compile() );
+		auto data = source.serialise();
+		std::vector< std::vector< uint8_t > > corrupted( 5u, data );
+		// A name outside of the strings.
+		getRecords< crg::binary::Pass >( corrupted[0], crg::binary::SectionKind::Passes )[0].name.offset = 0xFFFFFF00u;
+		// A pass listed twice, and another one missing.
+		auto passes = getRecords< crg::binary::Pass >( corrupted[1], crg::binary::SectionKind::Passes );
+		passes[1].name = passes[0].name;
+		// An unknown buffer.
+		auto bufferBarrier = crg::CompiledGraph{ data.data(), data.size() }.getPasses()[1].bufferBarrierBegin;
+		getRecords< crg::binary::BufferBarrier >( corrupted[2], crg::binary::SectionKind::BufferBarriers )[bufferBarrier].buffer = 1000u;
+		// Attachments outside of their section.
+		getRecords< crg::binary::Dependency >( corrupted[3], crg::binary::SectionKind::Dependencies )[0].attachmentCount = 0x7FFFFFFFu;
+		// An unknown pass.
+		getRecords< uint32_t >( corrupted[4], crg::binary::SectionKind::Nodes )[0] = 1000u;
+
+		for ( auto & content : corrupted )
+		{
+			updateContentHash( content );
+			crg::CompiledGraph compiled{ content.data(), content.size() };
+			require( compiled.isValid() );
+			crg::RenderGraph loaded{ testCounts.testName };
+			buildGraph( testCounts, loaded, false );
+			bool result{ true };
+			checkNoThrow( result = loaded.load( compiled ) );
+			check( !result );
+			check( loaded.getExecutionOrder().empty() );
+		}
+
+		// A cached entry which can't be loaded only gives a miss.
+		auto directory = testCounts.testName + "Cache";
+		std::filesystem::remove_all( directory );
+		crg::CompileCache cache{ directory };
+		crg::RenderGraph graph{ testCounts.testName };
+		buildGraph( testCounts, graph, false );
+		graph.setCompileCache( &cache );
+		{
+			std::ofstream file{ cache.getEntryPath( graph.getGraphHash() ), std::ios::binary };
+			file.write( reinterpret_cast< char const * >( corrupted[0].data() ), std::streamsize( corrupted[0].size() ) );
+		}
+		checkNoThrow( graph.compile() );
+		check( cache.getStats().hits == 0u );
+		check( cache.getStats().misses == 1u );
+		check( graph.getExecutionOrder().size() == 3u );
+		testEnd();
+	}
+
+	void testCompileCache( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileCache" );
+		auto directory = testCounts.testName + "Cache";
+		std::filesystem::remove_all( directory );
+		crg::CompileCache cache{ directory };
+		{
+			crg::RenderGraph graph{ testCounts.testName };
+			buildGraph( testCounts, graph, false );
+			graph.setCompileCache( &cache );
+			checkNoThrow( graph.compile() );
+			check( cache.getStats().misses == 1u );
+			check( cache.getStats().writes == 1u );
+			check( std::filesystem::exists( cache.getEntryPath( graph.getGraphHash() ) ) );
+		}
+		crg::RenderGraph graph{ testCounts.testName };
+		buildGraph( testCounts, graph, false );
+		graph.setCompileCache( &cache );
+		checkNoThrow( graph.compile() );
+		check( cache.getStats().hits == 1u );
+		check( cache.getStats().writes == 1u );
+		require( graph.getExecutionOrder().size() == 3u );
+		check( graph.getExecutionOrder()[0]->name == "cullPass" );
+		check( graph.getCompileCount() == 1u );
+
+		// A corrupted entry is replaced.
+		auto path = cache.getEntryPath( graph.getGraphHash() );
+		std::filesystem::resize_file( path, std::filesystem::file_size( path ) - 1u );
+		checkNoThrow( graph.compile() );
+		check( cache.getStats().hits == 1u );
+		check( cache.getStats().misses == 2u );
+		check( cache.getStats().writes == 2u );
+		checkNoThrow( graph.compile() );
+		check( cache.getStats().hits == 2u );
+		testEnd();
+	}
+
+	void testCompileCacheEviction( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileCacheEviction" );
+		auto directory = testCounts.testName + "Cache";
+		std::filesystem::remove_all( directory );
+		crg::CompileCache cache{ directory, 1u };
+		crg::RenderGraph graph1{ testCounts.testName };
+		buildGraph( testCounts, graph1, false );
+		graph1.setCompileCache( &cache );
+		checkNoThrow( graph1.compile() );
+		auto path1 = cache.getEntryPath( graph1.getGraphHash() );
+		require( std::filesystem::exists( path1 ) );
+		std::filesystem::last_write_time( path1, std::filesystem::last_write_time( path1 ) - std::chrono::minutes{ 10 } );
+		// A temporary file left by an interrupted write.
+		auto tempPath = path1 + ".interrupted.tmp";
+		std::ofstream{ tempPath } << "partial";
+		std::filesystem::last_write_time( tempPath, std::filesystem::last_write_time( tempPath ) - std::chrono::hours{ 2 } );
+
+		crg::RenderGraph graph2{ testCounts.testName };
+		buildGraph( testCounts, graph2, true );
+		graph2.setCompileCache( &cache );
+		checkNoThrow( graph2.compile() );
+		// The budget only allows one entry, the least recently used one is removed.
+		check( !std::filesystem::exists( path1 ) );
+		check( std::filesystem::exists( cache.getEntryPath( graph2.getGraphHash() ) ) );
+		check( !std::filesystem::exists( tempPath ) );
+		check( cache.getStats().evictions == 1u );
+		testEnd();
+	}
+
+	void testCompileCacheConcurrency( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileCacheConcurrency" );
+		auto directory = testCounts.testName + "Cache";
+		std::filesystem::remove_all( directory );
+		// Each thread has its own cache object, as separate processes would.
+		std::vector< std::unique_ptr< crg::RenderGraph > > graphs;
+		std::vector< std::thread > threads;
+		std::atomic< uint32_t > failures{};
+
+		for ( uint32_t index = 0u; index < 8u; ++index )
+		{
+			graphs.push_back( std::make_unique< crg::RenderGraph >( testCounts.testName ) );
+			buildGraph( testCounts, *graphs.back(), index % 2u == 0u );
+		}
+
+		for ( auto & graph : graphs )
+		{
+			threads.emplace_back( [&directory, &failures, &graph]()
+				{
+					try
+					{
+						crg::CompileCache cache{ directory };
+						graph->setCompileCache( &cache );
+
+						for ( uint32_t run = 0u; run < 10u; ++run )
+						{
+							graph->compile();
+
+							if ( graph->getExecutionOrder().empty() )
+							{
+								++failures;
+							}
+						}
+
+						graph->setCompileCache( nullptr );
+					}
+					catch ( std::exception & )
+					{
+						++failures;
+					}
+				} );
+		}
+
+		for ( auto & thread : threads )
+		{
+			thread.join();
+		}
+
+		check( failures == 0u );
+		crg::CompileCache cache{ directory };
+		crg::RenderGraph graph{ testCounts.testName };
+		buildGraph( testCounts, graph, true );
+		graph.setCompileCache( &cache );
+		checkNoThrow( graph.compile() );
+		check( cache.getStats().hits == 1u );
+		testEnd();
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	testSuiteBegin( "TestCompiledGraph" );
+	testRoundTrip( testCounts );
+	testMappedFile( testCounts );
+	testRejected( testCounts );
+	testRejectedContent( testCounts );
+	testCompileCache( testCounts );
+	testCompileCacheEviction( testCounts );
+	testCompileCacheConcurrency( testCounts );
+	testSuiteEnd();
+}
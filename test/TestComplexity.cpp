@@ -0,0 +1,86 @@
+#include "Common.hpp"
+#include "GraphGenerator.hpp"
+
+#include <RenderGraph/RenderGraph.hpp>
+
+namespace
+{
+	// The graphs are compiled with SmallSize and Factor * SmallSize passes.
+	static uint32_t constexpr SmallSize = 256u;
+	static uint32_t constexpr Factor = 4u;
+	// Linear work can grow a bit faster than the passes count,
+	// since generated graphs don't grow exactly linearly, but quadratic work would grow by Factor * Factor.
+	static double constexpr MaxRatio = 1.5 * Factor;
+
+	struct OpCounts
+	{
+		uint64_t overlapTests{};
+		uint64_t dependencyLookups{};
+		uint64_t graphVisits{};
+		uint64_t transitions{};
+		uint64_t dependencies{};
+	};
+
+	OpCounts compileGraph( test::GraphShape shape
+		, uint32_t passCount )
+	{
+		crg::RenderGraph graph{ test::getName( shape ) };
+		test::generateGraph( graph, shape, passCount );
+		graph.enableCompileStats( true );
+		graph.compile();
+		auto & stats = graph.getCompileStats();
+		return OpCounts{ stats.overlapTests
+			, stats.dependencyLookups
+			, stats.graphVisits
+			, stats.transitionsBeforeMerges
+			, stats.dependenciesCreated };
+	}
+
+	// The transitions count is quadratic for FanPerPass, only the work per transition must stay constant.
+	bool hasLinearOutput( test::GraphShape shape )
+	{
+		return shape != test::GraphShape::FanPerPass;
+	}
+
+	double getRatio( uint64_t small
+		, uint64_t large )
+	{
+		return double( large ) / double( std::max( small, uint64_t( 1u ) ) );
+	}
+
+	void testCompileScaling( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileScaling" );
+
+		for ( uint32_t index = 0u; index < uint32_t( test::GraphShape::Count ); ++index )
+		{
+			auto shape = test::GraphShape( index );
+			auto small = compileGraph( shape, SmallSize );
+			auto large = compileGraph( shape, Factor * SmallSize );
+			// Each attachment is only tested against the ones on the same image.
+			check( getRatio( small.overlapTests, large.overlapTests ) <= MaxRatio );
+			// Dependencies are looked up once per image transition or buffer dependency they produce.
+			check( small.dependencyLookups <= small.transitions + small.dependencies );
+			check( large.dependencyLookups <= large.transitions + large.dependencies );
+			// Each dependency is visited once, when building the graph nodes.
+			check( small.graphVisits <= small.dependencies );
+			check( large.graphVisits <= large.dependencies );
+			check( getRatio( small.graphVisits, large.graphVisits ) <= MaxRatio );
+
+			if ( hasLinearOutput( shape ) )
+			{
+				check( getRatio( small.dependencyLookups, large.dependencyLookups ) <= MaxRatio );
+				check( getRatio( small.transitions, large.transitions ) <= MaxRatio );
+			}
+		}
+
+		testEnd();
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	testSuiteBegin( "TestComplexity" );
+	testCompileScaling( testCounts );
+	testSuiteEnd();
+}
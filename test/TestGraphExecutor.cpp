@@ -0,0 +1,253 @@
+#include "Common.hpp"
+
+#include <RenderGraph/GraphExecutor.hpp>
+#include <RenderGraph/ImageData.hpp>
+#include <RenderGraph/RenderGraph.hpp>
+#include <RenderGraph/ThreadPool.hpp>
+
+#include <atomic>
+
+namespace
+{
+	uint32_t findIndex( crg::RenderPassArray const & order
+		, crg::RenderPass const * pass )
+	{
+		return uint32_t( std::distance( order.begin()
+			, std::find( order.begin(), order.end(), pass ) ) );
+	}
+
+	void buildDiamond( test::TestCounts & testCounts
+		, crg::RenderGraph & graph )
+	{
+		auto a = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto av = graph.createView( test::createView( a, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto b = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto bv = graph.createView( test::createView( b, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto c = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto cv = graph.createView( test::createView( c, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto d = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto dv = graph.createView( test::createView( d, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		// Registered in reverse order, so that the execution order differs from the registration one.
+		crg::RenderPass pass3
+		{
+			"pass3",
+			{ crg::Attachment::createSampled( "BSp", bv ), crg::Attachment::createSampled( "CSp", cv ) },
+			{ crg::Attachment::createOutputColour( "DTg", dv ) },
+		};
+		checkNoThrow( graph.add( pass3 ) );
+		crg::RenderPass pass2
+		{
+			"pass2",
+			{ crg::Attachment::createSampled( "ASp", av ) },
+			{ crg::Attachment::createOutputColour( "CTg", cv ) },
+		};
+		checkNoThrow( graph.add( pass2 ) );
+		crg::RenderPass pass1
+		{
+			"pass1",
+			{ crg::Attachment::createSampled( "ASp", av ) },
+			{ crg::Attachment::createOutputColour( "BTg", bv ) },
+		};
+		checkNoThrow( graph.add( pass1 ) );
+		crg::RenderPass pass0
+		{
+			"pass0",
+			{},
+			{ crg::Attachment::createOutputColour( "ATg", av ) },
+		};
+		checkNoThrow( graph.add( pass0 ) );
+		checkNoThrow( graph.compile() );
+	}
+
+	void testThreadPool( test::TestCounts & testCounts )
+	{
+		testBegin( "testThreadPool" );
+		crg::ThreadPool pool{ 3u };
+		check( pool.getThreadCount() == 4u );
+		std::vector< uint32_t > values( 1000u, 0u );
+		std::atomic< uint32_t > count{};
+		checkNoThrow( pool.parallelFor( uint32_t( values.size() )
+			, [&values, &count]( uint32_t index, uint32_t thread )
+			{
+				values[index] = index + 1u;
+				++count;
+			} ) );
+		check( count == values.size() );
+
+		for ( uint32_t index = 0u; index < values.size(); ++index )
+		{
+			check( values[index] == index + 1u );
+		}
+
+		checkThrow( pool.parallelFor( 100u
+			, []( uint32_t index, uint32_t thread )
+			{
+				if ( index == 50u )
+				{
+					throw std::runtime_error{ "Job failure" };
+				}
+			} ) );
+		count = 0u;
+		checkNoThrow( pool.parallelFor( 10u
+			, [&count]( uint32_t index, uint32_t thread )
+			{
+				++count;
+			} ) );
+		check( count == 10u );
+		testEnd();
+	}
+
+	void testExecutionOrder( test::TestCounts & testCounts )
+	{
+		testBegin( "testExecutionOrder" );
+		crg::RenderGraph graph{ testCounts.testName };
+		buildDiamond( testCounts, graph );
+		auto & order = graph.getExecutionOrder();
+		require( order.size() == 4u );
+		check( order.front()->name == "pass0" );
+		check( order.back()->name == "pass3" );
+
+		for ( auto & dependency : graph.getDependencies() )
+		{
+			check( findIndex( order, dependency.srcPass ) < findIndex( order, dependency.dstPass ) );
+		}
+
+		testEnd();
+	}
+
+	void testParallelRecord( test::TestCounts & testCounts )
+	{
+		testBegin( "testParallelRecord" );
+		crg::RenderGraph graph{ testCounts.testName };
+		buildDiamond( testCounts, graph );
+		auto & order = graph.getExecutionOrder();
+		crg::ThreadPool pool{ 3u };
+		crg::GraphExecutor executor{ graph, pool };
+		std::vector< crg::RenderPass const * > recorded( order.size(), nullptr );
+		std::vector< crg::RenderPass const * > stitched;
+		checkNoThrow( executor.run( [&recorded]( crg::RenderPass const & pass, uint32_t index, uint32_t thread )
+			{
+				recorded[index] = &pass;
+			}
+			, [&recorded, &stitched]( crg::RenderPass const & pass, uint32_t index )
+			{
+				if ( recorded[index] == &pass )
+				{
+					stitched.push_back( &pass );
+				}
+			} ) );
+		check( recorded == order );
+		check( stitched == order );
+		testEnd();
+	}
+
+	void testUserJobSystem( test::TestCounts & testCounts )
+	{
+		testBegin( "testUserJobSystem" );
+		crg::RenderGraph graph{ testCounts.testName };
+		buildDiamond( testCounts, graph );
+		auto & order = graph.getExecutionOrder();
+		uint32_t jobCount{};
+		crg::GraphExecutor executor{ graph
+			, [&jobCount]( uint32_t count, std::function< void( uint32_t, uint32_t ) > const & job )
+			{
+				// Record backwards, to make sure the stitching doesn't depend on the recording order.
+				for ( auto index = count; index > 0u; --index )
+				{
+					job( index - 1u, 0u );
+					++jobCount;
+				}
+			} };
+		std::vector< crg::RenderPass const * > stitched;
+		checkNoThrow( executor.run( []( crg::RenderPass const & pass, uint32_t index, uint32_t thread )
+			{
+			}
+			, [&stitched]( crg::RenderPass const & pass, uint32_t index )
+			{
+				stitched.push_back( &pass );
+			} ) );
+		check( jobCount == order.size() );
+		check( stitched == order );
+		testEnd();
+	}
+
+	void testCommandsCache( test::TestCounts & testCounts )
+	{
+		testBegin( "testCommandsCache" );
+		crg::RenderGraph graph{ testCounts.testName };
+		buildDiamond( testCounts, graph );
+		crg::GraphExecutor executor{ graph
+			, []( uint32_t count, std::function< void( uint32_t, uint32_t ) > const & job )
+			{
+				for ( uint32_t index = 0u; index < count; ++index )
+				{
+					job( index, 0u );
+				}
+			} };
+		std::set< std::string > recorded;
+		auto record = [&recorded]( crg::RenderPass const & pass, uint32_t index, uint32_t thread )
+		{
+			recorded.insert( pass.name );
+		};
+		auto stitch = []( crg::RenderPass const & pass, uint32_t index )
+		{
+		};
+		executor.setCacheable( "pass1" );
+		executor.setCacheable( "pass2", 1u );
+
+		checkNoThrow( executor.run( record, stitch ) );
+		check( recorded.size() == 4u );
+		check( executor.getCacheStats().hits == 0u );
+		check( executor.getCacheStats().misses == 2u );
+
+		recorded.clear();
+		executor.resetCacheStats();
+		checkNoThrow( executor.run( record, stitch ) );
+		check( recorded == std::set< std::string >( { "pass0", "pass3" } ) );
+		check( executor.getCacheStats().hits == 2u );
+		check( executor.getCacheStats().misses == 0u );
+
+		// Bumping the user version invalidates the recorded commands.
+		recorded.clear();
+		executor.resetCacheStats();
+		executor.setCacheable( "pass2", 2u );
+		checkNoThrow( executor.run( record, stitch ) );
+		check( recorded == std::set< std::string >( { "pass0", "pass2", "pass3" } ) );
+		check( executor.getCacheStats().hits == 1u );
+		check( executor.getCacheStats().misses == 1u );
+
+		// An identical compilation keeps them.
+		recorded.clear();
+		executor.resetCacheStats();
+		checkNoThrow( graph.compile() );
+		checkNoThrow( executor.run( record, stitch ) );
+		check( recorded == std::set< std::string >( { "pass0", "pass3" } ) );
+		check( executor.getCacheStats().hits == 2u );
+
+		// Removing pass1 changes pass2 input transition.
+		recorded.clear();
+		executor.resetCacheStats();
+		checkNoThrow( graph.remove( *graph.getExecutionOrder()[2] ) );
+		checkNoThrow( graph.compile() );
+		checkNoThrow( executor.run( record, stitch ) );
+		check( recorded == std::set< std::string >( { "pass0", "pass2", "pass3" } ) );
+		check( executor.getCacheStats().misses == 1u );
+
+		recorded.clear();
+		executor.setUncacheable( "pass2" );
+		checkNoThrow( executor.run( record, stitch ) );
+		check( recorded == std::set< std::string >( { "pass0", "pass2", "pass3" } ) );
+		testEnd();
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	testSuiteBegin( "TestGraphExecutor" );
+	testThreadPool( testCounts );
+	testExecutionOrder( testCounts );
+	testParallelRecord( testCounts );
+	testUserJobSystem( testCounts );
+	testCommandsCache( testCounts );
+	testSuiteEnd();
+}
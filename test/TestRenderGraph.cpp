@@ -1,9 +1,17 @@
-#include "Common.hpp"
+﻿#include "Common.hpp"
+#include "GraphGenerator.hpp"
 
+#include <RenderGraph/Exception.hpp>
+#include <RenderGraph/GraphVisit.hpp>
 #include <RenderGraph/RenderGraph.hpp>
 #include <RenderGraph/ImageData.hpp>
 
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <random>
 #include <sstream>
+#include <thread>
 
 namespace
 {
@@ -123,6 +131,140 @@ namespace
 		testEnd();
 	}
 
+	void testPassIds( test::TestCounts & testCounts )
+	{
+		testBegin( "testPassIds" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto rt = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtv = graph.createView( test::createView( rt, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtAttach = crg::Attachment::createOutputColour( "RT"
+			, rtv );
+		crg::RenderPass pass1
+		{
+			"pass1C",
+			{},
+			{ rtAttach },
+		};
+		auto inAttach = crg::Attachment::createSampled( "IN"
+			, rtv );
+		auto out = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto outv = graph.createView( test::createView( out, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto outAttach = crg::Attachment::createOutputColour( "OUT"
+			, outv );
+		crg::RenderPass pass2
+		{
+			"pass2C",
+			{ inAttach },
+			{ outAttach },
+		};
+		auto id1 = graph.add( pass1 );
+		auto id2 = graph.add( pass2 );
+		check( id1 != id2 );
+		check( graph.getPass( id1 ).name == "pass1C" );
+		check( graph.getPass( id2 ).name == "pass2C" );
+		checkNoThrow( graph.compile() );
+		check( graph.getExecutionOrder().size() == 2u );
+
+		// Removing a pass clears the compiled data referencing it.
+		checkNoThrow( graph.remove( id1 ) );
+		check( graph.getExecutionOrder().empty() );
+		check( graph.getDependencies().empty() );
+		check( graph.getTransitions().empty() );
+		check( graph.getGraph()->getNext().empty() );
+		checkThrow( graph.remove( id1 ) );
+		checkThrow( graph.remove( pass1 ) );
+		checkNoThrow( graph.compile() );
+		check( graph.getExecutionOrder().size() == 1u );
+
+		// The name can be registered again, and the other handles stay valid.
+		auto id3 = graph.add( pass1 );
+		check( id3 != id1 );
+		checkNoThrow( graph.compile() );
+		check( graph.getExecutionOrder().size() == 2u );
+		check( graph.getExecutionOrder().front()->name == "pass1C" );
+		checkNoThrow( graph.remove( id2 ) );
+		checkNoThrow( graph.remove( pass1 ) );
+		checkThrow( graph.remove( id3 ) );
+		checkThrow( graph.compile() );
+		testEnd();
+	}
+
+	void testDestroyResources( test::TestCounts & testCounts )
+	{
+		testBegin( "testDestroyResources" );
+		crg::RenderGraph graph{ testCounts.testName };
+		check( sizeof( crg::ImageViewId ) == 2u * sizeof( uint32_t ) );
+		auto rt = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtv = graph.createView( test::createView( rt, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		checkNoThrow( graph.destroyView( rtv ) );
+		checkThrow( graph.getView( rtv ) );
+		checkThrow( graph.destroyView( rtv ) );
+
+		// The slot is reused, with another generation.
+		auto otherv = graph.createView( test::createView( rt, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		check( otherv.id == rtv.id );
+		check( otherv != rtv );
+		checkNoThrow( graph.getView( otherv ) );
+
+		// Passes using destroyed views can't be compiled.
+		crg::RenderPass pass
+		{
+			"pass1C",
+			{},
+			{ crg::Attachment::createOutputColour( "RT", rtv ) },
+		};
+		auto passId = graph.add( pass );
+		checkThrow( graph.compile() );
+		checkNoThrow( graph.remove( passId ) );
+		crg::RenderPass otherPass
+		{
+			"pass2C",
+			{},
+			{ crg::Attachment::createOutputColour( "RT", otherv ) },
+		};
+		checkNoThrow( graph.add( otherPass ) );
+		checkNoThrow( graph.compile() );
+
+		// Destroying a history image destroys its backings and aliases.
+		auto h = graph.createHistoryImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ), 2u );
+		auto hv = graph.createView( test::createView( h, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto prevv = graph.createHistoryView( hv );
+		auto prev = graph.getView( prevv ).image;
+		auto backing = graph.getBackingImage( h, 0u );
+		checkNoThrow( graph.destroyImage( h ) );
+		check( !graph.isHistoryImage( h ) );
+		check( !graph.isHistoryImage( prev ) );
+		checkThrow( graph.getImage( prev ) );
+		checkThrow( graph.getImage( backing ) );
+		checkThrow( graph.destroyImage( h ) );
+		testEnd();
+	}
+
+	void testSharedViews( test::TestCounts & testCounts )
+	{
+		testBegin( "testSharedViews" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto rt1 = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rt2 = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		// Identical images are distinct resources.
+		check( rt1 != rt2 );
+		auto rtv1 = graph.createView( test::createView( rt1, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtv2 = graph.createView( test::createView( rt2, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtv3 = graph.createView( test::createView( rt1, VK_FORMAT_R32G32B32A32_SFLOAT, 1u ) );
+		check( rtv1 != rtv2 );
+		check( rtv1 != rtv3 );
+		// Identical views share their handle, until destroyed as many times as created.
+		auto sharedv = graph.createView( test::createView( rt1, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		check( sharedv == rtv1 );
+		checkNoThrow( graph.destroyView( sharedv ) );
+		checkNoThrow( graph.getView( rtv1 ) );
+		checkNoThrow( graph.destroyView( rtv1 ) );
+		checkThrow( graph.getView( rtv1 ) );
+		auto otherv = graph.createView( test::createView( rt1, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		check( otherv != rtv1 );
+		testEnd();
+	}
+
 	void testOneDependency( test::TestCounts & testCounts )
 	{
 		testBegin( "testOneDependency" );
@@ -404,6 +546,58 @@ namespace
 		testEnd();
 	}
 
+	void testLayerDependencies( test::TestCounts & testCounts )
+	{
+		testBegin( "testLayerDependencies" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto imageData = test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT, 1u );
+		imageData.arrayLayers = 4u;
+		auto array = graph.createImage( imageData );
+		auto layerData = test::createView( array, VK_FORMAT_R32G32B32A32_SFLOAT );
+		layerData.subresourceRange.baseArrayLayer = 2u;
+		auto layerv = graph.createView( layerData );
+		auto layerAttach = crg::Attachment::createOutputColour( "LayerTg"
+			, layerv );
+		crg::RenderPass layerPass
+		{
+			"layerPass",
+			{},
+			{ layerAttach },
+		};
+		checkNoThrow( graph.add( layerPass ) );
+
+		// The sampled view starts before the written layer, and spans more layers than it.
+		auto arrayData = test::createView( array, VK_FORMAT_R32G32B32A32_SFLOAT );
+		arrayData.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+		arrayData.subresourceRange.layerCount = 4u;
+		auto arrayv = graph.createView( arrayData );
+		auto arrayAttach = crg::Attachment::createSampled( "ArraySp"
+			, arrayv );
+		auto out = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto outv = graph.createView( test::createView( out, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto outAttach = crg::Attachment::createOutputColour( "OutTg"
+			, outv );
+		crg::RenderPass arrayPass
+		{
+			"arrayPass",
+			{ arrayAttach },
+			{ outAttach },
+		};
+		checkNoThrow( graph.add( arrayPass ) );
+
+		checkNoThrow( graph.compile() );
+		std::stringstream stream;
+		test::display( testCounts, stream, graph );
+		std::string ref = R"(digraph ")" + testCounts.testName + R"(" {
+    "LayerTg\nto\nArraySp" [ shape=square ];
+    "layerPass" -> "LayerTg\nto\nArraySp" [ label="LayerTg" ];
+    "LayerTg\nto\nArraySp" -> "arrayPass" [ label="ArraySp" ];
+}
+)";
+		checkEqualLines( sort( stream.str() ), sort( ref ) );
+		testEnd();
+	}
+
 	void testLoopDependencies( test::TestCounts & testCounts )
 	{
 		testBegin( "testLoopDependencies" );
@@ -438,6 +632,13 @@ namespace
 		checkNoThrow( graph.add( pass2 ) );
 
 		checkThrow( graph.compile() );
+		// The cycle is still reported.
+		require( graph.getCycles().size() == 1u );
+		auto & cycle = graph.getCycles().front();
+		require( cycle.passes.size() == 2u );
+		check( cycle.passes[0]->name == pass1.name );
+		check( cycle.passes[1]->name == pass2.name );
+		check( cycle.dependencies.size() == 2u );
 		testEnd();
 	}
 
@@ -560,6 +761,1010 @@ namespace
 }
 )";
 		checkEqualLines( sort( stream.str() ), sort( ref ) );
+
+		require( graph.getCycles().size() == 1u );
+		auto & cycle = graph.getCycles().front();
+		require( cycle.passes.size() == 2u );
+		check( cycle.passes[0]->name == pass1.name );
+		check( cycle.passes[1]->name == pass2.name );
+		require( cycle.dependencies.size() == 2u );
+		check( cycle.dependencies[0].srcPass->name == pass1.name );
+		check( cycle.dependencies[0].srcOutputs.front().name == atAttach.name );
+		check( cycle.dependencies[0].dstInputs.front().name == asAttach.name );
+		check( cycle.dependencies[1].srcPass->name == pass2.name );
+		check( cycle.dependencies[1].srcOutputs.front().name == btAttach.name );
+		check( cycle.dependencies[1].dstInputs.front().name == bsAttach.name );
+		// The cycle is kept together in the execution order, broken at its first registered pass.
+		auto & order = graph.getExecutionOrder();
+		require( order.size() == 4u );
+		check( order[0]->name == pass0.name );
+		check( order[1]->name == pass1.name );
+		check( order[2]->name == pass2.name );
+		check( order[3]->name == pass3.name );
+		testEnd();
+	}
+
+	void testBarriers( test::TestCounts & testCounts )
+	{
+		testBegin( "testBarriers" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto rt = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtv = graph.createView( test::createView( rt, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		crg::RenderPass pass1
+		{
+			"pass1C",
+			{},
+			{ crg::Attachment::createOutputColour( "RT", rtv ) },
+		};
+		checkNoThrow( graph.add( pass1 ) );
+		auto out = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto outv = graph.createView( test::createView( out, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		crg::RenderPass pass2
+		{
+			"pass2C",
+			{ crg::Attachment::createSampled( "IN", rtv ) },
+			{ crg::Attachment::createOutputColour( "OUT", outv ) },
+		};
+		checkNoThrow( graph.add( pass2 ) );
+		checkNoThrow( graph.compile() );
+
+		auto & barriers = graph.getBarriers();
+		require( barriers.size() == 2u );
+		require( barriers[0].images.size() == 1u );
+		check( barriers[0].images[0].image == rt );
+		check( barriers[0].images[0].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED );
+		check( barriers[0].images[0].newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL );
+		require( barriers[1].images.size() == 2u );
+		check( barriers[1].images[0].image == rt );
+		check( barriers[1].images[0].oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL );
+		check( barriers[1].images[0].newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+		check( barriers[1].images[0].srcAccessMask == VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT );
+		check( barriers[1].images[0].dstAccessMask == VK_ACCESS_SHADER_READ_BIT );
+		check( barriers[1].images[1].image == out );
+		check( barriers[1].images[1].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED );
+		testEnd();
+	}
+
+	void testHistoryImage( test::TestCounts & testCounts )
+	{
+		testBegin( "testHistoryImage" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto c = graph.createImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto cv = graph.createView( test::createView( c, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		crg::RenderPass lightingPass
+		{
+			"lightingPass",
+			{},
+			{ crg::Attachment::createOutputColour( "ColourTg", cv ) },
+		};
+		checkNoThrow( graph.add( lightingPass ) );
+
+		auto h = graph.createHistoryImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ), 2u );
+		auto hv = graph.createView( test::createView( h, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		checkThrow( graph.createHistoryView( cv ) );
+		checkThrow( graph.createHistoryView( hv, 2u ) );
+		auto prevv = graph.createHistoryView( hv );
+		check( graph.isHistoryImage( h ) );
+		check( graph.isHistoryImage( graph.getView( prevv ).image ) );
+		check( !graph.isHistoryImage( c ) );
+		crg::RenderPass taaPass
+		{
+			"taaPass",
+			{ crg::Attachment::createSampled( "ColourSp", cv ), crg::Attachment::createSampled( "HistorySp", prevv ) },
+			{ crg::Attachment::createOutputColour( "HistoryTg", hv ) },
+		};
+		checkNoThrow( graph.add( taaPass ) );
+		checkNoThrow( graph.compile() );
+
+		// The history read doesn't create a dependency within the frame.
+		require( graph.getDependencies().size() == 1u );
+		check( graph.getDependencies()[0].srcPass->name == "lightingPass" );
+		require( graph.getHistoryDependencies().size() == 1u );
+		check( graph.getHistoryDependencies()[0].srcPass->name == "taaPass" );
+		check( graph.getHistoryDependencies()[0].dstPass->name == "taaPass" );
+		check( graph.getHistoryDependencies()[0].dstInputs[0].name == "HistorySp" );
+
+		// Frame K writes to the backing that frame K + 1 reads.
+		check( graph.getBackingImage( c, 0u ) == c );
+		check( graph.getBackingImage( h, 0u ) != graph.getBackingImage( h, 1u ) );
+		check( graph.getBackingImage( h, 0u ) == graph.getBackingImage( h, 2u ) );
+		check( graph.getBackingImage( h, 0u ) == graph.getBackingImage( graph.getView( prevv ).image, 1u ) );
+		check( graph.getBackingImage( h, 1u ) == graph.getBackingImage( graph.getView( prevv ).image, 0u ) );
+
+		// The history content is read in the layout it was written to, in the previous frame.
+		auto & order = graph.getExecutionOrder();
+		require( order.size() == 2u );
+		require( order[1]->name == "taaPass" );
+		auto & barriers = graph.getBarriers()[1].images;
+		auto prevImage = graph.getView( prevv ).image;
+		auto historyIt = std::find_if( barriers.begin()
+			, barriers.end()
+			, [&prevImage]( crg::ImageBarrier const & lookup )
+			{
+				return lookup.image == prevImage;
+			} );
+		require( historyIt != barriers.end() );
+		check( historyIt->oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL );
+		check( historyIt->newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+		check( historyIt->srcAccessMask == VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT );
+		auto currentIt = std::find_if( barriers.begin()
+			, barriers.end()
+			, [&h]( crg::ImageBarrier const & lookup )
+			{
+				return lookup.image == h;
+			} );
+		require( currentIt != barriers.end() );
+		check( currentIt->oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+		check( currentIt->newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL );
+		testEnd();
+	}
+
+	void testTransitiveReduction( test::TestCounts & testCounts )
+	{
+		testBegin( "testTransitiveReduction" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto a = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto av = graph.createView( test::createView( a, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto b = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto bv = graph.createView( test::createView( b, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto c = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto cv = graph.createView( test::createView( c, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		crg::RenderPass passA
+		{
+			"passA",
+			{},
+			{ crg::Attachment::createOutputColour( "ATg", av ) },
+		};
+		checkNoThrow( graph.add( passA ) );
+		crg::RenderPass passB
+		{
+			"passB",
+			{ crg::Attachment::createSampled( "ASp", av ) },
+			{ crg::Attachment::createOutputColour( "BTg", bv ) },
+		};
+		checkNoThrow( graph.add( passB ) );
+		// passC depends on passA directly, and through passB.
+		crg::RenderPass passC
+		{
+			"passC",
+			{ crg::Attachment::createSampled( "ASp", av )
+				, crg::Attachment::createSampled( "BSp", bv ) },
+			{ crg::Attachment::createOutputColour( "CTg", cv ) },
+		};
+		checkNoThrow( graph.add( passC ) );
+		graph.enableCompileStats( true );
+		checkNoThrow( graph.compile() );
+
+		auto & dependencies = graph.getDependencies();
+		require( dependencies.size() == 3u );
+		uint32_t redundants{};
+
+		for ( auto & dependency : dependencies )
+		{
+			auto isAToC = dependency.srcPass->name == passA.name
+				&& dependency.dstPass->name == passC.name;
+			check( dependency.redundant == isAToC );
+
+			if ( dependency.redundant )
+			{
+				++redundants;
+				// The attachments are kept.
+				require( dependency.srcOutputs.size() == 1u );
+				check( dependency.srcOutputs.front().name == "ATg" );
+			}
+		}
+
+		check( redundants == 1u );
+		check( graph.getCompileStats().dependenciesCreated == 3u );
+		check( graph.getCompileStats().dependenciesAfterReduction == 2u );
+		testEnd();
+	}
+
+	void testReachability( test::TestCounts & testCounts )
+	{
+		testBegin( "testReachability" );
+		struct Case
+		{
+			test::GraphShape shape;
+			size_t maxSize;
+			crg::ReachabilityMode mode;
+		};
+		// 200 passes give a matrix of 6400 bytes and, as a single chain, 800 bytes of chains.
+		// Rings of 4 passes give 53 components, and a matrix of 424 bytes.
+		Case const cases[]
+		{
+			{ test::GraphShape::RandomDag, crg::PassReachability::DefaultMaxSize, crg::ReachabilityMode::Matrix },
+			{ test::GraphShape::Rings, crg::PassReachability::DefaultMaxSize, crg::ReachabilityMode::Matrix },
+			{ test::GraphShape::Chain, 1000u, crg::ReachabilityMode::Chains },
+			{ test::GraphShape::Rings, 300u, crg::ReachabilityMode::Chains },
+			{ test::GraphShape::RandomDag, 0u, crg::ReachabilityMode::Search },
+			{ test::GraphShape::Rings, 0u, crg::ReachabilityMode::Search },
+			{ test::GraphShape::Diamond, 0u, crg::ReachabilityMode::Search },
+		};
+
+		for ( auto & current : cases )
+		{
+			crg::RenderGraph graph{ testCounts.testName };
+			test::generateGraph( graph, current.shape, 200u );
+			graph.setReachabilityMaxSize( current.maxSize );
+			checkNoThrow( graph.compile() );
+			check( graph.getReachability().mode == current.mode );
+
+			// The expected dependencies, found by following the dependencies backwards.
+			std::map< crg::RenderPass const *, crg::RenderPassArray > srcs;
+
+			for ( auto & dependency : graph.getDependencies() )
+			{
+				srcs[dependency.dstPass].push_back( dependency.srcPass );
+			}
+
+			auto & passes = graph.getExecutionOrder();
+
+			for ( auto pass : passes )
+			{
+				std::set< crg::RenderPass const * > expected;
+				crg::RenderPassArray stack{ pass };
+
+				while ( !stack.empty() )
+				{
+					auto current = stack.back();
+					stack.pop_back();
+
+					for ( auto src : srcs[current] )
+					{
+						if ( expected.insert( src ).second )
+						{
+							stack.push_back( src );
+						}
+					}
+				}
+
+				auto dependencies = graph.getTransitiveDependencies( *pass );
+				check( std::set< crg::RenderPass const * >( dependencies.begin(), dependencies.end() ) == expected );
+				auto batch = graph.dependsOn( *pass, passes );
+				require( batch.size() == passes.size() );
+
+				for ( size_t index = 0u; index < passes.size(); ++index )
+				{
+					auto other = passes[index];
+					auto dependsOn = expected.end() != expected.find( other );
+					check( batch[index] == dependsOn );
+					check( graph.dependsOn( *pass, *other ) == dependsOn );
+				}
+			}
+		}
+
+		crg::RenderGraph graph{ testCounts.testName };
+		test::generateGraph( graph, test::GraphShape::Chain, 3u );
+		auto & pass = graph.getPass( crg::PassId{ 1u, 0u } );
+		checkThrow( graph.dependsOn( pass, pass ) );
+		checkNoThrow( graph.compile() );
+		check( graph.dependsOn( crg::PassId{ 3u, 0u }, crg::PassId{ 1u, 0u } ) );
+		check( !graph.dependsOn( crg::PassId{ 1u, 0u }, crg::PassId{ 3u, 0u } ) );
+		check( !graph.dependsOn( pass, pass ) );
+
+		// A pass added after the compilation is not part of the reachability.
+		auto rt = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtv = graph.createView( test::createView( rt, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		crg::RenderPass added
+		{
+			"added",
+			{},
+			{ crg::Attachment::createOutputColour( "RT", rtv ) },
+		};
+		checkNoThrow( graph.add( added ) );
+		auto & last = graph.getPass( crg::PassId{ 3u, 0u } );
+		check( graph.getTransitiveDependencies( last ).size() == 2u );
+		checkThrow( graph.getTransitiveDependencies( graph.getPass( crg::PassId{ 4u, 0u } ) ) );
+		testEnd();
+	}
+
+	void testGraphTraversal( test::TestCounts & testCounts )
+	{
+		testBegin( "testGraphTraversal" );
+		static_assert( std::is_same_v< std::iterator_traits< crg::GraphTraversal::Iterator >::iterator_category, std::input_iterator_tag > );
+
+		for ( auto shape : { test::GraphShape::Diamond, test::GraphShape::RandomDag, test::GraphShape::Rings } )
+		{
+			crg::RenderGraph graph{ testCounts.testName };
+			test::generateGraph( graph, shape, 100u );
+			checkNoThrow( graph.compile() );
+			crg::GraphTraversal traversal{ graph };
+
+			for ( auto order : { crg::GraphTraversal::Order::BreadthFirst
+				, crg::GraphTraversal::Order::DepthFirst
+				, crg::GraphTraversal::Order::Topological } )
+			{
+				// The rank of each node in the traversal.
+				std::vector< uint32_t > ranks( graph.getNodeCount(), ~0u );
+				std::vector< crg::GraphAdjacentNode > nodes;
+
+				for ( auto node : traversal.traverse( order ) )
+				{
+					check( ranks[node->getIndex()] == ~0u );
+					ranks[node->getIndex()] = uint32_t( nodes.size() );
+					nodes.push_back( node );
+				}
+
+				require( nodes.size() == graph.getNodeCount() );
+				check( nodes.front() == graph.getGraph() );
+
+				if ( order == crg::GraphTraversal::Order::Topological )
+				{
+					for ( auto node : nodes )
+					{
+						for ( auto next : node->getNext() )
+						{
+							// Only the edges closing a cycle go backwards.
+							check( ranks[node->getIndex()] < ranks[next->getIndex()]
+								|| shape == test::GraphShape::Rings );
+						}
+					}
+				}
+				else if ( order == crg::GraphTraversal::Order::BreadthFirst )
+				{
+					// The nodes are visited by increasing distance to the root.
+					std::vector< uint32_t > distances( graph.getNodeCount(), ~0u );
+					distances[0u] = 0u;
+
+					for ( auto node : nodes )
+					{
+						check( distances[node->getIndex()] != ~0u );
+
+						for ( auto next : node->getNext() )
+						{
+							distances[next->getIndex()] = std::min( distances[next->getIndex()], distances[node->getIndex()] + 1u );
+						}
+					}
+
+					for ( size_t index = 1u; index < nodes.size(); ++index )
+					{
+						check( distances[nodes[index - 1u]->getIndex()] <= distances[nodes[index]->getIndex()] );
+					}
+				}
+				else if ( order == crg::GraphTraversal::Order::DepthFirst )
+				{
+					// Each node is reached from a node visited before it, and still being explored.
+					for ( size_t index = 1u; index < nodes.size(); ++index )
+					{
+						auto node = nodes[index];
+						check( std::any_of( nodes.begin()
+							, nodes.begin() + ptrdiff_t( index )
+							, [node]( crg::GraphAdjacentNode lookup )
+							{
+								auto & nexts = lookup->getNext();
+								return nexts.end() != std::find( nexts.begin(), nexts.end(), node );
+							} ) );
+					}
+				}
+			}
+		}
+
+		testEnd();
+	}
+
+	void testStaticVisit( test::TestCounts & testCounts )
+	{
+		testBegin( "testStaticVisit" );
+		crg::RenderGraph graph{ testCounts.testName };
+		test::generateGraph( graph, test::GraphShape::Diamond, 31u );
+		checkNoThrow( graph.compile() );
+		uint32_t roots{};
+		std::vector< uint32_t > indices;
+		crg::visit( graph
+			, [&roots]( crg::RootNode const & )
+			{
+				++roots;
+			}
+			, [&indices]( crg::RenderPassNode const & node )
+			{
+				indices.push_back( node.getIndex() );
+			} );
+		check( roots == 1u );
+		require( indices.size() + 1u == graph.getNodeCount() );
+
+		for ( uint32_t index = 0u; index < indices.size(); ++index )
+		{
+			check( indices[index] == index + 1u );
+		}
+
+		// Node kinds without overload are skipped.
+		uint32_t passes{};
+		crg::visit( graph
+			, [&passes]( crg::RenderPassNode const & )
+			{
+				++passes;
+			} );
+		check( passes == indices.size() );
+
+		// Visiting a traversal gives its nodes, in its order, the most specialised overload being called.
+		crg::GraphTraversal traversal{ graph };
+		std::vector< crg::GraphAdjacentNode > expected;
+
+		for ( auto node : traversal.breadthFirst() )
+		{
+			expected.push_back( node );
+		}
+
+		std::vector< crg::GraphAdjacentNode > visited;
+		passes = 0u;
+		crg::visit( traversal.breadthFirst()
+			, [&visited]( crg::GraphNode & node )
+			{
+				visited.push_back( &node );
+			}
+			, [&visited, &passes]( crg::RenderPassNode & node )
+			{
+				visited.push_back( &node );
+				++passes;
+			} );
+		check( visited == expected );
+		check( passes == indices.size() );
+		testEnd();
+	}
+
+	void testConcurrentRegistration( test::TestCounts & testCounts )
+	{
+		testBegin( "testConcurrentRegistration" );
+		static uint32_t constexpr SystemCount = 4u;
+		static uint32_t constexpr PassCount = 16u;
+		// Registers the systems passes from one thread each, the threads being started in given order.
+		auto registerSystems = []( crg::RenderGraph & graph
+			, std::array< uint32_t, SystemCount > const & order )
+		{
+			auto depth = graph.createImage( test::createImage( VK_FORMAT_D32_SFLOAT ) );
+			auto depthv = graph.createView( test::createView( depth, VK_FORMAT_D32_SFLOAT ) );
+			graph.add( crg::RenderPass{ "depthPass"
+				, {}
+				, {}
+				, crg::Attachment::createOutputDepth( "Depth", depthv ) } );
+			std::vector< std::thread > threads;
+
+			for ( auto system : order )
+			{
+				threads.emplace_back( [&graph, system, depthv]()
+					{
+						auto name = "system" + std::to_string( system );
+						auto & staging = graph.getStaging( name );
+						auto input = depthv;
+
+						for ( uint32_t index = 0u; index < PassCount; ++index )
+						{
+							auto image = staging.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+							auto view = staging.createView( test::createView( image, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+							staging.add( crg::RenderPass{ name + "/pass" + std::to_string( index )
+								, { crg::Attachment::createSampled( "In", input ) }
+								, { crg::Attachment::createOutputColour( "Out", view ) } } );
+							input = view;
+						}
+
+						auto buffer = staging.createBuffer( { 0u, 1024u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT } );
+						staging.add( crg::RenderPass::createCompute( name + "/reduce"
+							, { crg::Attachment::createSampled( "In", input ) }
+							, {}
+							, { crg::BufferAttachment::createStorageWrite( "Result", buffer, 0u, 1024u ) } ) );
+					} );
+			}
+
+			for ( auto & thread : threads )
+			{
+				thread.join();
+			}
+		};
+		auto getNames = []( crg::RenderPassArray const & passes )
+		{
+			std::vector< std::string > result;
+
+			for ( auto pass : passes )
+			{
+				result.push_back( pass->name );
+			}
+
+			return result;
+		};
+
+		crg::RenderGraph graph{ testCounts.testName };
+		registerSystems( graph, { 0u, 1u, 2u, 3u } );
+		checkNoThrow( graph.compile() );
+		check( graph.getExecutionOrder().size() == 1u + SystemCount * ( PassCount + 1u ) );
+		check( graph.getDependencies().size() == SystemCount * ( PassCount + 1u ) );
+
+		crg::RenderGraph reversed{ testCounts.testName };
+		registerSystems( reversed, { 3u, 2u, 1u, 0u } );
+		checkNoThrow( reversed.compile() );
+		check( reversed.getGraphHash() == graph.getGraphHash() );
+		check( getNames( reversed.getExecutionOrder() ) == getNames( graph.getExecutionOrder() ) );
+
+		// The stagings are emptied by the merge, and can be filled again.
+		auto & staging = graph.getStaging( "system0" );
+		check( staging.empty() );
+		auto image = staging.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto view = staging.createView( test::createView( image, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		checkThrow( graph.getView( view ) );
+		staging.add( crg::RenderPass{ "extraPass"
+			, {}
+			, { crg::Attachment::createOutputColour( "Out", view ) } } );
+		checkNoThrow( graph.compile() );
+		check( graph.getExecutionOrder().size() == 2u + SystemCount * ( PassCount + 1u ) );
+
+		// A staged handle can't be used in another staging.
+		auto other = graph.getStaging( "system1" ).createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		graph.getStaging( "system2" ).createView( test::createView( other, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		checkThrow( graph.compile() );
+		graph.getStaging( "system1" ).clear();
+		graph.getStaging( "system2" ).clear();
+
+		// Nothing is merged when a staging is invalid, so the valid ones are merged once the invalid one is fixed.
+		auto & valid = graph.getStaging( "system1" );
+		auto validImage = valid.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		valid.add( crg::RenderPass{ "validPass"
+			, {}
+			, { crg::Attachment::createOutputColour( "Out", valid.createView( test::createView( validImage, VK_FORMAT_R32G32B32A32_SFLOAT ) ) ) } } );
+		auto & invalid = graph.getStaging( "system2" );
+		auto invalidImage = invalid.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		invalid.add( crg::RenderPass{ "depthPass"
+			, {}
+			, { crg::Attachment::createOutputColour( "Out", invalid.createView( test::createView( invalidImage, VK_FORMAT_R32G32B32A32_SFLOAT ) ) ) } } );
+		checkThrow( graph.compile() );
+		check( !valid.empty() );
+		check( !invalid.empty() );
+		invalid.clear();
+		checkNoThrow( graph.compile() );
+		check( valid.empty() );
+		check( graph.getExecutionOrder().size() == 3u + SystemCount * ( PassCount + 1u ) );
+
+		// The stagings don't prevent moving the graph.
+		static_assert( std::is_move_constructible_v< crg::RenderGraph > );
+		auto moved = std::move( graph );
+		checkNoThrow( moved.getStaging( "system0" ) );
+		testEnd();
+	}
+
+	void testBufferDependencies( test::TestCounts & testCounts )
+	{
+		testBegin( "testBufferDependencies" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto buffer = graph.createBuffer( { 0u, 1024u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT } );
+		auto rt = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto rtv = graph.createView( test::createView( rt, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		crg::RenderPass drawPass
+		{
+			"drawPass",
+			{},
+			{ crg::Attachment::createOutputColour( "RT", rtv ) },
+			std::nullopt,
+			{ crg::BufferAttachment::createIndirect( "Args", buffer, 0u, 256u )
+				, crg::BufferAttachment::createStorageRead( "Instances", buffer, 256u, 256u ) },
+		};
+		checkNoThrow( graph.add( drawPass ) );
+		crg::RenderPass cullPass
+		{
+			"cullPass",
+			{},
+			{},
+			std::nullopt,
+			{ crg::BufferAttachment::createStorageWrite( "Args", buffer, 0u, 256u )
+				, crg::BufferAttachment::createStorageWrite( "Instances", buffer, 256u, 256u ) },
+		};
+		checkNoThrow( graph.add( cullPass ) );
+		auto other = graph.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		auto otherv = graph.createView( test::createView( other, VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		crg::RenderPass tailPass
+		{
+			"tailPass",
+			{},
+			{ crg::Attachment::createOutputColour( "Other", otherv ) },
+			std::nullopt,
+			{ crg::BufferAttachment::createStorageRead( "Tail", buffer, 512u ) },
+		};
+		checkNoThrow( graph.add( tailPass ) );
+		checkNoThrow( graph.compile() );
+
+		// Only the overlapping ranges create a dependency.
+		auto & dependencies = graph.getDependencies();
+		require( dependencies.size() == 1u );
+		check( dependencies[0].srcPass->name == "cullPass" );
+		check( dependencies[0].dstPass->name == "drawPass" );
+		check( dependencies[0].srcBufferOutputs.size() == 2u );
+		check( dependencies[0].dstBufferInputs.size() == 2u );
+
+		auto & order = graph.getExecutionOrder();
+		require( order.size() == 3u );
+		check( order[0]->name == "cullPass" );
+		check( order[1]->name == "drawPass" );
+
+		auto & barriers = graph.getBarriers();
+		require( barriers.size() == 3u );
+		check( barriers[0].buffers.empty() );
+		require( barriers[1].buffers.size() == 2u );
+		check( barriers[1].buffers[0].buffer == buffer );
+		check( barriers[1].buffers[0].offset == 0u );
+		check( barriers[1].buffers[0].size == 256u );
+		check( barriers[1].buffers[0].srcAccessMask == VK_ACCESS_SHADER_WRITE_BIT );
+		check( barriers[1].buffers[0].dstAccessMask == VK_ACCESS_INDIRECT_COMMAND_READ_BIT );
+		check( barriers[1].buffers[0].dstStageMask == VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT );
+		check( barriers[1].buffers[1].offset == 256u );
+		check( barriers[1].buffers[1].size == 256u );
+		check( barriers[1].buffers[1].dstAccessMask == VK_ACCESS_SHADER_READ_BIT );
+		check( barriers[2].buffers.empty() );
+		testEnd();
+	}
+
+	void testBufferHazards( test::TestCounts & testCounts )
+	{
+		testBegin( "testBufferHazards" );
+		crg::RenderGraph graph{ testCounts.testName };
+		graph.setCompileMode( crg::CompileMode::CrossCheck );
+		auto buffer = graph.createBuffer( { 0u, 1024u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT } );
+		// Read before any write, so it reads what the later writes produce.
+		checkNoThrow( graph.add( crg::RenderPass::createCompute( "statsPass"
+			, {}
+			, {}
+			, { crg::BufferAttachment::createStorageRead( "Stats", buffer, 0u, 256u ) } ) ) );
+		checkNoThrow( graph.add( crg::RenderPass::createCompute( "cullPass"
+			, {}
+			, {}
+			, { crg::BufferAttachment::createStorageWrite( "Args", buffer, 0u, 512u ) } ) ) );
+		checkNoThrow( graph.add( crg::RenderPass::createCompute( "drawPass"
+			, {}
+			, {}
+			, { crg::BufferAttachment::createIndirect( "Args", buffer, 0u, 256u ) } ) ) );
+		checkNoThrow( graph.add( crg::RenderPass::createCompute( "resetPass"
+			, {}
+			, {}
+			, { crg::BufferAttachment::createStorageWrite( "Args", buffer, 0u, 256u ) } ) ) );
+		// Out of the buffer, and too large, ranges are clamped to its end.
+		checkNoThrow( graph.add( crg::RenderPass::createCompute( "farPass"
+			, {}
+			, {}
+			, { crg::BufferAttachment::createStorageRead( "Far", buffer, 2048u, 256u ) } ) ) );
+		checkNoThrow( graph.add( crg::RenderPass::createCompute( "tailPass"
+			, {}
+			, {}
+			, { crg::BufferAttachment::createStorageWrite( "Tail", buffer, 512u, VK_WHOLE_SIZE - 8u ) } ) ) );
+		checkNoThrow( graph.compile() );
+
+		std::vector< std::pair< std::string, std::string > > edges;
+
+		for ( auto & dependency : graph.getDependencies() )
+		{
+			edges.emplace_back( dependency.srcPass->name, dependency.dstPass->name );
+		}
+
+		std::vector< std::pair< std::string, std::string > > expected
+		{
+			{ "cullPass", "statsPass" },
+			{ "cullPass", "drawPass" },
+			{ "resetPass", "statsPass" },
+			{ "cullPass", "resetPass" },
+			{ "drawPass", "resetPass" },
+		};
+		check( edges == expected );
+
+		std::vector< std::string > names;
+
+		for ( auto pass : graph.getExecutionOrder() )
+		{
+			names.push_back( pass->name );
+		}
+
+		auto position = [&names]( std::string const & name )
+		{
+			return std::find( names.begin(), names.end(), name ) - names.begin();
+		};
+		check( position( "cullPass" ) < position( "drawPass" ) );
+		check( position( "drawPass" ) < position( "resetPass" ) );
+		check( position( "resetPass" ) < position( "statsPass" ) );
+		testEnd();
+	}
+
+	void testComputeAndTransfer( test::TestCounts & testCounts )
+	{
+		testBegin( "testComputeAndTransfer" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto d = graph.createImage( test::createImage( VK_FORMAT_D32_SFLOAT ) );
+		auto dv = graph.createView( test::createView( d, VK_FORMAT_D32_SFLOAT ) );
+		auto l = graph.createImage( test::createImage( VK_FORMAT_R32_UINT ) );
+		auto lv = graph.createView( test::createView( l, VK_FORMAT_R32_UINT ) );
+		auto c = graph.createImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto cv = graph.createView( test::createView( c, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto o = graph.createImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto ov = graph.createView( test::createView( o, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		crg::RenderPass depthPass
+		{
+			"depthPass",
+			{},
+			{},
+			crg::Attachment::createOutputDepth( "Depth", dv ),
+		};
+		checkNoThrow( graph.add( depthPass ) );
+		auto cullPass = crg::RenderPass::createCompute( "lightCullPass"
+			, { crg::Attachment::createSampled( "DepthSp", dv ) }
+			, { crg::Attachment::createOutputStorage( "LightsSt", lv ) } );
+		checkNoThrow( graph.add( cullPass ) );
+		crg::RenderPass lightingPass
+		{
+			"lightingPass",
+			{ crg::Attachment::createSampled( "LightsSp", lv ) },
+			{ crg::Attachment::createOutputColour( "ColourTg", cv ) },
+		};
+		checkNoThrow( graph.add( lightingPass ) );
+		auto copyPass = crg::RenderPass::createTransfer( "copyPass"
+			, { crg::Attachment::createTransferSrc( "ColourSrc", cv )
+				, crg::Attachment::createTransferDst( "OutputDst", ov ) } );
+		checkNoThrow( graph.add( copyPass ) );
+		checkNoThrow( graph.compile() );
+
+		auto & order = graph.getExecutionOrder();
+		require( order.size() == 4u );
+		check( order[0]->name == "depthPass" );
+		check( order[1]->name == "lightCullPass" );
+		check( order[2]->name == "lightingPass" );
+		check( order[3]->name == "copyPass" );
+		check( graph.getDependencies().size() == 3u );
+
+		auto & barriers = graph.getBarriers();
+		require( barriers.size() == 4u );
+		require( barriers[1].images.size() == 2u );
+		check( barriers[1].images[0].image == d );
+		check( barriers[1].images[0].newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+		check( barriers[1].images[0].dstStageMask == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT );
+		check( barriers[1].images[1].image == l );
+		check( barriers[1].images[1].oldLayout == VK_IMAGE_LAYOUT_UNDEFINED );
+		check( barriers[1].images[1].newLayout == VK_IMAGE_LAYOUT_GENERAL );
+		check( barriers[1].images[1].dstAccessMask == VK_ACCESS_SHADER_WRITE_BIT );
+		require( barriers[2].images.size() == 2u );
+		check( barriers[2].images[0].image == l );
+		check( barriers[2].images[0].oldLayout == VK_IMAGE_LAYOUT_GENERAL );
+		check( barriers[2].images[0].newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+		check( barriers[2].images[0].srcStageMask == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT );
+		check( barriers[2].images[0].dstStageMask == ( VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT ) );
+		require( barriers[3].images.size() == 2u );
+		check( barriers[3].images[0].image == c );
+		check( barriers[3].images[0].oldLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL );
+		check( barriers[3].images[0].newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL );
+		check( barriers[3].images[0].dstAccessMask == VK_ACCESS_TRANSFER_READ_BIT );
+		check( barriers[3].images[1].image == o );
+		check( barriers[3].images[1].newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
+		check( barriers[3].images[1].dstStageMask == VK_PIPELINE_STAGE_TRANSFER_BIT );
+		testEnd();
+	}
+
+	void testCompileStats( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileStats" );
+		crg::RenderGraph graph{ testCounts.testName };
+		auto d0 = graph.createImage( test::createImage( VK_FORMAT_R32G32B32_SFLOAT ) );
+		auto d0v = graph.createView( test::createView( d0, VK_FORMAT_R32G32B32_SFLOAT ) );
+		auto d1 = graph.createImage( test::createImage( VK_FORMAT_R32G32B32_SFLOAT ) );
+		auto d1v = graph.createView( test::createView( d1, VK_FORMAT_R32G32B32_SFLOAT ) );
+		crg::RenderPass pass0
+		{
+			"pass0",
+			{},
+			{ crg::Attachment::createOutputColour( "D0Tg", d0v ) },
+		};
+		checkNoThrow( graph.add( pass0 ) );
+		crg::RenderPass pass1
+		{
+			"pass1",
+			{ crg::Attachment::createSampled( "D0Sp", d0v ) },
+			{ crg::Attachment::createOutputColour( "D1Tg", d1v ) },
+		};
+		checkNoThrow( graph.add( pass1 ) );
+		crg::RenderPass pass2
+		{
+			"pass2",
+			{ crg::Attachment::createSampled( "D0Sp", d0v )
+				, crg::Attachment::createSampled( "D1Sp", d1v ) },
+			{},
+		};
+		checkNoThrow( graph.add( pass2 ) );
+
+		uint32_t calls{};
+		crg::AllocationCount allocations{};
+		checkNoThrow( graph.compile() );
+		check( graph.getCompileStats().totalTime.count() == 0 );
+
+		graph.setAllocationCounter( [&allocations]()
+			{
+				allocations.allocations += 5u;
+				allocations.bytes += 100u;
+				return allocations;
+			} );
+		graph.setCompileStatsCallback( [&calls]( crg::CompileStats const & )
+			{
+				++calls;
+			} );
+		checkNoThrow( graph.compile() );
+		check( calls == 1u );
+		auto & stats = graph.getCompileStats();
+		check( !stats.fromCache );
+		check( stats.totalTime.count() > 0 );
+		check( stats.phaseTimes[size_t( crg::CompilePhase::BuildPassDependencies )].count() > 0 );
+		check( stats.phaseTimes[size_t( crg::CompilePhase::BuildPassBarriers )].count() > 0 );
+		check( stats.phaseTimes[size_t( crg::CompilePhase::CacheLoad )].count() == 0 );
+		check( stats.overlapTests > 0u );
+		check( stats.dependenciesCreated == graph.getDependencies().size() );
+		check( stats.transitionsBeforeMerges >= stats.transitionsAfterMergeIdentical );
+		check( stats.transitionsAfterReduceDirectPaths == graph.getTransitions().size() );
+		// Each phase reads the counter twice, and so does the whole compilation.
+		check( stats.phaseAllocations[size_t( crg::CompilePhase::SortPasses )] == 5u );
+		check( stats.phaseAllocatedBytes[size_t( crg::CompilePhase::SortPasses )] == 100u );
+		check( stats.allocations > 0u );
+		check( stats.allocatedBytes == stats.allocations * 20u );
+
+		graph.enableCompileStats( false );
+		checkNoThrow( graph.compile() );
+		check( calls == 1u );
+		testEnd();
+	}
+
+	void testCompileModes( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileModes" );
+
+		for ( uint32_t index = 0u; index < uint32_t( test::GraphShape::Count ); ++index )
+		{
+			auto shape = test::GraphShape( index );
+
+			for ( uint32_t seed = 0u; seed < 4u; ++seed )
+			{
+				crg::RenderGraph graph{ test::getName( shape ) };
+				test::generateGraph( graph, shape, 16u, seed );
+				graph.setCompileMode( crg::CompileMode::CrossCheck );
+				checkNoThrow( graph.compile() );
+				auto transitions = graph.getTransitions();
+				auto executionOrder = graph.getExecutionOrder();
+				graph.setCompileMode( crg::CompileMode::Reference );
+				checkNoThrow( graph.compile() );
+				check( graph.getTransitions() == transitions );
+				check( graph.getExecutionOrder() == executionOrder );
+			}
+		}
+
+		testEnd();
+	}
+
+	void testDecodedGraphs( test::TestCounts & testCounts )
+	{
+		testBegin( "testDecodedGraphs" );
+		std::mt19937 random{ 0u };
+
+		for ( uint32_t run = 0u; run < 300u; ++run )
+		{
+			std::vector< uint8_t > data( random() % 256u );
+
+			for ( auto & value : data )
+			{
+				value = uint8_t( random() );
+			}
+
+			crg::RenderGraph graph{ "Decoded" };
+			test::decodeGraph( graph, data.data(), data.size() );
+			graph.enableCompileStats( true );
+
+			try
+			{
+				graph.compile();
+			}
+			catch ( crg::Exception & )
+			{
+				// Graphs without root or leaf are rejected.
+				continue;
+			}
+
+			auto & stats = graph.getCompileStats();
+			check( stats.graphVisits <= stats.dependenciesCreated );
+
+			// The reference compilation is exponential in the dependencies count.
+			if ( stats.dependenciesCreated <= 16u )
+			{
+				graph.setCompileMode( crg::CompileMode::CrossCheck );
+				checkNoThrow( graph.compile() );
+			}
+		}
+
+		testEnd();
+	}
+
+	size_t getHostSum( crg::MemoryReport const & report )
+	{
+		return report.graph
+			+ report.passes
+			+ report.attachments
+			+ report.images
+			+ report.views
+			+ report.buffers
+			+ report.nodes
+			+ report.attachsToPrev
+			+ report.transitions
+			+ report.dependencies
+			+ report.schedule;
+	}
+
+	void testMemoryReport( test::TestCounts & testCounts )
+	{
+		testBegin( "testMemoryReport" );
+		crg::ImageData mips{};
+		mips.format = VK_FORMAT_R8_UNORM;
+		mips.extent = { 4u, 4u };
+		mips.mipLevels = 3u;
+		mips.arrayLayers = 2u;
+		mips.samples = VK_SAMPLE_COUNT_1_BIT;
+		check( crg::getMemorySize( mips ) == ( 16u + 4u + 1u ) * 2u );
+		auto compressed = test::createImage( VK_FORMAT_BC1_RGB_UNORM_BLOCK );
+		check( crg::getMemorySize( compressed ) == 256u * 256u * 8u );
+
+		crg::RenderGraph graph{ testCounts.testName };
+		auto report = graph.getMemoryReport();
+		check( report.graph >= sizeof( crg::RenderGraph ) );
+		check( report.passes == 0u );
+		check( report.nodes == 0u );
+		check( report.gpuImages == 0u );
+
+		auto d0 = graph.createImage( test::createImage( VK_FORMAT_R32G32B32_SFLOAT ) );
+		auto d0v = graph.createView( test::createView( d0, VK_FORMAT_R32G32B32_SFLOAT ) );
+		auto h = graph.createHistoryImage( test::createImage( VK_FORMAT_R8G8B8A8_UNORM ) );
+		auto hv = graph.createView( test::createView( h, VK_FORMAT_R8G8B8A8_UNORM ) );
+		auto hpv = graph.createHistoryView( hv );
+		auto b = graph.createBuffer( { 0u, 1024u, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT } );
+		crg::RenderPass pass0
+		{
+			"pass0",
+			{ crg::Attachment::createSampled( "HPrvSp", hpv ) },
+			{ crg::Attachment::createOutputColour( "D0Tg", d0v )
+				, crg::Attachment::createOutputColour( "HTg", hv ) },
+			std::nullopt,
+			{ crg::BufferAttachment::createStorageWrite( "BufW", b ) },
+		};
+		checkNoThrow( graph.add( pass0 ) );
+		crg::RenderPass pass1
+		{
+			"pass1",
+			{ crg::Attachment::createSampled( "D0Sp", d0v ) },
+			{},
+			std::nullopt,
+			{ crg::BufferAttachment::createStorageRead( "BufR", b ) },
+		};
+		checkNoThrow( graph.add( pass1 ) );
+
+		report = graph.getMemoryReport();
+		check( report.passes > 0u );
+		check( report.attachments > 0u );
+		check( report.images > 0u );
+		check( report.views > 0u );
+		check( report.buffers > 0u );
+		check( report.nodes == 0u );
+		check( report.transitions == 0u );
+		// The history image and its alias are only handles, its two backings hold the memory.
+		check( report.gpuImages == 1024u * 1024u * 12u + 2u * 1024u * 1024u * 4u );
+		check( report.gpuBuffers == 1024u );
+		check( report.hostTotal == getHostSum( report ) );
+
+		checkNoThrow( graph.compile() );
+		report = graph.getMemoryReport();
+		check( report.nodes > 0u );
+		check( report.attachsToPrev > 0u );
+		check( report.transitions > 0u );
+		check( report.dependencies > 0u );
+		check( report.schedule > 0u );
+		check( report.slack > 0u );
+		check( report.slack < report.hostTotal );
+		check( report.hostTotal == getHostSum( report ) );
+
+		// The passes waiting in a staging are counted too.
+		auto & staging = graph.getStaging( "staging" );
+		auto staged = staging.createImage( test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT ) );
+		staging.add( crg::RenderPass{ "stagedPass"
+			, {}
+			, { crg::Attachment::createOutputColour( "Out", staging.createView( test::createView( staged, VK_FORMAT_R32G32B32A32_SFLOAT ) ) ) } } );
+		auto stagedReport = graph.getMemoryReport();
+		check( stagedReport.passes > report.passes );
+		check( stagedReport.attachments > report.attachments );
+		check( stagedReport.images > report.images );
+		check( stagedReport.views > report.views );
+		check( stagedReport.hostTotal == getHostSum( stagedReport ) );
 		testEnd();
 	}
 
@@ -719,6 +1924,7 @@ namespace
 		};
 		checkNoThrow( graph.add( ambientPass ) );
 
+		graph.setCompileMode( crg::CompileMode::CrossCheck );
 		checkNoThrow( graph.compile() );
 		std::stringstream stream;
 		test::display( testCounts, stream, graph );
@@ -1047,8 +2253,8 @@ namespace
 			};
 			checkNoThrow( graph.add( finalCombinePass ) );
 		}
-		
 
+		graph.setCompileMode( crg::CompileMode::CrossCheck );
 		checkNoThrow( graph.compile() );
 		std::stringstream stream;
 		test::display( testCounts, stream, graph );
@@ -1826,14 +3032,32 @@ int main( int argc, char ** argv )
 	testOnePass( testCounts );
 	testDuplicateName( testCounts );
 	testWrongRemove( testCounts );
+	testPassIds( testCounts );
+	testDestroyResources( testCounts );
+	testSharedViews( testCounts );
 	testOneDependency( testCounts );
 	testChainedDependencies( testCounts );
 	testSharedDependencies( testCounts );
 	test2MipDependencies( testCounts );
 	test3MipDependencies( testCounts );
+	testLayerDependencies( testCounts );
 	testLoopDependencies( testCounts );
 	testLoopDependenciesWithRoot( testCounts );
 	testLoopDependenciesWithRootAndLeaf( testCounts );
+	testBarriers( testCounts );
+	testHistoryImage( testCounts );
+	testTransitiveReduction( testCounts );
+	testReachability( testCounts );
+	testGraphTraversal( testCounts );
+	testStaticVisit( testCounts );
+	testConcurrentRegistration( testCounts );
+	testBufferDependencies( testCounts );
+	testBufferHazards( testCounts );
+	testComputeAndTransfer( testCounts );
+	testCompileStats( testCounts );
+	testMemoryReport( testCounts );
+	testCompileModes( testCounts );
+	testDecodedGraphs( testCounts );
 	testSsaoPass( testCounts );
 	testRender< false, false, false, false >( testCounts );
 	testRender< false, true, false, false >( testCounts );
@@ -575,6 +575,61 @@ namespace
 		check( pass.depthStencilInOut.value() == dsAttach );
 		testEnd();
 	}
+
+	void testRenderPass_Compute( test::TestCounts & testCounts )
+	{
+		testBegin( "testRenderPass_Compute" );
+		auto in = test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT );
+		auto inv = test::makeId( test::createView( in ) );
+		auto inAttach = crg::Attachment::createSampled( "IN"
+			, inv );
+		auto out = test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT );
+		auto outv = test::makeId( test::createView( out ) );
+		auto outAttach = crg::Attachment::createOutputStorage( "OUT"
+			, outv );
+
+		auto pass = crg::RenderPass::createCompute( "Compute"
+			, { inAttach }
+			, { outAttach } );
+
+		check( pass.kind == crg::RenderPass::Kind::Compute );
+		check( pass.name == "Compute" );
+		check( pass.sampled.size() == 1u );
+		check( pass.sampled[0] == inAttach );
+		check( pass.colourInOuts.empty() );
+		check( pass.depthStencilInOut == std::nullopt );
+		check( pass.storages.size() == 1u );
+		check( pass.storages[0] == outAttach );
+		check( pass.storages[0].kind == crg::Attachment::Kind::Storage );
+		check( pass.transfers.empty() );
+		testEnd();
+	}
+
+	void testRenderPass_Transfer( test::TestCounts & testCounts )
+	{
+		testBegin( "testRenderPass_Transfer" );
+		auto src = test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT );
+		auto srcv = test::makeId( test::createView( src ) );
+		auto srcAttach = crg::Attachment::createTransferSrc( "SRC"
+			, srcv );
+		auto dst = test::createImage( VK_FORMAT_R32G32B32A32_SFLOAT );
+		auto dstv = test::makeId( test::createView( dst ) );
+		auto dstAttach = crg::Attachment::createTransferDst( "DST"
+			, dstv );
+
+		auto pass = crg::RenderPass::createTransfer( "Transfer"
+			, { srcAttach, dstAttach } );
+
+		check( pass.kind == crg::RenderPass::Kind::Transfer );
+		check( pass.sampled.empty() );
+		check( pass.colourInOuts.empty() );
+		check( pass.storages.empty() );
+		check( pass.transfers.size() == 2u );
+		check( pass.transfers[0] == srcAttach );
+		check( pass.transfers[1] == dstAttach );
+		check( !( srcAttach == dstAttach ) );
+		testEnd();
+	}
 }
 
 int main( int argc, char ** argv )
@@ -597,5 +652,7 @@ int main( int argc, char ** argv )
 	testRenderPass_1C_2I_DS( testCounts );
 	testRenderPass_2C_1I_DS( testCounts );
 	testRenderPass_2C_2I_DS( testCounts );
+	testRenderPass_Compute( testCounts );
+	testRenderPass_Transfer( testCounts );
 	testSuiteEnd();
 }
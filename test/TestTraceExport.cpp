@@ -0,0 +1,214 @@
+#include "Common.hpp"
+
+#include <RenderGraph/GraphExecutor.hpp>
+#include <RenderGraph/ImageData.hpp>
+#include <RenderGraph/RenderGraph.hpp>
+#include <RenderGraph/RenderPass.hpp>
+#include <RenderGraph/TraceExport.hpp>
+
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	size_t count( std::string const & value
+		, std::string const & pattern )
+	{
+		size_t result{};
+		auto pos = value.find( pattern );
+
+		while ( pos != std::string::npos )
+		{
+			++result;
+			pos = value.find( pattern, pos + pattern.size() );
+		}
+
+		return result;
+	}
+
+	bool isBalanced( std::string const & value )
+	{
+		int depth{};
+		bool inString{};
+
+		for ( size_t index = 0u; index < value.size(); ++index )
+		{
+			auto c = value[index];
+
+			if ( inString )
+			{
+				if ( c == '\\' )
+				{
+					++index;
+				}
+				else if ( c == '"' )
+				{
+					inString = false;
+				}
+			}
+			else if ( c == '"' )
+			{
+				inString = true;
+			}
+			else if ( c == '{' || c == '[' )
+			{
+				++depth;
+			}
+			else if ( c == '}' || c == ']' )
+			{
+				if ( --depth < 0 )
+				{
+					return false;
+				}
+			}
+		}
+
+		return depth == 0 && !inString;
+	}
+
+	void buildGraph( test::TestCounts & testCounts
+		, crg::RenderGraph & graph )
+	{
+		auto d = graph.createImage( test::createImage( VK_FORMAT_D32_SFLOAT ) );
+		auto dv = graph.createView( test::createView( d, VK_FORMAT_D32_SFLOAT ) );
+		auto l = graph.createImage( test::createImage( VK_FORMAT_R32_UINT ) );
+		auto lv = graph.createView( test::createView( l, VK_FORMAT_R32_UINT ) );
+		auto s = graph.createImage( test::createImage( VK_FORMAT_R8G8B8A8_UNORM ) );
+		auto sv = graph.createView( test::createView( s, VK_FORMAT_R8G8B8A8_UNORM ) );
+		auto c = graph.createImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto cv = graph.createView( test::createView( c, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto o = graph.createImage( test::createImage( VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		auto ov = graph.createView( test::createView( o, VK_FORMAT_R16G16B16A16_SFLOAT ) );
+		crg::RenderPass depthPass
+		{
+			"depth\"Pass",
+			{},
+			{},
+			crg::Attachment::createOutputDepth( "Depth", dv ),
+		};
+		checkNoThrow( graph.add( depthPass ) );
+		crg::RenderPass shadowPass
+		{
+			"shadowPass",
+			{},
+			{ crg::Attachment::createOutputColour( "ShadowTg", sv ) },
+		};
+		checkNoThrow( graph.add( shadowPass ) );
+		auto cullPass = crg::RenderPass::createCompute( "lightCullPass"
+			, { crg::Attachment::createSampled( "DepthSp", dv ) }
+			, { crg::Attachment::createOutputStorage( "LightsSt", lv ) } );
+		checkNoThrow( graph.add( cullPass ) );
+		crg::RenderPass lightingPass
+		{
+			"lightingPass",
+			{ crg::Attachment::createSampled( "LightsSp", lv )
+				, crg::Attachment::createSampled( "ShadowSp", sv )
+				, crg::Attachment::createSampled( "DepthSp", dv ) },
+			{ crg::Attachment::createOutputColour( "ColourTg", cv ) },
+		};
+		checkNoThrow( graph.add( lightingPass ) );
+		auto copyPass = crg::RenderPass::createTransfer( "copyPass"
+			, { crg::Attachment::createTransferSrc( "ColourSrc", cv )
+				, crg::Attachment::createTransferDst( "OutputDst", ov ) } );
+		checkNoThrow( graph.add( copyPass ) );
+		graph.enableCompileStats( true );
+		checkNoThrow( graph.compile() );
+	}
+
+	void testCompileTrace( test::TestCounts & testCounts )
+	{
+		testBegin( "testCompileTrace" );
+		crg::RenderGraph graph{ testCounts.testName };
+		buildGraph( testCounts, graph );
+		std::stringstream stream;
+		checkNoThrow( crg::writeCompileTrace( stream, graph.getCompileStats() ) );
+		auto trace = stream.str();
+		check( isBalanced( trace ) );
+		check( count( trace, "\"traceEvents\"" ) == 1u );
+		check( count( trace, "\"name\":\"compile\"" ) == 2u );
+		check( count( trace, "\"name\":\"buildPassDependencies\"" ) == 1u );
+		check( count( trace, "\"name\":\"buildPassBarriers\"" ) == 1u );
+		check( count( trace, "\"name\":\"cacheLoad\"" ) == 0u );
+		check( count( trace, "\"overlapTests\":" ) == 1u );
+		testEnd();
+	}
+
+	void testScheduleTrace( test::TestCounts & testCounts )
+	{
+		testBegin( "testScheduleTrace" );
+		crg::RenderGraph graph{ testCounts.testName };
+		buildGraph( testCounts, graph );
+		auto & order = graph.getExecutionOrder();
+		require( order.size() == 5u );
+		crg::PassTimeArray costs( order.size(), std::chrono::microseconds{ 10 } );
+		checkThrow( crg::writeScheduleTrace( std::cout, graph, crg::PassTimeArray{ 1u } ) );
+
+		std::stringstream stream;
+		checkNoThrow( crg::writeScheduleTrace( stream, graph, costs ) );
+		auto trace = stream.str();
+		check( isBalanced( trace ) );
+		check( count( trace, "\"ph\":\"X\"" ) == 5u );
+		check( count( trace, "\"name\":\"depth\\\"Pass\"" ) == 1u );
+		check( count( trace, "\"name\":\"Graphics queue\"" ) == 1u );
+		check( count( trace, "\"name\":\"Compute queue\"" ) == 1u );
+		check( count( trace, "\"name\":\"Transfer queue\"" ) == 1u );
+		// depth -> cull, cull -> lighting, lighting -> copy.
+		check( count( trace, "\"ph\":\"s\",\"name\":\"semaphore\"" ) == 3u );
+		check( count( trace, "\"ph\":\"f\",\"name\":\"semaphore\"" ) == 3u );
+		// depth -> lighting is already ordered through the cull pass.
+		check( count( trace, "\"ph\":\"s\",\"name\":\"splitBarrier\"" ) == 0u );
+		// The lighting pass waits for the compute pass, which waits for the depth pass.
+		check( count( trace, "\"name\":\"lightingPass\",\"pid\":2,\"tid\":1,\"ts\":20.000" ) == 1u );
+		check( count( trace, "\"name\":\"copyPass\",\"pid\":2,\"tid\":3,\"ts\":30.000" ) == 1u );
+		testEnd();
+	}
+
+	void testMeasuredTrace( test::TestCounts & testCounts )
+	{
+		testBegin( "testMeasuredTrace" );
+		crg::RenderGraph graph{ testCounts.testName };
+		buildGraph( testCounts, graph );
+		crg::GraphExecutor executor{ graph
+			, []( uint32_t count, std::function< void( uint32_t, uint32_t ) > const & job )
+			{
+				for ( uint32_t index = 0u; index < count; ++index )
+				{
+					job( index, 0u );
+				}
+			} };
+		executor.enableRecordTimes( true );
+		executor.run( []( crg::RenderPass const &, uint32_t, uint32_t )
+			{
+				std::this_thread::sleep_for( std::chrono::microseconds{ 50 } );
+			}
+			, []( crg::RenderPass const &, uint32_t )
+			{
+			} );
+		auto & times = executor.getRecordTimes();
+		require( times.size() == graph.getExecutionOrder().size() );
+
+		for ( auto & time : times )
+		{
+			check( time >= std::chrono::microseconds{ 50 } );
+		}
+
+		std::stringstream stream;
+		checkNoThrow( crg::writeTrace( stream, graph, times ) );
+		auto trace = stream.str();
+		check( isBalanced( trace ) );
+		check( count( trace, "\"traceEvents\"" ) == 1u );
+		check( count( trace, "\"name\":\"compile\"" ) == 2u );
+		check( count( trace, "\"name\":\"frame\"" ) == 1u );
+		check( count( trace, "\"name\":\"lightingPass\"" ) == 1u );
+		testEnd();
+	}
+}
+
+int main( int argc, char ** argv )
+{
+	testSuiteBegin( "TestTraceExport" );
+	testCompileTrace( testCounts );
+	testScheduleTrace( testCounts );
+	testMeasuredTrace( testCounts );
+	testSuiteEnd();
+}